@@ -50,10 +50,12 @@
 #include "cbox/EepromObjectStorage.h"
 #include "cbox/ObjectContainer.h"
 #include "cbox/ObjectFactory.h"
+#include "cbox/Profiling.h"
 #include "cbox/Tracing.h"
 #include "cbox/spark/SparkEepromAccess.h"
 #include "deviceid_hal.h"
 #include "platforms.h"
+#include "rng_hal.h"
 #include <memory>
 
 using EepromAccessImpl = cbox::SparkEepromAccess;
@@ -178,6 +180,12 @@ makeBrewBloxBox()
     scanningFactories.push_back(std::make_unique<OneWireScanningFactory>(objects, theOneWire()));
 
     static cbox::Box box(objectFactory, objects, objectStore, connections, std::move(scanningFactories));
+    box.setPersistDelay(5000); // coalesce writes from the service, for example when it ramps a setpoint
+    box.setCursorEpoch(HAL_RNG_GetRandomNumber()); // cursors from before a reboot list all objects
+#if defined(SPARK)
+    // handle commands for at most 20 ms per loop, so a busy connection does not delay updating the blocks
+    connections.timeBudget(20000, []() { return ticks.micros(); });
+#endif
 
     return box;
 }
@@ -262,6 +270,8 @@ void
 updateBrewbloxBox()
 {
     brewbloxBox().update(ticks.millis());
+    // advance queued OneWire transactions, waiting for the bus for at most 1 ms
+    theOneWire().process(1000, []() { return ticks.micros(); });
 #if PLATFORM_ID == 3
     ticks.delayMillis(10); // prevent 100% cpu usage
 #endif
@@ -319,6 +329,7 @@ updateFirmwareStreamHandler(Stream* stream)
                 // just exit for sim
                 HAL_Core_System_Reset_Ex(RESET_REASON_UPDATE, 0, nullptr);
 #else
+                brewbloxBox().persistPendingObjects();
                 bool success = system_firmwareUpdate(stream);
                 System.reset(success ? RESET_USER_REASON::FIRMWARE_UPDATE_SUCCESS : RESET_USER_REASON::FIRMWARE_UPDATE_FAILED, RESET_NO_WAIT);
 #endif
@@ -364,6 +375,22 @@ updateFirmwareFromStream(cbox::StreamType streamType)
 #endif
 
 namespace cbox {
+namespace tracing {
+    uint32_t timestamp()
+    {
+        return ticks.micros();
+    }
+}
+
+#if CBOX_PROFILING
+namespace profiling {
+    uint32_t micros()
+    {
+        return ticks.micros();
+    }
+}
+#endif
+
 void
 connectionStarted(DataOut& out)
 {
@@ -26,7 +26,7 @@ DigitalCompare::write(blox_DigitalCompare& dest, bool includeNotPersisted) const
     dest.op = m_op;
     dest.rhs = blox_DigitalState(m_rhs);
     if (includeNotPersisted) {
-        dest.result = m_result;
+        dest.result = eval(); // the program only evaluates the compares it reaches
     }
 }
 
@@ -68,7 +68,7 @@ AnalogCompare::write(blox_AnalogCompare& dest, bool includeNotPersisted) const
     dest.op = m_op;
     dest.rhs = cnl::unwrap(m_rhs);
     if (includeNotPersisted) {
-        dest.result = m_result;
+        dest.result = eval(); // the program only evaluates the compares it reaches
     }
 }
 
@@ -91,6 +91,7 @@ ActuatorLogicBlock::streamFrom(cbox::DataIn& dataIn)
         }
 
         expression = std::string(newData.expression);
+        program.compile(expression, uint8_t(digitals.size()), uint8_t(analogs.size()));
     }
     return result;
 }
@@ -166,108 +167,103 @@ ActuatorLogicBlock::implements(const cbox::obj_type_t& iface)
 blox_Compare_Result
 ActuatorLogicBlock::evaluate()
 {
-    for (auto& d : digitals) {
-        d.update();
-    }
+    return program.run(
+        [this](uint8_t i) { return digitals[i].eval(); },
+        [this](uint8_t i) { return analogs[i].eval(); },
+        m_errorPos);
+}
 
-    for (auto& a : analogs) {
-        a.update();
-    }
-    m_errorPos = 0;
+void
+LogicProgram::compile(const std::string& expression, uint8_t digitalCount, uint8_t analogCount)
+{
+    m_code.clear();
+    m_digitalCount = digitalCount;
+    m_analogCount = analogCount;
+    m_compileErrorPos = 0;
     if (expression.empty()) {
-        return blox_Compare_Result_RESULT_EMPTY;
+        m_compileResult = blox_Compare_Result_RESULT_EMPTY;
+        return;
     }
-    auto it = expression.cbegin();
-    auto result = eval(it, 0);
-
-    if (result > blox_Compare_Result_RESULT_TRUE) {
-        m_errorPos = it - expression.cbegin() - 1;
+    uint8_t pos = 0;
+    m_compileResult = compileLevel(expression, pos, 0);
+    if (m_compileResult != blox_Compare_Result_RESULT_TRUE) {
+        m_compileErrorPos = pos - 1;
+        m_code.clear();
     }
-    return result;
+    m_code.shrink_to_fit();
 }
 
+// Compiles the rest of the current bracket level. Returns RESULT_TRUE when code was added that leaves
+// one value on the stack, RESULT_EMPTY_SUBSTRING when the level had no value, or the parse error.
+// pos is left just after the character that caused the error.
 blox_Compare_Result
-ActuatorLogicBlock::eval(std::string::const_iterator& it, uint8_t level) const
+LogicProgram::compileLevel(const std::string& expression, uint8_t& pos, uint8_t level)
 {
     blox_Compare_Result res = blox_Compare_Result_RESULT_EMPTY_SUBSTRING;
-    while (it < expression.cend()) {
+    auto start = m_code.size(); // start of the code for res
+    while (pos < expression.size()) {
         if (res > blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
             return res;
         }
-        auto c = *it;
-        ++it;
+        auto c = expression[pos];
+        ++pos;
         if ('a' <= c && c <= 'z') {
             if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_COMPARISON;
             }
-            auto compare = digitals.cbegin() + (c - 'a');
-            if (compare >= digitals.cend()) {
+            if (c - 'a' >= m_digitalCount) {
                 return blox_Compare_Result_RESULT_UNDEFINED_DIGITAL_COMPARE;
             }
-            res = compare->result();
+            start = m_code.size();
+            emit(Op::DIGITAL, c - 'a', pos - 1);
+            res = blox_Compare_Result_RESULT_TRUE;
         } else if ('A' <= c && c <= 'Z') {
             if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_COMPARISON;
             }
-            auto compare = analogs.cbegin() + (c - 'A');
-            if (compare >= analogs.cend()) {
+            if (c - 'A' >= m_analogCount) {
                 return blox_Compare_Result_RESULT_UNDEFINED_ANALOG_COMPARE;
             }
-            res = compare->result();
+            start = m_code.size();
+            emit(Op::ANALOG, c - 'A', pos - 1);
+            res = blox_Compare_Result_RESULT_TRUE;
         } else if (c == '!') {
-            auto rhs = eval(it, level);
-            if (rhs > blox_Compare_Result_RESULT_TRUE) {
-                return rhs; // error
-            }
-            if (rhs == blox_Compare_Result_RESULT_TRUE) {
-                return blox_Compare_Result_RESULT_FALSE;
-            }
-            return blox_Compare_Result_RESULT_TRUE;
-        } else if (c == '|') {
-            if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
-                return blox_Compare_Result_RESULT_UNEXPECTED_OPERATOR;
-            }
-            auto rhs = eval(it, level);
-            if (rhs > blox_Compare_Result_RESULT_TRUE) {
-                return rhs; // error
-            }
-            if (res == blox_Compare_Result_RESULT_TRUE) {
-                return res;
+            m_code.resize(start); // the value before the ! is not used
+            auto rhs = compileLevel(expression, pos, level);
+            if (rhs != blox_Compare_Result_RESULT_TRUE) {
+                return rhs;
             }
+            emit(Op::NOT);
             return rhs;
-        } else if (c == '&') {
+        } else if (c == '|' || c == '&' || c == '^') {
             if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_OPERATOR;
             }
-            auto rhs = eval(it, level);
-            if (rhs > blox_Compare_Result_RESULT_TRUE) {
-                return rhs; // error
+            auto jump = m_code.size();
+            if (c != '^') {
+                emit(c == '|' ? Op::OR_ELSE : Op::AND_THEN);
             }
-            if (res == blox_Compare_Result_RESULT_TRUE) {
+            auto rhs = compileLevel(expression, pos, level);
+            if (rhs != blox_Compare_Result_RESULT_TRUE) {
                 return rhs;
             }
-            return res;
-        } else if (c == '^') {
-            if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
-                return blox_Compare_Result_RESULT_UNEXPECTED_OPERATOR;
-            }
-            auto rhs = eval(it, level);
-            if (rhs != blox_Compare_Result_RESULT_TRUE && rhs != blox_Compare_Result_RESULT_FALSE) {
-                return rhs; // error
-            }
-            if (rhs != res) {
-                return blox_Compare_Result_RESULT_TRUE;
+            if (c == '^') {
+                emit(Op::XOR);
+            } else {
+                m_code[jump].arg = m_code.size();
             }
-            return blox_Compare_Result_RESULT_FALSE;
+            return rhs;
         } else if (c == '(') {
-            if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
-                res = eval(it, level + 1);
-            } else {
+            if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_OPEN_BRACKET;
             }
+            start = m_code.size();
+            res = compileLevel(expression, pos, level + 1);
+            if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
+                m_code.resize(start); // empty brackets are skipped
+            }
         } else if (c == ')') {
             if (level == 0) {
-                // first check is to not overwrite earlier error
                 return blox_Compare_Result_RESULT_UNEXPECTED_CLOSE_BRACKET;
             }
             return res;
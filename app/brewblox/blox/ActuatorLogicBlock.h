@@ -7,6 +7,7 @@
 #include "blox/Block.h"
 #include "cbox/CboxPtr.h"
 #include "proto/cpp/ActuatorLogic.pb.h"
+#include <string>
 #include <vector>
 
 namespace cbox {
@@ -18,7 +19,6 @@ public:
     DigitalCompare(const blox_DigitalCompare& data, cbox::ObjectContainer& objects)
         : m_lookup(objects, cbox::obj_id_t(data.id))
         , m_op(data.op)
-        , m_result(blox_Compare_Result_RESULT_FALSE)
         , m_rhs(ActuatorDigitalBase::State(data.rhs))
     {
     }
@@ -28,20 +28,9 @@ public:
     blox_Compare_Result eval() const;
     void write(blox_DigitalCompare& dest, bool includeNotPersisted) const;
 
-    void update()
-    {
-        m_result = eval();
-    }
-
-    auto result() const
-    {
-        return m_result;
-    }
-
 private:
     cbox::CboxPtr<ActuatorDigitalConstrained> m_lookup;
     blox_Compare_DigitalOperator m_op;
-    blox_Compare_Result m_result;
     ActuatorDigitalBase::State m_rhs;
 };
 
@@ -50,7 +39,6 @@ public:
     AnalogCompare(const blox_AnalogCompare& data, cbox::ObjectContainer& objects)
         : m_lookup(objects, cbox::obj_id_t(data.id))
         , m_op(data.op)
-        , m_result(blox_Compare_Result_RESULT_FALSE)
         , m_rhs(cnl::wrap<fp12_t>(data.rhs))
     {
     }
@@ -60,21 +48,108 @@ public:
     blox_Compare_Result eval() const;
     void write(blox_AnalogCompare& dest, bool includeNotPersisted) const;
 
-    void update()
+private:
+    cbox::CboxPtr<ProcessValue<fp12_t>> m_lookup;
+    blox_Compare_AnalogOperator m_op;
+    fp12_t m_rhs;
+};
+
+/*
+ * An expression compiled to a postfix program, so it is only parsed when it is written.
+ * Lower case letters refer to digital compares, upper case letters to analog compares.
+ * Operators evaluate right to left: a&b|c is a&(b|c). The value before a ! is discarded.
+ *
+ * The program leaves one value on a bit stack. | and & jump over their right hand side when the
+ * left hand side decides the result, so compares are only evaluated when the program reaches them.
+ * A compare that returns an error stops the program with that error.
+ */
+class LogicProgram {
+public:
+    LogicProgram() = default;
+    ~LogicProgram() = default;
+
+    // parses the expression and checks that all compares exist, a parse error is returned by every run
+    void compile(const std::string& expression, uint8_t digitalCount, uint8_t analogCount);
+
+    // digital and analog are called with the index of a compare and return its result
+    template <class DigitalEval, class AnalogEval>
+    blox_Compare_Result run(DigitalEval&& digital, AnalogEval&& analog, uint8_t& errorPos) const
     {
-        m_result = eval();
+        if (m_compileResult != blox_Compare_Result_RESULT_TRUE) {
+            errorPos = m_compileErrorPos;
+            return m_compileResult;
+        }
+        uint64_t stack = 0; // top of the stack is bit 0, an expression has less than 64 compares
+        for (uint8_t pc = 0; pc < m_code.size();) {
+            auto& instr = m_code[pc++];
+            switch (instr.op) {
+            case Op::DIGITAL:
+            case Op::ANALOG: {
+                auto res = instr.op == Op::DIGITAL ? digital(instr.arg) : analog(instr.arg);
+                if (res > blox_Compare_Result_RESULT_TRUE) {
+                    errorPos = instr.pos;
+                    return res;
+                }
+                stack = (stack << 1) | (res == blox_Compare_Result_RESULT_TRUE);
+            } break;
+            case Op::NOT:
+                stack ^= 1;
+                break;
+            case Op::XOR:
+                stack = (stack >> 1) ^ (stack & 1);
+                break;
+            case Op::OR_ELSE:
+                if (stack & 1) {
+                    pc = instr.arg; // true | x is true
+                } else {
+                    stack >>= 1;
+                }
+                break;
+            case Op::AND_THEN:
+                if (stack & 1) {
+                    stack >>= 1;
+                } else {
+                    pc = instr.arg; // false & x is false
+                }
+                break;
+            }
+        }
+        errorPos = 0;
+        return (stack & 1) ? blox_Compare_Result_RESULT_TRUE : blox_Compare_Result_RESULT_FALSE;
     }
 
-    auto result() const
+    size_t size() const
     {
-        return m_result;
+        return m_code.size();
     }
 
 private:
-    cbox::CboxPtr<ProcessValue<fp12_t>> m_lookup;
-    blox_Compare_AnalogOperator m_op;
-    blox_Compare_Result m_result;
-    fp12_t m_rhs;
+    enum class Op : uint8_t {
+        DIGITAL,  // push the result of digital compare arg
+        ANALOG,   // push the result of analog compare arg
+        NOT,      // invert the top
+        XOR,      // replace the top 2 values with their xor
+        OR_ELSE,  // jump to arg if the top is true, otherwise pop it
+        AND_THEN, // jump to arg if the top is false, otherwise pop it
+    };
+
+    struct Instruction {
+        Op op;
+        uint8_t arg;
+        uint8_t pos; // position in the expression, reported when a compare returns an error
+    };
+
+    std::vector<Instruction> m_code;
+    blox_Compare_Result m_compileResult = blox_Compare_Result_RESULT_EMPTY;
+    uint8_t m_compileErrorPos = 0;
+    uint8_t m_digitalCount = 0;
+    uint8_t m_analogCount = 0;
+
+    blox_Compare_Result compileLevel(const std::string& expression, uint8_t& pos, uint8_t level);
+    void emit(Op op, uint8_t arg = 0, uint8_t pos = 0)
+    {
+        m_code.push_back(Instruction{op, arg, pos});
+    }
 };
 
 class ActuatorLogicBlock : public Block<BrewBloxTypes_BlockType_ActuatorLogic> {
@@ -85,6 +160,7 @@ private:
     std::vector<DigitalCompare> digitals;
     std::vector<AnalogCompare> analogs;
     std::string expression;
+    LogicProgram program;
     blox_Compare_Result m_result = blox_Compare_Result_RESULT_FALSE;
     uint8_t m_errorPos = 0;
 
@@ -109,6 +185,5 @@ public:
     blox_Compare_Result evaluate();
 
 private:
-    blox_Compare_Result eval(std::string::const_iterator& it, uint8_t level) const;
     void writeMessage(blox_ActuatorLogic& message, bool includeNotPersisted) const;
 };
@@ -33,6 +33,12 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const std::function<void(const cbox::obj_id_t&, cbox::LinkType)>& func) const override final
+    {
+        func(reference.getId(), cbox::LinkType::Input);
+        func(target.getId(), cbox::LinkType::Output);
+    }
+
     ActuatorOffset& get()
     {
         return offset;
@@ -37,6 +37,11 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const std::function<void(const cbox::obj_id_t&, cbox::LinkType)>& func) const override final
+    {
+        func(actuator.getId(), cbox::LinkType::Output);
+    }
+
     const cbox::CboxPtr<ActuatorDigitalConstrained>& targetLookup() const
     {
         return actuator;
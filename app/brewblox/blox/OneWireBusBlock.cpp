@@ -110,3 +110,14 @@ OneWireBusBlock::streamFrom(cbox::DataIn& dataIn)
     }
     return res;
 }
+
+/**
+ * Starts a temperature conversion on all sensors on the bus with a single command, once per second.
+ * The sensor blocks read the result of the previous conversion in their own update.
+ */
+cbox::update_t
+OneWireBusBlock::update(const cbox::update_t& now)
+{
+    bus.startConversion();
+    return update_1s(now);
+}
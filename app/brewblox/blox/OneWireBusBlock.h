@@ -48,9 +48,5 @@ public:
         return cbox::CboxError::PERSISTING_NOT_NEEDED;
     }
 
-    virtual cbox::update_t update(const cbox::update_t& now) override final
-    {
-        // No updates for now. Alternatively, a periodic bus scan for new devices?
-        return update_never(now);
-    }
+    virtual cbox::update_t update(const cbox::update_t& now) override final;
 };
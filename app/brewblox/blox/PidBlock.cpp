@@ -142,7 +142,22 @@ PidBlock::update(const cbox::update_t& now)
 {
     bool doUpdate = false;
     auto nextUpdate = m_intervalHelper.update(now, doUpdate);
+    return updatePid(now, doUpdate, nextUpdate);
+}
+
+cbox::update_t
+PidBlock::pulledUpdate(const cbox::update_t& now)
+{
+    // the input has a new value: realign the interval to it
+    bool doUpdate = false;
+    auto nextUpdate = m_intervalHelper.pull(now, doUpdate);
+    return updatePid(now, doUpdate, nextUpdate);
+}
 
+cbox::update_t
+PidBlock::updatePid(const cbox::update_t& now, bool doUpdate, const cbox::update_t& nextUpdate)
+{
+    newOutput = doUpdate;
     if (doUpdate) {
         pid.update();
         auto pidActive = pid.active();
@@ -33,6 +33,9 @@ private:
     Pid pid;
     IntervalHelper<1000> m_intervalHelper;
     bool previousActive = false;
+    bool newOutput = false; // the last update wrote a new setting to the output
+
+    cbox::update_t updatePid(const cbox::update_t& now, bool doUpdate, const cbox::update_t& nextUpdate);
 
 public:
     PidBlock(cbox::ObjectContainer& objects);
@@ -46,9 +49,23 @@ public:
 
     virtual cbox::update_t
     update(const cbox::update_t& now) override final;
+    virtual cbox::update_t
+    pulledUpdate(const cbox::update_t& now) override final;
+    virtual bool
+    hasNewOutput() const override final
+    {
+        return newOutput;
+    }
     virtual void*
     implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void
+    forEachLink(const std::function<void(const cbox::obj_id_t&, cbox::LinkType)>& func) const override final
+    {
+        func(input.getId(), cbox::LinkType::Input);
+        func(output.getId(), cbox::LinkType::Output);
+    }
+
     Pid&
     get()
     {
@@ -26,8 +26,9 @@
 bool
 streamPointsOut(pb_ostream_t* stream, const pb_field_t* field, void* const* arg)
 {
-    const std::vector<SetpointProfileBlock::Point>* points = reinterpret_cast<std::vector<SetpointProfileBlock::Point>*>(*arg);
-    for (const auto& p : *points) {
+    const DeltaPointList* points = reinterpret_cast<const DeltaPointList*>(*arg);
+    for (auto it = points->begin(); it.valid(); it.next()) {
+        const auto& p = it.point();
         auto submsg = blox_Point();
         submsg.time = p.time;
         submsg.temperature_oneof.temperature = cnl::unwrap(p.temp);
@@ -80,7 +81,8 @@ SetpointProfileBlock::streamTo(cbox::DataOut& out) const
     blox_SetpointProfile message = blox_SetpointProfile_init_zero;
     FieldTags stripped;
     message.points.funcs.encode = &streamPointsOut;
-    message.points.arg = const_cast<std::vector<Point>*>(&profile.points());
+    // points are decoded one at a time while they are encoded
+    message.points.arg = const_cast<DeltaPointList*>(&profile.pointList());
     message.enabled = profile.enabled();
     message.start = profile.startTime();
     message.targetId = target.getId();
@@ -56,6 +56,11 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const std::function<void(const cbox::obj_id_t&, cbox::LinkType)>& func) const override final
+    {
+        func(target.getId(), cbox::LinkType::Output);
+    }
+
     SetpointProfile& get()
     {
         return profile;
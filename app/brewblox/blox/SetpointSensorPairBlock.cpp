@@ -92,10 +92,25 @@ SetpointSensorPairBlock::update(const cbox::update_t& now)
 {
     bool doUpdate = false;
     auto nextUpdate = m_intervalHelper.update(now, doUpdate);
+    return updatePair(doUpdate, nextUpdate);
+}
+
+cbox::update_t
+SetpointSensorPairBlock::pulledUpdate(const cbox::update_t& now)
+{
+    // the sensor has a new reading: realign the interval to it
+    bool doUpdate = false;
+    auto nextUpdate = m_intervalHelper.pull(now, doUpdate);
+    return updatePair(doUpdate, nextUpdate);
+}
 
+cbox::update_t
+SetpointSensorPairBlock::updatePair(bool doUpdate, const cbox::update_t& nextUpdate)
+{
     if (doUpdate) {
         pair.update();
     }
+    newOutput = doUpdate;
     return nextUpdate;
 }
 
@@ -27,6 +27,9 @@ private:
     cbox::CboxPtr<TempSensor> sensor;
     SetpointSensorPair pair;
     IntervalHelper<1000> m_intervalHelper;
+    bool newOutput = false; // the last update recalculated the value of the pair
+
+    cbox::update_t updatePair(bool doUpdate, const cbox::update_t& nextUpdate);
 
 public:
     SetpointSensorPairBlock(cbox::ObjectContainer& objects)
@@ -45,8 +48,20 @@ public:
 
     virtual cbox::update_t update(const cbox::update_t& now) override final;
 
+    virtual cbox::update_t pulledUpdate(const cbox::update_t& now) override final;
+
+    virtual bool hasNewOutput() const override final
+    {
+        return newOutput;
+    }
+
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const std::function<void(const cbox::obj_id_t&, cbox::LinkType)>& func) const override final
+    {
+        func(sensor.getId(), cbox::LinkType::Input);
+    }
+
     SetpointSensorPair& get()
     {
         return pair;
@@ -71,3 +71,58 @@ SparkIoBase::writeChannelImpl(uint8_t channel, ChannelConfig config)
     }
     return false;
 }
+
+bool
+SparkIoBase::writeChannelsImpl(uint32_t mask)
+{
+#if PLATFORM_ID == 6 || PLATFORM_ID == 8
+    // outputs on the same GPIO port are set and reset with one write to each half of its BSRR register
+    constexpr uint8_t maxPorts = 4;
+    GPIO_TypeDef* ports[maxPorts];
+    uint16_t setPins[maxPorts] = {0};
+    uint16_t resetPins[maxPorts] = {0};
+    uint8_t numPorts = 0;
+    bool success = true;
+    auto pinMap = HAL_Pin_Map();
+
+    for (uint8_t channel = 1; mask != 0; channel++, mask >>= 1) {
+        if (!(mask & 1)) {
+            continue;
+        }
+        auto pin = channelToPin(channel);
+        if (pin == static_cast<decltype(pin)>(-1)) {
+            success = false;
+            continue;
+        }
+        auto port = pinMap[pin].gpio_peripheral;
+        uint8_t p = 0;
+        while (p < numPorts && ports[p] != port) {
+            p++;
+        }
+        if (p == maxPorts) {
+            success = writeChannelImpl(channel, channels[channel - 1].config) && success;
+            continue;
+        }
+        if (p == numPorts) {
+            ports[numPorts++] = port;
+        }
+        if (channels[channel - 1].config == ChannelConfig::ACTIVE_HIGH) {
+            setPins[p] |= pinMap[pin].gpio_pin;
+        } else {
+            resetPins[p] |= pinMap[pin].gpio_pin;
+        }
+    }
+
+    for (uint8_t p = 0; p < numPorts; p++) {
+        if (setPins[p]) {
+            ports[p]->BSRRL = setPins[p];
+        }
+        if (resetPins[p]) {
+            ports[p]->BSRRH = resetPins[p];
+        }
+    }
+    return success;
+#else
+    return IoArray::writeChannelsImpl(mask);
+#endif
+}
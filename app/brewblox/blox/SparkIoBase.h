@@ -38,6 +38,8 @@ public:
     virtual bool
     writeChannelImpl(uint8_t channel, ChannelConfig config) override final;
     virtual bool
+    writeChannelsImpl(uint32_t mask) override final;
+    virtual bool
     supportsFastIo() const override final
     {
         return true;
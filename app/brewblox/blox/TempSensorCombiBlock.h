@@ -50,6 +50,13 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const std::function<void(const cbox::obj_id_t&, cbox::LinkType)>& func) const override final
+    {
+        for (auto& input : inputs) {
+            func(input.getId(), cbox::LinkType::Input);
+        }
+    }
+
     TempSensorCombi& get()
     {
         return sensor;
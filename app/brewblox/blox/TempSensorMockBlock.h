@@ -9,6 +9,9 @@
 class TempSensorMockBlock : public Block<BrewBloxTypes_BlockType_TempSensorMock> {
 private:
     TempSensorMock sensor;
+    temp_t lastValue = 0;
+    bool lastValid = false;
+    bool newReading = false; // the last update changed the value or validity of the sensor
 
     using Fluctuation = TempSensorMock::Fluctuation;
 
@@ -101,7 +104,17 @@ public:
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
-        return sensor.update(now);
+        auto next = sensor.update(now);
+        // the setting of the mock can be changed at any time, so compare to the value at the previous update
+        newReading = sensor.value() != lastValue || sensor.valid() != lastValid;
+        lastValue = sensor.value();
+        lastValid = sensor.valid();
+        return next;
+    }
+
+    virtual bool hasNewOutput() const override final
+    {
+        return newReading;
     }
 
     virtual void* implements(const cbox::obj_type_t& iface) override final
@@ -12,6 +12,7 @@ theOneWire();
 class TempSensorOneWireBlock : public Block<BrewBloxTypes_BlockType_TempSensorOneWire> {
 private:
     DS18B20 sensor;
+    bool newReading = false; // the last update changed the value or validity of the sensor
 
 public:
     TempSensorOneWireBlock()
@@ -59,10 +60,18 @@ public:
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
+        auto previousValue = sensor.value();
+        auto previousValid = sensor.valid();
         sensor.update();
+        newReading = sensor.value() != previousValue || sensor.valid() != previousValid;
         return update_1s(now);
     }
 
+    virtual bool hasNewOutput() const override final
+    {
+        return newReading;
+    }
+
     virtual void* implements(const cbox::obj_type_t& iface) override final
     {
         if (iface == BrewBloxTypes_BlockType_TempSensorOneWire) {
@@ -118,6 +118,11 @@ endif
 # CPPFLAGS += -Wsuggest-final-types
 # CPPFLAGS += -Wsuggest-final-methods
 
+ifeq ($(PLATFORM_ID),3)
+# per object profiling on the host build, read with tools/profile-report.py
+CFLAGS += -DCBOX_PROFILING=1
+endif
+
 ifeq ($(PLATFORM_ID),3)
 ifeq ("$(TEST_BUILD)","y") # coverage, address sanitizer, undefined behavior
 include $(SOURCE_PATH)/build/checkers.mk # sanitizer and gcov
@@ -35,12 +35,12 @@ ActuatorAnalogWidget::update(const WidgetSettings& settings)
         setConnected();
 
         if (pAct->valueValid()) {
-            setValue(to_string_dec(pAct->value(), 1));
+            setDecAndEnable(&value, pAct->value());
         } else {
             setValue("");
         }
         if (pAct->settingValid()) {
-            setSetting(to_string_dec(pAct->setting(), 1));
+            setDecAndEnable(&setting, pAct->setting());
 
         } else {
             setSetting("");
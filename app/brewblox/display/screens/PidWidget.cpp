@@ -105,15 +105,22 @@ PidWidget::PidWidget(WidgetWrapper& myWrapper, const cbox::obj_id_t& id)
 }
 
 void
-PidWidget::drawPidRect(const fp12_t& v, D4D_COOR yPos)
+PidWidget::drawPidRect(PidBar& bar, const fp12_t& v, D4D_COOR yPos)
 {
     D4D_COOR middle = wrapper.x + wrapper.cx / 2;
 
     D4D_COOR lenMax = wrapper.cx / 2 - 5;
     D4D_COOR lenP = std::min(D4D_COOR(abs(v) * fp12_t(lenMax) / 100), lenMax);
+    int16_t length = (v >= 0) ? int16_t(lenP) : -int16_t(lenP);
+    D4D_COLOR background = wrapper.colorScheme.foreDis;
+
+    if (bar.drawn && bar.length == length && bar.background == background) {
+        return;
+    }
+    bar = PidBar{length, background, true};
 
     // clear
-    D4D_FillRectXY(middle - lenMax, wrapper.y + yPos, middle + lenMax, wrapper.y + yPos + 2, wrapper.colorScheme.foreDis);
+    D4D_FillRectXY(middle - lenMax, wrapper.y + yPos, middle + lenMax, wrapper.y + yPos + 2, background);
     // draw
     if (v >= 0) {
         D4D_FillRectXY(middle, wrapper.y + yPos, middle + lenP, wrapper.y + yPos + 2, D4D_COLOR_WHITE);
@@ -125,9 +132,16 @@ PidWidget::drawPidRect(const fp12_t& v, D4D_COOR yPos)
 void
 PidWidget::drawPidRects(const Pid& pid)
 {
-    drawPidRect(pid.p(), 54);
-    drawPidRect(pid.i(), 58);
-    drawPidRect(pid.d(), 62);
+    if (wrapper.redrawPending()) {
+        // bars drawn now would be painted over, draw them after the wrapper has been redrawn
+        for (auto& bar : bars) {
+            bar.drawn = false;
+        }
+        return;
+    }
+    drawPidRect(bars[0], pid.p(), 54);
+    drawPidRect(bars[1], pid.i(), 58);
+    drawPidRect(bars[2], pid.d(), 62);
 }
 
 void
@@ -140,24 +154,24 @@ PidWidget::update(const WidgetSettings& settings)
         setConnected();
         auto input = inputLookup.const_lock();
         if (input && input->valueValid()) {
-            setAndEnable(&inputValue, temp_to_string(input->value(), 1, settings.tempUnit));
+            setTempAndEnable(&inputValue, input->value(), settings.tempUnit);
         } else {
             setAndEnable(&inputValue, "");
         }
         if (input && input->settingValid()) {
-            setAndEnable(&inputTarget, temp_to_string(input->setting(), 1, settings.tempUnit));
+            setTempAndEnable(&inputTarget, input->setting(), settings.tempUnit);
         } else {
             setAndEnable(&inputTarget, "");
         }
 
         auto output = outputLookup.const_lock();
         if (output && output->valueValid()) {
-            setAndEnable(&outputValue, to_string_dec(output->value(), 1));
+            setDecAndEnable(&outputValue, output->value());
         } else {
             setAndEnable(&outputValue, "");
         }
         if (output && output->settingValid()) {
-            setAndEnable(&outputTarget, to_string_dec(output->setting(), 1));
+            setDecAndEnable(&outputTarget, output->setting());
         } else {
             setAndEnable(&outputTarget, "");
         }
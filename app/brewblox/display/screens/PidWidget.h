@@ -59,14 +59,22 @@ private:
 
     cbox::CboxPtr<PidBlock> lookup;
 
+    // the P, I and D bars are drawn directly, not by D4D. They are only drawn again when they change.
+    struct PidBar {
+        int16_t length; // negative bars extend to the left
+        D4D_COLOR background;
+        bool drawn;
+    };
+    PidBar bars[3] = {};
+
 public:
     PidWidget(WidgetWrapper& myWrapper, const cbox::obj_id_t& id);
     virtual ~PidWidget() = default;
 
     void
-    setIcons(std::string&& txt)
+    setIcons(const char* txt)
     {
-        setAndEnable(&icons, std::move(txt));
+        setAndEnable(&icons, txt);
     }
 
     void
@@ -99,6 +107,6 @@ public:
     }
 
 private:
-    void drawPidRect(const fp12_t& v, D4D_COOR yPos);
+    void drawPidRect(PidBar& bar, const fp12_t& v, D4D_COOR yPos);
     void drawPidRects(const Pid& pid);
 };
\ No newline at end of file
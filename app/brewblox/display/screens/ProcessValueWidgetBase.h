@@ -52,21 +52,21 @@ public:
     virtual ~ProcessValueWidgetBase() = default;
 
     void
-    setValue(std::string&& buf)
+    setValue(const char* txt)
     {
-        setAndEnable(&value, std::move(buf));
+        setAndEnable(&value, txt);
     }
 
     void
-    setSetting(std::string&& buf)
+    setSetting(const char* txt)
     {
-        setAndEnable(&setting, std::move(buf));
+        setAndEnable(&setting, txt);
     }
 
     void
-    setIcons(std::string&& buf)
+    setIcons(const char* txt)
     {
-        setAndEnable(&icons, std::move(buf));
+        setAndEnable(&icons, txt);
     }
 
     void
@@ -36,14 +36,14 @@ SetpointSensorWidget::update(const WidgetSettings& settings)
 
         char icons[3] = {0};
         if (pair.valueValid()) {
-            setValue(temp_to_string(pair.value(), 1, settings.tempUnit));
+            setTempAndEnable(&value, pair.value(), settings.tempUnit);
             icons[0] = '\x29';
         } else {
             setValue("");
             icons[0] = '\x2B';
         }
         if (pair.settingValid()) {
-            setSetting(temp_to_string(pair.setting(), 1, settings.tempUnit));
+            setTempAndEnable(&setting, pair.setting(), settings.tempUnit);
             icons[1] = '\x2A';
         } else {
             setSetting("");
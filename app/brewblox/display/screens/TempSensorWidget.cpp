@@ -33,7 +33,7 @@ TempSensorWidget::update(const WidgetSettings& settings)
         setConnected();
         char icons[2] = {0};
         if (ptr->valid()) {
-            setValue(temp_to_string(ptr->value(), 1, settings.tempUnit));
+            setTempAndEnable(&value, ptr->value(), settings.tempUnit);
             icons[0] = 0x29;
         } else {
             setValue("");
@@ -51,13 +51,14 @@ public:
         wrapper.setEnabled(enabled);
     }
 
-    static void setAndEnable(D4D_OBJECT* obj, std::string&& txt)
+    // D4D_SetText and D4D_EnableObject only invalidate the object when its text or state changes,
+    // so a widget that is updated with the same value is not redrawn
+    static void setAndEnable(D4D_OBJECT* obj, const char* txt)
     {
         static const char errTxt[] = "--.-";
-        auto s = std::move(txt);
 
-        if (!s.empty()) {
-            D4D_SetText(obj, s.c_str());
+        if (txt[0] != 0) {
+            D4D_SetText(obj, txt);
             D4D_EnableObject(obj, true);
             return;
         }
@@ -65,5 +66,20 @@ public:
         D4D_EnableObject(obj, false);
     }
 
+    // values are formatted in a buffer on the stack, updating a widget does not allocate
+    static void setTempAndEnable(D4D_OBJECT* obj, const temp_t& t, const TempUnit& unit)
+    {
+        char buf[12];
+        temp_to_chars(t, 1, unit, buf, sizeof(buf));
+        setAndEnable(obj, buf);
+    }
+
+    static void setDecAndEnable(D4D_OBJECT* obj, const fp12_t& v)
+    {
+        char buf[12];
+        to_chars_dec(v, 1, buf, sizeof(buf));
+        setAndEnable(obj, buf);
+    }
+
     virtual void update(const WidgetSettings& settings) = 0;
 };
\ No newline at end of file
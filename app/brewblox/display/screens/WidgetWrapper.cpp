@@ -120,3 +120,14 @@ WidgetWrapper::setEnabled(bool enabled)
     D4D_EnableObject(&wrapperObject, enabled);
     D4D_EnableObject(&btnObject, enabled);
 }
+
+bool
+WidgetWrapper::redrawPending() const
+{
+    // the wrapper is drawn after the widgets are updated, painting over anything the widget drew directly
+    auto pScreen = wrapperObject.pData->pScreen;
+    if (pScreen && (pScreen->pData->flags & D4D_SCR_FINT_REDRAWC)) {
+        return true;
+    }
+    return wrapperObject.pData->flags & (D4D_OBJECT_F_REDRAW | D4D_OBJECT_F_REDRAWC | D4D_OBJECT_F_REDRAWSTATE);
+}
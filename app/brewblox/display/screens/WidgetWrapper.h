@@ -108,4 +108,5 @@ public:
     void resetChildren();
     void invalidate();
     void setEnabled(bool enabled);
+    bool redrawPending() const;
 };
\ No newline at end of file
@@ -21,6 +21,7 @@
 #include "Board.h"
 #include "BrewBlox.h"
 #include "Buzzer.h"
+#include "Logger.h"
 #include "TimerInterrupts.h"
 #include "blox/stringify.h"
 #include "cbox/Box.h"
@@ -36,6 +37,7 @@
 #include "spark_wiring_startup.h"
 #include "spark_wiring_system.h"
 #include "spark_wiring_timer.h"
+#include <cstdio>
 
 SYSTEM_THREAD(ENABLED);
 SYSTEM_MODE(SEMI_AUTOMATIC);
@@ -46,11 +48,27 @@ STARTUP(
 
 #if PLATFORM_ID == PLATFORM_GCC
 #include <csignal>
+// set by the signal handler, pending objects are persisted and the program exits from the main loop
+volatile sig_atomic_t exitSignal = 0;
+
 void
 signal_handler(int signal)
 {
+    exitSignal = signal;
+}
 
-    exit(signal);
+void
+handleExitSignal()
+{
+    if (exitSignal) {
+        brewbloxBox().persistPendingObjects();
+        exit(exitSignal);
+    }
+}
+#else
+inline void
+handleExitSignal()
+{
 }
 #endif
 
@@ -76,6 +94,32 @@ watchdogCheckin()
 }
 #endif
 
+// sums the drawing work of the display frames and logs it once per minute
+void
+logDisplayStats(ticks_millis_t now)
+{
+    static ticks_millis_t lastLog = 0;
+    static uint32_t frames = 0;
+    static uint32_t redrawnObjects = 0;
+    static uint32_t lcdBytes = 0;
+
+    auto stats = D4D_GetFrameStats(); // counters of the frame that ended with the last D4D_Poll
+    ++frames;
+    redrawnObjects += stats->redrawnObjects;
+    lcdBytes += stats->lcdBytes;
+
+    if (now - lastLog >= 60000) {
+        char buf[80];
+        snprintf(buf, sizeof(buf), "display: %lu frames, %lu objects redrawn, %lu LCD bytes",
+                 (unsigned long)frames, (unsigned long)redrawnObjects, (unsigned long)lcdBytes);
+        CL_LOG_DEBUG(buf);
+        lastLog = now;
+        frames = 0;
+        redrawnObjects = 0;
+        lcdBytes = 0;
+    }
+}
+
 void
 displayTick()
 {
@@ -84,6 +128,7 @@ displayTick()
     if (now > lastTick + 40) {
         lastTick = now;
         D4D_Poll();
+        logDisplayStats(now);
         D4D_CheckTouchScreen();
         D4D_TimeTickPut();
         D4D_FlushOutput();
@@ -95,6 +140,7 @@ onSetupModeBegin()
 {
     ListeningScreen::activate();
     manageConnections(ticks.millis()); // stop http server
+    brewbloxBox().persistPendingObjects();
     brewbloxBox().unloadAllObjects();
     brewbloxBox().disconnect();
     HAL_Delay_Milliseconds(100);
@@ -206,6 +252,7 @@ loop()
     }
     ticks.switchTaskTimer(TicksClass::TaskId::System);
     cbox::tracing::add(AppTrace::SYSTEM_TASKS);
+    handleExitSignal();
     HAL_Delay_Milliseconds(1);
 }
 
@@ -29,7 +29,113 @@
 #include "proto/test/cpp/DigitalActuator_test.pb.h"
 #include "proto/test/cpp/SetpointSensorPair_test.pb.h"
 #include "proto/test/cpp/TempSensorMock_test.pb.h"
+#include <random>
 #include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+// the recursive evaluator that parsed the expression on every update, used as reference for the compiled program
+struct ReferenceEvaluator {
+    const std::string& expression;
+    const std::vector<blox_Compare_Result>& digitals;
+    const std::vector<blox_Compare_Result>& analogs;
+
+    blox_Compare_Result evaluate(uint8_t& errorPos) const
+    {
+        errorPos = 0;
+        if (expression.empty()) {
+            return blox_Compare_Result_RESULT_EMPTY;
+        }
+        auto it = expression.cbegin();
+        auto result = eval(it, 0);
+        if (result > blox_Compare_Result_RESULT_TRUE) {
+            errorPos = it - expression.cbegin() - 1;
+        }
+        return result;
+    }
+
+    blox_Compare_Result eval(std::string::const_iterator& it, uint8_t level) const
+    {
+        blox_Compare_Result res = blox_Compare_Result_RESULT_EMPTY_SUBSTRING;
+        while (it < expression.cend()) {
+            if (res > blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
+                return res;
+            }
+            auto c = *it;
+            ++it;
+            if ('a' <= c && c <= 'z') {
+                if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
+                    return blox_Compare_Result_RESULT_UNEXPECTED_COMPARISON;
+                }
+                if (size_t(c - 'a') >= digitals.size()) {
+                    return blox_Compare_Result_RESULT_UNDEFINED_DIGITAL_COMPARE;
+                }
+                res = digitals[c - 'a'];
+            } else if ('A' <= c && c <= 'Z') {
+                if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
+                    return blox_Compare_Result_RESULT_UNEXPECTED_COMPARISON;
+                }
+                if (size_t(c - 'A') >= analogs.size()) {
+                    return blox_Compare_Result_RESULT_UNDEFINED_ANALOG_COMPARE;
+                }
+                res = analogs[c - 'A'];
+            } else if (c == '!') {
+                auto rhs = eval(it, level);
+                if (rhs > blox_Compare_Result_RESULT_TRUE) {
+                    return rhs;
+                }
+                return rhs == blox_Compare_Result_RESULT_TRUE ? blox_Compare_Result_RESULT_FALSE : blox_Compare_Result_RESULT_TRUE;
+            } else if (c == '|' || c == '&' || c == '^') {
+                if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
+                    return blox_Compare_Result_RESULT_UNEXPECTED_OPERATOR;
+                }
+                auto rhs = eval(it, level);
+                if (rhs > blox_Compare_Result_RESULT_TRUE) {
+                    return rhs;
+                }
+                if (c == '|') {
+                    return res == blox_Compare_Result_RESULT_TRUE ? res : rhs;
+                }
+                if (c == '&') {
+                    return res == blox_Compare_Result_RESULT_TRUE ? rhs : res;
+                }
+                return rhs != res ? blox_Compare_Result_RESULT_TRUE : blox_Compare_Result_RESULT_FALSE;
+            } else if (c == '(') {
+                if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
+                    return blox_Compare_Result_RESULT_UNEXPECTED_OPEN_BRACKET;
+                }
+                res = eval(it, level + 1);
+            } else if (c == ')') {
+                if (level == 0) {
+                    return blox_Compare_Result_RESULT_UNEXPECTED_CLOSE_BRACKET;
+                }
+                return res;
+            } else {
+                return blox_Compare_Result_RESULT_UNEXPECTED_CHARACTER;
+            }
+        }
+        if (level > 0) {
+            return blox_Compare_Result_RESULT_MISSING_CLOSE_BRACKET;
+        }
+        return res;
+    }
+};
+
+std::string
+randomExpression(std::mt19937& gen, size_t maxLength)
+{
+    // mostly valid tokens, with some undefined compares and invalid characters
+    static const std::string tokens = "abcdeABCDE|&^!()(|&^!).";
+    std::uniform_int_distribution<size_t> length(1, maxLength);
+    std::uniform_int_distribution<size_t> token(0, tokens.size() - 1);
+    std::string expression;
+    for (auto n = length(gen); n > 0; n--) {
+        expression.push_back(tokens[token(gen)]);
+    }
+    return expression;
+}
+}
 
 SCENARIO("Test", "[maklogicblock]")
 {
@@ -354,6 +460,18 @@ SCENARIO("Test", "[maklogicblock]")
             result = setLogic(message);
             CHECK(result.result() == blox::Compare_Result_RESULT_BLOCK_NOT_FOUND);
             CHECK(result.errorpos() == 0);
+
+            // compares are only evaluated when the expression needs them
+            setAct(101, blox::DigitalState::Active);
+            message.set_expression("a|b");
+            result = setLogic(message);
+            CHECK(result.result() == blox::Compare_Result_RESULT_TRUE);
+            CHECK(result.errorpos() == 0);
+
+            message.set_expression("c|b");
+            result = setLogic(message);
+            CHECK(result.result() == blox::Compare_Result_RESULT_BLOCK_NOT_FOUND);
+            CHECK(result.errorpos() == 2);
         }
 
         AND_WHEN("Analog comparisons are used")
@@ -404,3 +522,134 @@ SCENARIO("Test", "[maklogicblock]")
         }
     }
 }
+
+SCENARIO("A compiled ActuatorLogic program gives the same result as parsing the expression", "[maklogicblock]")
+{
+    std::mt19937 gen(1234);
+    std::bernoulli_distribution coin;
+    std::vector<blox_Compare_Result> digitals(4);
+    std::vector<blox_Compare_Result> analogs(4);
+    auto randomize = [&]() {
+        for (auto& d : digitals) {
+            d = coin(gen) ? blox_Compare_Result_RESULT_TRUE : blox_Compare_Result_RESULT_FALSE;
+        }
+        for (auto& a : analogs) {
+            a = coin(gen) ? blox_Compare_Result_RESULT_TRUE : blox_Compare_Result_RESULT_FALSE;
+        }
+    };
+    uint32_t evaluated = 0;
+    auto digital = [&digitals, &evaluated](uint8_t i) { ++evaluated; return digitals[i]; };
+    auto analog = [&analogs, &evaluated](uint8_t i) { ++evaluated; return analogs[i]; };
+
+    WHEN("Random expressions are evaluated with random compare results")
+    {
+        size_t mismatches = 0;
+        std::string firstMismatch;
+        size_t valid = 0;
+        for (int i = 0; i < 20000; i++) {
+            auto expression = randomExpression(gen, i < 10000 ? 8 : 40);
+            LogicProgram program;
+            program.compile(expression, digitals.size(), analogs.size());
+            for (int j = 0; j < 4; j++) {
+                randomize();
+                uint8_t refPos = 0;
+                uint8_t pos = 0;
+                auto ref = ReferenceEvaluator{expression, digitals, analogs}.evaluate(refPos);
+                auto res = program.run(digital, analog, pos);
+                if (ref != res || refPos != pos) {
+                    if (mismatches++ == 0) {
+                        firstMismatch = expression;
+                    }
+                }
+                valid += res <= blox_Compare_Result_RESULT_TRUE;
+            }
+        }
+        CHECK(mismatches == 0);
+        CHECK(firstMismatch == "");
+        CHECK(valid > 1000); // the random expressions are not all invalid
+    }
+
+    WHEN("An expression is invalid, the program is empty and returns the parse error")
+    {
+        LogicProgram program;
+        program.compile("a|(b&.)", digitals.size(), analogs.size());
+        uint8_t pos = 0;
+        CHECK(program.size() == 0);
+        CHECK(program.run(digital, analog, pos) == blox_Compare_Result_RESULT_UNEXPECTED_CHARACTER);
+        CHECK(pos == 5);
+        CHECK(evaluated == 0);
+    }
+
+    WHEN("The result is known before the end of the program, the other compares are not evaluated")
+    {
+        LogicProgram program;
+        program.compile("a|(b&C)|(D^c)", digitals.size(), analogs.size());
+        uint8_t pos = 0;
+        digitals[0] = blox_Compare_Result_RESULT_TRUE;
+        CHECK(program.run(digital, analog, pos) == blox_Compare_Result_RESULT_TRUE);
+        CHECK(evaluated == 1);
+
+        evaluated = 0;
+        digitals[0] = blox_Compare_Result_RESULT_FALSE;
+        digitals[1] = blox_Compare_Result_RESULT_FALSE;
+        digitals[2] = blox_Compare_Result_RESULT_TRUE;
+        analogs[3] = blox_Compare_Result_RESULT_FALSE;
+        CHECK(program.run(digital, analog, pos) == blox_Compare_Result_RESULT_TRUE);
+        CHECK(evaluated == 4); // C is skipped
+    }
+
+    WHEN("A compare returns an error, the program stops with the error at the position of the compare")
+    {
+        LogicProgram program;
+        program.compile("a|(b&C)", digitals.size(), analogs.size());
+        uint8_t pos = 0;
+        digitals[1] = blox_Compare_Result_RESULT_TRUE;
+        analogs[2] = blox_Compare_Result_RESULT_BLOCK_NOT_FOUND;
+        CHECK(program.run(digital, analog, pos) == blox_Compare_Result_RESULT_BLOCK_NOT_FOUND);
+        CHECK(pos == 5);
+
+        THEN("The error is not returned when the compare is not reached")
+        {
+            digitals[0] = blox_Compare_Result_RESULT_TRUE;
+            CHECK(program.run(digital, analog, pos) == blox_Compare_Result_RESULT_TRUE);
+            CHECK(pos == 0);
+        }
+    }
+}
+
+// Run with --durations yes to compare the time spent in each section
+TEST_CASE("Benchmark ActuatorLogic evaluation, parsing the expression versus a compiled program", "[.][benchmark]")
+{
+    const std::string expression = "(a|b|c)&!(A^B)&(C|D|(d&!e))";
+    std::vector<blox_Compare_Result> digitals(5, blox_Compare_Result_RESULT_FALSE);
+    std::vector<blox_Compare_Result> analogs(4, blox_Compare_Result_RESULT_TRUE);
+    const int updates = 1000000;
+    uint32_t evaluated = 0;
+    uint32_t trueCount = 0;
+
+    SECTION("Parse every update, evaluating all compares")
+    {
+        ReferenceEvaluator ref{expression, digitals, analogs};
+        for (int u = 0; u < updates; u++) {
+            digitals[u % 3] = blox_Compare_Result(u & 1);
+            evaluated += digitals.size() + analogs.size();
+            uint8_t pos;
+            trueCount += ref.evaluate(pos) == blox_Compare_Result_RESULT_TRUE;
+        }
+    }
+
+    SECTION("Compiled program, evaluating the compares it reaches")
+    {
+        LogicProgram program;
+        program.compile(expression, digitals.size(), analogs.size());
+        auto digital = [&digitals, &evaluated](uint8_t i) { ++evaluated; return digitals[i]; };
+        auto analog = [&analogs, &evaluated](uint8_t i) { ++evaluated; return analogs[i]; };
+        for (int u = 0; u < updates; u++) {
+            digitals[u % 3] = blox_Compare_Result(u & 1);
+            uint8_t pos;
+            trueCount += program.run(digital, analog, pos) == blox_Compare_Result_RESULT_TRUE;
+        }
+    }
+
+    WARN("compares evaluated: " << evaluated << ", true: " << trueCount);
+}
@@ -22,10 +22,14 @@
 #include "BrewBloxTestBox.h"
 #include "Temperature.h"
 #include "blox/ActuatorAnalogMockBlock.h"
+#include "blox/ActuatorPwmBlock.h"
+#include "blox/DigitalActuatorBlock.h"
 #include "blox/PidBlock.h"
 #include "blox/SetpointSensorPairBlock.h"
 #include "blox/TempSensorMockBlock.h"
 #include "proto/test/cpp/ActuatorAnalogMock_test.pb.h"
+#include "proto/test/cpp/ActuatorPwm_test.pb.h"
+#include "proto/test/cpp/DigitalActuator_test.pb.h"
 #include "proto/test/cpp/Pid_test.pb.h"
 #include "proto/test/cpp/SetpointSensorPair_test.pb.h"
 #include "proto/test/cpp/TempSensorMock_test.pb.h"
@@ -276,3 +280,141 @@ SCENARIO("A Blox Pid object with mock analog actuator")
         }
     }
 }
+
+SCENARIO("A sensor change reaches a PWM actuator driven by a Pid in a single update")
+{
+    BrewBloxTestBox testBox;
+    using commands = cbox::Box::CommandID;
+
+    testBox.reset();
+    auto sensorId = cbox::obj_id_t(100);
+    auto setpointId = cbox::obj_id_t(101);
+    auto actId = cbox::obj_id_t(102);
+    auto pwmId = cbox::obj_id_t(103);
+    auto pidId = cbox::obj_id_t(104);
+    auto sparkPinsId = cbox::obj_id_t(19); // system object 19 is Spark IO pins
+
+    // create mock sensor
+    testBox.put(uint16_t(0)); // msg id
+    testBox.put(commands::CREATE_OBJECT);
+    testBox.put(sensorId);
+    testBox.put(uint8_t(0xFF));
+    testBox.put(TempSensorMockBlock::staticTypeId());
+
+    auto newSensor = blox::TempSensorMock();
+    newSensor.set_setting(cnl::unwrap(temp_t(20.0)));
+    newSensor.set_connected(true);
+    testBox.put(newSensor);
+
+    testBox.processInput();
+    CHECK(testBox.lastReplyHasStatusOk());
+
+    // create pair without filter
+    testBox.put(uint16_t(0)); // msg id
+    testBox.put(commands::CREATE_OBJECT);
+    testBox.put(cbox::obj_id_t(setpointId));
+    testBox.put(uint8_t(0xFF));
+    testBox.put(SetpointSensorPairBlock::staticTypeId());
+
+    blox::SetpointSensorPair newPair;
+    newPair.set_sensorid(sensorId);
+    newPair.set_storedsetting(cnl::unwrap(temp_t(21)));
+    newPair.set_settingenabled(true);
+    newPair.set_filter(blox::FilterChoice::FILTER_NONE);
+    testBox.put(newPair);
+
+    testBox.processInput();
+    CHECK(testBox.lastReplyHasStatusOk());
+
+    // create digital actuator with Spark pin as target
+    testBox.put(uint16_t(0)); // msg id
+    testBox.put(commands::CREATE_OBJECT);
+    testBox.put(cbox::obj_id_t(actId));
+    testBox.put(uint8_t(0xFF));
+    testBox.put(DigitalActuatorBlock::staticTypeId());
+
+    auto newAct = blox::DigitalActuator();
+    newAct.set_hwdevice(sparkPinsId);
+    newAct.set_channel(1);
+    newAct.set_state(blox::DigitalState::Inactive);
+    testBox.put(newAct);
+
+    testBox.processInput();
+    CHECK(testBox.lastReplyHasStatusOk());
+
+    // create pwm actuator
+    testBox.put(uint16_t(0)); // msg id
+    testBox.put(commands::CREATE_OBJECT);
+    testBox.put(cbox::obj_id_t(pwmId));
+    testBox.put(uint8_t(0xFF));
+    testBox.put(ActuatorPwmBlock::staticTypeId());
+
+    blox::ActuatorPwm newPwm;
+    newPwm.set_actuatorid(actId);
+    newPwm.set_desiredsetting(cnl::unwrap(ActuatorAnalog::value_t(0)));
+    newPwm.set_period(4000);
+    newPwm.set_enabled(true);
+    testBox.put(newPwm);
+
+    testBox.processInput();
+    CHECK(testBox.lastReplyHasStatusOk());
+
+    // create proportional only Pid, so its output only changes when its input changes
+    testBox.put(uint16_t(0)); // msg id
+    testBox.put(commands::CREATE_OBJECT);
+    testBox.put(cbox::obj_id_t(pidId));
+    testBox.put(uint8_t(0xFF));
+    testBox.put(PidBlock::staticTypeId());
+
+    blox::Pid newPid;
+    newPid.set_inputid(setpointId);
+    newPid.set_outputid(pwmId);
+    newPid.set_enabled(true);
+    newPid.set_kp(cnl::unwrap(Pid::in_t(10)));
+    newPid.set_ti(0);
+    newPid.set_td(0);
+    testBox.put(newPid);
+
+    testBox.processInput();
+    CHECK(testBox.lastReplyHasStatusOk());
+
+    auto sensorPtr = brewbloxBox().makeCboxPtr<TempSensorMockBlock>(sensorId).lock();
+    auto pairPtr = brewbloxBox().makeCboxPtr<SetpointSensorPairBlock>(setpointId).lock();
+    auto pwmPtr = brewbloxBox().makeCboxPtr<ActuatorPwmBlock>(pwmId).lock();
+    REQUIRE(sensorPtr);
+    REQUIRE(pairPtr);
+    REQUIRE(pwmPtr);
+
+    uint32_t now = 0;
+    auto changeSensorAndUpdate = [&](temp_t newSetting) {
+        sensorPtr->get().setting(newSetting);
+        auto pwmSetting = pwmPtr->getConstrained().setting();
+        auto sensorChanged = now;
+        // the sensor has a 1s update interval, step through it until the pair sees the new value
+        for (; now < sensorChanged + 1000; now += 10) {
+            testBox.update(now);
+            if (pairPtr->get().value() == newSetting) {
+                break;
+            }
+            // nothing downstream changes before the pair has the new value
+            CHECK(pwmPtr->getConstrained().setting() == pwmSetting);
+        }
+        REQUIRE(pairPtr->get().value() == newSetting);
+        // the same update() that gave the pair a new value also updated the Pid and the PWM
+        CHECK(pwmPtr->getConstrained().setting() != pwmSetting);
+        return pwmPtr->getConstrained().setting();
+    };
+
+    for (; now < 10'000; now += 100) {
+        testBox.update(now);
+    }
+    CHECK(pwmPtr->getConstrained().setting() == ActuatorAnalog::value_t(10)); // 1 degree below setpoint
+
+    CHECK(changeSensorAndUpdate(temp_t(19)) == ActuatorAnalog::value_t(20));
+
+    for (; now < 20'000; now += 100) {
+        testBox.update(now);
+    }
+
+    CHECK(changeSensorAndUpdate(temp_t(18)) == ActuatorAnalog::value_t(30));
+}
@@ -0,0 +1,281 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "d4dlcdhw_websocket_server_fb_encoder.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+const uint16_t screenWidth = 320;
+const uint16_t screenHeight = 240;
+
+using Screen = std::vector<uint16_t>;
+
+uint32_t
+get(const std::vector<uint8_t>& data, size_t& pos, uint8_t bytes)
+{
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < bytes && pos < data.size(); i++) {
+        v |= uint32_t(data[pos++]) << (8 * i);
+    }
+    return v;
+}
+
+// decodes a frame like a websocket client does, returns the frame type or 0 when the frame is malformed
+uint8_t
+decode(const std::vector<uint8_t>& data, Screen& screen)
+{
+    size_t pos = 0;
+    auto type = get(data, pos, 1);
+    while (pos < data.size()) {
+        auto record = get(data, pos, 1);
+        auto offset = get(data, pos, 4);
+        if (record == FrameEncoder::SPAN) {
+            for (auto runs = get(data, pos, 2); runs > 0; runs--) {
+                auto length = get(data, pos, 1);
+                auto color = uint16_t(get(data, pos, 2));
+                for (; length > 0; length--) {
+                    if (offset >= screen.size()) {
+                        return 0;
+                    }
+                    screen[offset++] = color;
+                }
+            }
+        } else if (record == FrameEncoder::RECT) {
+            auto width = get(data, pos, 2);
+            auto height = get(data, pos, 2);
+            auto color = uint16_t(get(data, pos, 2));
+            for (uint32_t y = 0; y < height; y++) {
+                for (uint32_t x = 0; x < width; x++) {
+                    auto p = offset + y * screenWidth + x;
+                    if (p >= screen.size()) {
+                        return 0;
+                    }
+                    screen[p] = color;
+                }
+            }
+        } else {
+            return 0;
+        }
+    }
+    return pos == data.size() ? type : 0;
+}
+
+// draws like the display driver does on the host, counting the pixel writes
+struct Display {
+    Screen drawn = Screen(screenWidth * screenHeight, 0);
+    FrameBuffer buffer{screenWidth, screenHeight};
+    uint32_t writes = 0;
+
+    void pixel(uint16_t x, uint16_t y, uint16_t color)
+    {
+        ++writes;
+        auto offset = uint32_t(y) * screenWidth + x;
+        drawn[offset] = color;
+        buffer.set(offset, color);
+    }
+
+    const std::vector<uint8_t>& flush(FrameEncoder& frame)
+    {
+        frame.begin(FrameEncoder::DELTA);
+        buffer.encodeChanges(frame);
+        return frame.finish();
+    }
+
+    void fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+    {
+        for (uint16_t row = y; row < y + h; row++) {
+            for (uint16_t col = x; col < x + w; col++) {
+                pixel(col, row, color);
+            }
+        }
+    }
+
+    // a character cell of 8x13 pixels is drawn row by row with foreground and background colors
+    void text(uint16_t x, uint16_t y, const std::string& s, uint16_t fg, uint16_t bg)
+    {
+        for (auto c : s) {
+            for (uint16_t row = 0; row < 13; row++) {
+                uint8_t bits = uint8_t((c * 37 + row * 11) ^ (row * c)); // not a real font, but as irregular
+                for (uint16_t col = 0; col < 8; col++) {
+                    pixel(x + col, y + row, (bits & (0x80 >> col)) ? fg : bg);
+                }
+            }
+            x += 8;
+        }
+    }
+
+    // redraws a value widget: background, border and text, like the temperature widgets on the main screen
+    void widget(uint16_t x, uint16_t y, const std::string& value)
+    {
+        fill(x, y, 100, 2, 0x8410);
+        fill(x, y + 2, 100, 26, 0x0010);
+        text(x + 10, y + 8, value, 0xFFFF, 0x0010);
+    }
+};
+}
+
+SCENARIO("Pixel writes of the websocket display are encoded as spans and rectangles", "[websocket]")
+{
+    Screen screen(screenWidth * screenHeight, 0);
+    FrameEncoder frame(screenWidth);
+
+    WHEN("No pixels are added, the frame is empty")
+    {
+        CHECK(frame.empty());
+        CHECK(frame.finish() == std::vector<uint8_t>{FrameEncoder::DELTA});
+    }
+
+    WHEN("A rectangle is filled row by row, it is sent as one rectangle")
+    {
+        for (uint32_t y = 10; y < 30; y++) {
+            for (uint32_t x = 5; x < 105; x++) {
+                frame.add(y * screenWidth + x, 0x1234);
+            }
+        }
+        auto& data = frame.finish();
+        CHECK(data.size() == 1 + 11);
+        CHECK(decode(data, screen) == FrameEncoder::DELTA);
+        CHECK(screen[10 * screenWidth + 5] == 0x1234);
+        CHECK(screen[29 * screenWidth + 104] == 0x1234);
+        CHECK(screen[30 * screenWidth + 104] == 0);
+    }
+
+    WHEN("A row has multiple colors, it is sent as a span with a run per color")
+    {
+        for (uint32_t x = 0; x < 10; x++) {
+            frame.add(100 + x, x < 3 ? 1 : 2);
+        }
+        auto& data = frame.finish();
+        CHECK(data == std::vector<uint8_t>{FrameEncoder::DELTA, FrameEncoder::SPAN, 100, 0, 0, 0, 2, 0, 3, 1, 0, 7, 2, 0});
+    }
+
+    WHEN("Runs are longer than 255 pixels, they are split")
+    {
+        for (uint32_t i = 0; i < 1000; i++) {
+            frame.add(i, 7);
+        }
+        CHECK(decode(frame.finish(), screen) == FrameEncoder::DELTA);
+        CHECK(std::count(screen.cbegin(), screen.cend(), 7) == 1000);
+    }
+
+    WHEN("Random pixels are written, the decoded frame has the same pixels")
+    {
+        std::mt19937 gen(1234);
+        std::uniform_int_distribution<uint32_t> offsets(0, screen.size() - 1);
+        std::uniform_int_distribution<uint16_t> colors(0, 3);
+        std::uniform_int_distribution<uint16_t> lengths(1, 400);
+        Screen expected(screen.size(), 0);
+        for (int i = 0; i < 2000; i++) {
+            auto offset = offsets(gen);
+            auto color = colors(gen);
+            for (auto n = lengths(gen); n > 0 && offset < screen.size(); n--) {
+                frame.add(offset, color);
+                expected[offset++] = color;
+                if (colors(gen) == 0) {
+                    color = colors(gen);
+                }
+            }
+        }
+        CHECK(decode(frame.finish(), screen) == FrameEncoder::DELTA);
+        CHECK(screen == expected);
+    }
+
+    WHEN("A frame is started again, the pixels of the previous frame are discarded")
+    {
+        frame.add(1, 1);
+        frame.begin(FrameEncoder::DELTA);
+        CHECK(frame.empty());
+        frame.add(2, 1);
+        CHECK(frame.finish().size() == 1 + 10);
+    }
+}
+
+SCENARIO("The websocket display buffer only sends the pixels that changed since the last frame", "[websocket]")
+{
+    Screen screen(screenWidth * screenHeight, 0);
+    FrameEncoder frame(screenWidth);
+    Display display;
+    display.widget(10, 40, "21.5 C");
+    CHECK(decode(display.flush(frame), screen) == FrameEncoder::DELTA);
+    CHECK(screen == display.drawn);
+
+    WHEN("A widget is redrawn without changes, the frame is empty")
+    {
+        display.widget(10, 40, "21.5 C");
+        CHECK(display.flush(frame).size() == 1);
+    }
+
+    WHEN("A widget is redrawn with a new value, a client that applies all frames shows the same screen")
+    {
+        display.widget(10, 40, "21.6 C");
+        display.widget(10, 80, "-3.25 C");
+        display.pixel(319, 239, 0x1234);
+        CHECK(decode(display.flush(frame), screen) == FrameEncoder::DELTA);
+        CHECK(screen == display.drawn);
+    }
+
+    WHEN("A keyframe is encoded, it decodes to the screen that was sent")
+    {
+        display.widget(10, 80, "-3.25 C");
+        display.flush(frame);
+        display.pixel(0, 0, 0x1234); // not sent yet
+
+        Screen newClient(screen.size(), 0xFFFF);
+        FrameEncoder keyframe(screenWidth, FrameEncoder::KEYFRAME);
+        display.buffer.encodeAll(keyframe);
+        auto& data = keyframe.finish();
+        CHECK(decode(data, newClient) == FrameEncoder::KEYFRAME);
+        CHECK(newClient[0] == 0);
+        newClient[0] = 0x1234;
+        CHECK(newClient == display.drawn);
+        CHECK(data.size() < screen.size() * sizeof(uint16_t) / 10);
+    }
+
+}
+
+// Run with -s to print the bytes sent for each kind of update
+TEST_CASE("Benchmark websocket display bytes per widget update, pixels versus frames", "[.][benchmark]")
+{
+    Display display;
+    FrameEncoder frame(screenWidth);
+    display.widget(10, 40, "21.5 C");
+    display.flush(frame);
+
+    auto update = [&](const std::string& value) {
+        display.writes = 0;
+        display.widget(10, 40, value);
+        auto frameBytes = display.flush(frame).size();
+        auto pixelBytes = display.writes * 8; // an address and color per written pixel
+        WARN(value << ": " << display.writes << " pixels written, " << pixelBytes << " bytes as pixels, " << frameBytes << " bytes as frame");
+        CHECK(frameBytes * 20 < pixelBytes);
+    };
+
+    update("21.6 C");  // one character changes
+    update("19.25 C"); // all characters change
+    update("19.25 C"); // redrawn without changes
+
+    FrameEncoder keyframe(screenWidth, FrameEncoder::KEYFRAME);
+    display.buffer.encodeAll(keyframe);
+    WARN("keyframe: " << keyframe.finish().size() << " bytes, " << display.drawn.size() * 8 << " bytes as pixels");
+}
@@ -16,6 +16,11 @@ make -j $MAKE_ARGS -s runner;
 (( result = $? ))
 status $result
 (( exit_status = exit_status || result ))
+echo "Building lib unit tests with the fast fixed point primitives"
+make -j $MAKE_ARGS -s runner FAST_FIXED_POINT=y TARGETDIR=build-fast/;
+(( result = $? ))
+status $result
+(( exit_status = exit_status || result ))
 popd > /dev/null
 
 pushd "$MY_DIR/../app/brewblox/test" > /dev/null
@@ -32,6 +37,11 @@ make -j $MAKE_ARGS -s runner;
 (( result = $? ))
 status $result
 (( exit_status = exit_status || result ))
+echo "Building controlbox unit tests with per object profiling"
+make -j $MAKE_ARGS -s runner CBOX_PROFILING=y TARGETDIR=build-profiling/;
+(( result = $? ))
+status $result
+(( exit_status = exit_status || result ))
 popd > /dev/null
 
 exit $exit_status
\ No newline at end of file
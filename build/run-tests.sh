@@ -18,6 +18,14 @@ status $result
 (( exit_status = exit_status || result ))
 popd > /dev/null
 
+echo "Running lib unit tests with the fast fixed point primitives"
+pushd "$MY_DIR/../lib/test/build-fast" > /dev/null
+./lib_test_runner --durations yes;
+(( result = $? ))
+status $result
+(( exit_status = exit_status || result ))
+popd > /dev/null
+
 echo "Running ControlBox unit tests"
 pushd "$MY_DIR/../controlbox/build/" > /dev/null
 ./cbox_test_runner --durations yes;
@@ -26,6 +34,14 @@ status $result
 (( exit_status = exit_status || result ))
 popd > /dev/null
 
+echo "Running ControlBox unit tests with per object profiling"
+pushd "$MY_DIR/../controlbox/build-profiling/" > /dev/null
+./cbox_test_runner --durations yes;
+(( result = $? ))
+status $result
+(( exit_status = exit_status || result ))
+popd > /dev/null
+
 
 echo "Running BrewBlox unit tests"
 pushd "$MY_DIR/../app/brewblox/test/build" > /dev/null
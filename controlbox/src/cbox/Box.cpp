@@ -33,6 +33,8 @@
 #include "ObjectStorage.h"
 #include "ScanningFactory.h"
 #include "Tracing.h"
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <tuple>
 #include <vector>
@@ -110,6 +112,146 @@ Box::readObject(DataIn& in, EncodedDataOut& out)
     }
 }
 
+/**
+ * Activates, persists and deactivates an object as needed after new settings have been streamed into it
+ */
+CboxError
+Box::storeWrittenObject(ContainedObject& cobj)
+{
+    CboxError status = CboxError::OK;
+    obj_id_t id = cobj.id();
+
+    // check if object was inactive and should become active
+    if (cobj.object()->typeId() == InactiveObject::staticTypeId()
+        && ((cobj.groups() & activeGroups) != 0)) {
+        std::shared_ptr<Object> obj;
+
+        bool handlerCalled = false;
+        auto streamHandler = [this, &obj, &handlerCalled](RegionDataIn& objInStorage) -> CboxError {
+            handlerCalled = true;
+            RegionDataIn objWithoutCrc(objInStorage, objInStorage.available() - 1);
+
+            uint8_t storedGroups; // discarded
+            CboxError status;
+            std::tie(status, obj, storedGroups) = createObjectFromStream(objWithoutCrc);
+
+            return status;
+        };
+        status = storage.retrieveObject(storage_id_t(id), streamHandler);
+
+        if (!handlerCalled) {
+            status = CboxError::INVALID_OBJECT_ID; // write status if handler has not written it
+        }
+        if (status == CboxError::OK) {
+            // replace contained object through the container, so cached lookups of it are refreshed
+            if (objects.add(std::move(obj), cobj.groups(), id, true) == obj_id_t::invalid()) {
+                status = CboxError::INVALID_OBJECT_ID;
+            }
+        }
+    }
+    if (status == CboxError::OK) {
+        // save new settings to storage
+        if ((cobj.groups() & activeGroups) == 0) {
+            status = storeObjectNow(cobj); // the object is deactivated below, it cannot be persisted later
+        } else {
+            status = persistObject(cobj);
+        }
+    }
+
+    // deactivate object if it is not a system object and is not in an active group
+    if ((cobj.groups() & activeGroups) == 0) {
+        objects.deactivate(id);
+    }
+    // the written settings can link the object to other objects
+    objects.refreshLinks(id);
+    return status;
+}
+
+CboxError
+Box::storeObjectNow(const ContainedObject& cobj)
+{
+    auto storeContained = [&cobj](DataOut& storage) -> CboxError {
+        return cobj.streamPersistedTo(storage);
+    };
+    return storage.storeObject(cobj.id(), storeContained);
+}
+
+/**
+ * Persists the object after the persist delay, unless it is already waiting to be persisted.
+ * The reply to the writer cannot carry errors that occur when the object is persisted later.
+ * Those are reported as an event on the log output, see reportPersistError.
+ */
+CboxError
+Box::persistObject(const ContainedObject& cobj)
+{
+    if (persistDelay == 0) {
+        return storeObjectNow(cobj);
+    }
+    auto id = cobj.id();
+    auto pending = std::find_if(pendingStores.cbegin(), pendingStores.cend(), [&id](const PendingStore& p) {
+        return p.id == id;
+    });
+    if (pending == pendingStores.cend()) {
+        pendingStores.push_back(PendingStore{id, lastUpdateTime + persistDelay, false});
+    }
+    return CboxError::OK;
+}
+
+// persist at most one object per update, to spread the time spent writing storage over multiple updates
+void
+Box::persistDueObject(const update_t& now)
+{
+    if (pendingStores.empty() || !ContainedObject::isDue(pendingStores.front().due, now)) {
+        return;
+    }
+    auto pending = pendingStores.front();
+    pendingStores.erase(pendingStores.begin());
+    if (auto cobj = objects.fetchContained(pending.id)) {
+        auto status = storeObjectNow(*cobj);
+        if (status != CboxError::OK) {
+            // report once, but keep retrying: deleting other objects can free up storage
+            if (!pending.failed) {
+                reportPersistError(pending.id, status);
+            }
+            pendingStores.push_back(PendingStore{pending.id, now + persistDelay, true});
+        }
+    }
+}
+
+// objects that cannot be stored here are dropped, because storage has to match the active objects afterwards
+void
+Box::persistPendingObjects()
+{
+    for (auto& pending : pendingStores) {
+        if (auto cobj = objects.fetchContained(pending.id)) {
+            auto status = storeObjectNow(*cobj);
+            if (status != CboxError::OK && !pending.failed) {
+                reportPersistError(pending.id, status);
+            }
+        }
+    }
+    pendingStores.clear();
+}
+
+/**
+ * Writes an event to the log output for an object that could not be persisted after a delay.
+ * Format: <!PERSIST ERROR ID:iiii CBOXERROR:ee>, with the object id and error code in hex.
+ */
+void
+Box::reportPersistError(const obj_id_t& id, CboxError error)
+{
+    std::string msg = "PERSIST ERROR ID:";
+    uint16_t idValue = id;
+    for (int shift = 12; shift >= 0; shift -= 4) {
+        msg.push_back(d2h(uint8_t((idValue >> shift) & 0xF)));
+    }
+    msg += " CBOXERROR:";
+    msg.push_back(d2h(uint8_t(asUint8(error) >> 4)));
+    msg.push_back(d2h(uint8_t(asUint8(error) & 0xF)));
+    EncodedDataOut out(connections.logDataOut());
+    out.writeEvent(std::move(msg));
+}
+
 void
 Box::writeObject(DataIn& in, EncodedDataOut& out)
 {
@@ -136,54 +278,164 @@ Box::writeObject(DataIn& in, EncodedDataOut& out)
     }
 
     if (cobj != nullptr && status == CboxError::OK) {
-        // check if object was inactive and should become active
-        if (cobj->object()->typeId() == InactiveObject::staticTypeId()
-            && ((cobj->groups() & activeGroups) != 0)) {
-            obj_id_t id = cobj->id();
-            std::shared_ptr<Object> obj;
-
-            bool handlerCalled = false;
-            auto streamHandler = [this, &obj, &handlerCalled](RegionDataIn& objInStorage) -> CboxError {
-                handlerCalled = true;
-                RegionDataIn objWithoutCrc(objInStorage, objInStorage.available() - 1);
-
-                uint8_t storedGroups; // discarded
-                CboxError status;
-                std::tie(status, obj, storedGroups) = createObjectFromStream(objWithoutCrc);
+        status = storeWrittenObject(*cobj);
+    }
 
-                return status;
-            };
-            status = storage.retrieveObject(storage_id_t(id), streamHandler);
+    out.writeResponseSeparator();
+    out.write(asUint8(status));
+    if (cobj != nullptr && status == CboxError::OK) {
+        objects.forcedUpdate(*cobj, lastUpdateTime); // force an update of the object
+        status = cobj->streamTo(out);
+        if (status != CboxError::OK) {
+            out.writeError(status);
+            out.invalidateCrc();
+        }
+    }
+}
+
+/**
+ * Streams a single object as a list item of a batched command: per object status, followed by the object
+ */
+void
+Box::streamListedObject(const ContainedObject& cobj, EncodedDataOut& out)
+{
+    out.writeListSeparator();
+    out.write(asUint8(CboxError::OK));
+    auto status = cobj.streamTo(out);
+    if (status != CboxError::OK) {
+        out.writeError(status);
+        out.invalidateCrc();
+    }
+}
+
+/**
+ * Writes a list item with an error status for an object that could not be read or written in a batched command
+ */
+void
+Box::streamListedError(const obj_id_t& id, CboxError status, EncodedDataOut& out)
+{
+    out.writeListSeparator();
+    out.write(asUint8(status));
+    out.put(id);
+}
+
+/**
+ * Reads multiple objects with a single command.
+ * Input is an interface type filter (0 for any type), followed by the number of requested ids and the ids.
+ * When no ids are given, all objects implementing the interface are sent.
+ * Each object is sent as a list item with its own status, so a single missing object does not fail the request.
+ */
+void
+Box::readObjects(DataIn& in, EncodedDataOut& out)
+{
+    CboxError status = CboxError::OK;
+    obj_type_t interfaceType = 0;
+    uint16_t count = 0;
+    std::vector<obj_id_t> ids;
 
-            if (!handlerCalled) {
-                status = CboxError::INVALID_OBJECT_ID; // write status if handler has not written it
+    if (!in.get(interfaceType) || !in.get(count)) {
+        status = CboxError::INPUT_STREAM_READ_ERROR;
+    } else {
+        ids.reserve(count);
+        for (uint16_t i = 0; i < count; i++) {
+            obj_id_t id;
+            if (!in.get(id)) {
+                status = CboxError::INPUT_STREAM_READ_ERROR;
+                break;
             }
-            if (status == CboxError::OK) {
-                *cobj = ContainedObject(id, cobj->groups(), std::move(obj)); // replace contained object
+            ids.push_back(id);
+        }
+    }
+
+    in.spool();
+    if (out.crc()) {
+        status = CboxError::CRC_ERROR_IN_COMMAND;
+    }
+    out.writeResponseSeparator();
+    out.write(asUint8(status));
+    if (status != CboxError::OK) {
+        return;
+    }
+
+    if (ids.empty()) {
+        for (auto it = objects.cbegin(); it < objects.cend(); it++) {
+            if (interfaceType == 0 || it->object()->implements(interfaceType)) {
+                streamListedObject(*it, out);
             }
         }
-        if (status == CboxError::OK) {
-            // save new settings to storage
-            auto storeContained = [&cobj](DataOut& storage) -> CboxError {
-                return cobj->streamPersistedTo(storage);
-            };
-            status = storage.storeObject(id, storeContained);
+        return;
+    }
+
+    for (auto& id : ids) {
+        auto cobj = objects.fetchContained(id);
+        if (cobj == nullptr) {
+            streamListedError(id, CboxError::INVALID_OBJECT_ID, out);
+        } else if (interfaceType != 0 && !cobj->object()->implements(interfaceType)) {
+            streamListedError(id, CboxError::INVALID_OBJECT_TYPE, out);
+        } else {
+            streamListedObject(*cobj, out);
         }
+    }
+}
 
-        // deactivate object if it is not a system object and is not in an active group
-        if ((cobj->groups() & activeGroups) == 0) {
-            cobj->deactivate();
+/**
+ * Writes multiple objects with a single command.
+ * Input is the number of objects, followed by each object as id, length and length bytes of groups, type and data.
+ * The length allows skipping an object that cannot be written without losing track of the next one.
+ * All written objects are persisted after the command CRC has been checked.
+ * The response has a status for each object, followed by the object after the update or the id on failure.
+ */
+void
+Box::writeObjects(DataIn& in, EncodedDataOut& out)
+{
+    CboxError status = CboxError::OK;
+    uint16_t count = 0;
+    std::vector<std::pair<obj_id_t, CboxError>> results;
+
+    if (!in.get(count)) {
+        status = CboxError::INPUT_STREAM_READ_ERROR;
+    } else {
+        results.reserve(count);
+        for (uint16_t i = 0; i < count; i++) {
+            obj_id_t id;
+            stream_size_t length;
+            if (!in.get(id) || !in.get(length)) {
+                status = CboxError::INPUT_STREAM_READ_ERROR;
+                break;
+            }
+            RegionDataIn objIn(in, length);
+            auto objStatus = CboxError::INVALID_OBJECT_ID;
+            if (auto cobj = objects.fetchContained(id)) {
+                // stream new settings to object
+                objStatus = cobj->streamFrom(objIn);
+            }
+            objIn.spool();
+            results.emplace_back(id, objStatus);
         }
     }
 
+    in.spool();
+    if (out.crc()) {
+        status = CboxError::CRC_ERROR_IN_COMMAND;
+    }
     out.writeResponseSeparator();
     out.write(asUint8(status));
-    if (cobj != nullptr && status == CboxError::OK) {
-        cobj->forcedUpdate(lastUpdateTime); // force an update of the object
-        status = cobj->streamTo(out);
-        if (status != CboxError::OK) {
-            out.writeError(status);
-            out.invalidateCrc();
+    if (status != CboxError::OK) {
+        return;
+    }
+
+    for (auto& result : results) {
+        auto id = result.first;
+        auto objStatus = result.second;
+        auto cobj = objects.fetchContained(id);
+        if (cobj != nullptr && objStatus == CboxError::OK) {
+            objStatus = storeWrittenObject(*cobj);
+        }
+        if (cobj != nullptr && objStatus == CboxError::OK) {
+            objects.forcedUpdate(*cobj, lastUpdateTime); // force an update of the object
+            streamListedObject(*cobj, out);
+        } else {
+            streamListedError(id, objStatus, out);
         }
     }
 }
@@ -257,7 +509,7 @@ Box::createObject(DataIn& in, EncodedDataOut& out)
                 objects.remove(id);
             } else if (id >= userStartId() && !(ptrCobj->groups() & activeGroups)) {
                 // object should not be active, replace object with inactive object
-                ptrCobj->deactivate();
+                objects.deactivate(id);
             }
         } else {
             status = CboxError::INVALID_OBJECT_ID;
@@ -266,7 +518,7 @@ Box::createObject(DataIn& in, EncodedDataOut& out)
     out.writeResponseSeparator();
     out.write(asUint8(status));
     if (ptrCobj != nullptr && status == CboxError::OK) {
-        ptrCobj->forcedUpdate(lastUpdateTime); // force an update of the object
+        objects.forcedUpdate(*ptrCobj, lastUpdateTime); // force an update of the object
         status = ptrCobj->streamTo(out);
         if (status != CboxError::OK) {
             out.writeError(status);
@@ -303,6 +555,10 @@ Box::deleteObject(DataIn& in, EncodedDataOut& out)
 
     if (status == CboxError::OK) {
         status = objects.remove(id);
+        pendingStores.erase(std::remove_if(pendingStores.begin(), pendingStores.end(), [&id](const PendingStore& p) {
+                                return p.id == id;
+                            }),
+                            pendingStores.end());
         storage.disposeObject(storageId);
     }
 
@@ -333,6 +589,272 @@ Box::listActiveObjects(DataIn& in, EncodedDataOut& out)
     }
 }
 
+/**
+ * Lists only the objects that changed since a cursor sent by the client.
+ * The response starts with the new cursor, to be sent with the next request.
+ * Cursor 0 lists all objects.
+ * The change counter in the cursor is kept in RAM and restarts after a reboot, so the cursor also holds the epoch
+ * set by the application at boot. A cursor from another epoch is handled as cursor 0: the client receives all objects.
+ * Deleted objects are not reported, the client should list all objects to detect them.
+ *
+ * Changes are detected by streaming every object to a hash (see ObjectContainer::refreshVersions),
+ * so this command costs about as much as streaming all objects. Only the reply is smaller.
+ */
+void
+Box::listChangedObjects(DataIn& in, EncodedDataOut& out)
+{
+    CboxError status = CboxError::OK;
+    uint64_t cursor = 0;
+    if (!in.get(cursor)) {
+        status = CboxError::INPUT_STREAM_READ_ERROR; // LCOV_EXCL_LINE
+    }
+
+    in.spool();
+    if (out.crc()) {
+        status = CboxError::CRC_ERROR_IN_COMMAND;
+    }
+
+    out.writeResponseSeparator();
+    out.write(asUint8(status));
+    if (status != CboxError::OK) {
+        return;
+    }
+
+    auto changeCounter = objects.refreshVersions();
+    auto since = changeCounterOf(cursor);
+    out.put(cursorFor(changeCounter));
+    for (auto it = objects.cbegin(); it < objects.cend(); it++) {
+        if (it->version() > since) {
+            out.writeListSeparator();
+            it->streamTo(out);
+        }
+    }
+}
+
+/**
+ * Subscribes the connection that sent the command to changes of objects.
+ * Input is the minimum interval between pushes in ms, an interface type filter (0 for any type),
+ * the number of ids and the ids (none for all objects). An interval of 0 cancels the subscription.
+ * A pushed message has the same content as the reply to LIST_CHANGED_OBJECTS,
+ * but starts with the response separator because there is no command to echo.
+ */
+void
+Box::subscribeObjects(DataIn& in, EncodedDataOut& out)
+{
+    CboxError status = CboxError::OK;
+    uint16_t interval = 0;
+    obj_type_t interfaceType = 0;
+    uint16_t count = 0;
+    std::vector<obj_id_t> ids;
+
+    if (!in.get(interval) || !in.get(interfaceType) || !in.get(count)) {
+        status = CboxError::INPUT_STREAM_READ_ERROR;
+    } else {
+        ids.reserve(count);
+        for (uint16_t i = 0; i < count; i++) {
+            obj_id_t id;
+            if (!in.get(id)) {
+                status = CboxError::INPUT_STREAM_READ_ERROR;
+                break;
+            }
+            ids.push_back(id);
+        }
+    }
+
+    in.spool();
+    if (out.crc()) {
+        status = CboxError::CRC_ERROR_IN_COMMAND;
+    }
+
+    auto conn = connections.current();
+    if (status == CboxError::OK && conn == nullptr) {
+        status = CboxError::INVALID_COMMAND; // LCOV_EXCL_LINE: commands are always handled for a connection
+    }
+
+    if (status == CboxError::OK) {
+        std::sort(ids.begin(), ids.end());
+        auto& sub = conn->subscription();
+        sub.ids = std::move(ids);
+        sub.interfaceType = interfaceType;
+        sub.interval = interval;
+        sub.nextPush = lastUpdateTime;
+        sub.cursor = 0;
+        sub.framing = out.getFraming();
+    }
+
+    out.writeResponseSeparator();
+    out.write(asUint8(status));
+}
+
+/**
+ * Sends the objects that changed since the last push to each subscribed connection that is due.
+ * All changed objects for a connection are sent in a single message.
+ * When any subscription is due, all objects are streamed once to detect changes, see listChangedObjects.
+ */
+void
+Box::pushSubscriptions(const update_t& now)
+{
+    bool versionsRefreshed = false;
+    uint32_t changeCounter = 0;
+
+    connections.forEach([this, &now, &versionsRefreshed, &changeCounter](Connection& conn) {
+        auto& sub = conn.subscription();
+        if (!sub.active() || !ContainedObject::isDue(sub.nextPush, now)) {
+            return;
+        }
+        sub.nextPush = now + sub.interval;
+
+        if (!versionsRefreshed) {
+            changeCounter = objects.refreshVersions();
+            versionsRefreshed = true;
+        }
+        auto cursor = cursorFor(changeCounter);
+        if (cursor == sub.cursor) {
+            return;
+        }
+
+        auto since = changeCounterOf(sub.cursor);
+        auto isSubscribed = [&sub, &since](const ContainedObject& cobj) {
+            return cobj.version() > since
+                   && (sub.ids.empty() || std::binary_search(sub.ids.cbegin(), sub.ids.cend(), cobj.id()))
+                   && (sub.interfaceType == 0 || cobj.object()->implements(sub.interfaceType));
+        };
+
+        if (std::any_of(objects.cbegin(), objects.cend(), isSubscribed)) {
+            DataOut& dataOut = conn.getDataOut();
+            if (sub.framing == Framing::Binary) {
+                dataOut.write(binary_framing::start);
+            }
+            EncodedDataOut out(dataOut, sub.framing);
+            out.writeResponseSeparator();
+            out.write(asUint8(CboxError::OK));
+            out.put(cursor);
+            for (auto it = objects.cbegin(); it < objects.cend(); it++) {
+                if (isSubscribed(*it)) {
+                    out.writeListSeparator();
+                    it->streamTo(out);
+                }
+            }
+            out.endMessage();
+        }
+        sub.cursor = cursor;
+    });
+}
+
+#if CBOX_PROFILING
+/**
+ * Lists the time spent in each object since the last reset.
+ * Input is a single byte: 1 to reset the profiles after reading them.
+ * Each object is a list item of id, type, update count, cumulative and max update time,
+ * cumulative streamTo, streamFrom and persist time, all in us, followed by the update time histogram.
+ */
+void
+Box::readObjectProfiles(DataIn& in, EncodedDataOut& out)
+{
+    CboxError status = CboxError::OK;
+    uint8_t reset = 0;
+    if (!in.get(reset)) {
+        status = CboxError::INPUT_STREAM_READ_ERROR; // LCOV_EXCL_LINE
+    }
+
+    in.spool();
+    if (out.crc()) {
+        status = CboxError::CRC_ERROR_IN_COMMAND;
+    }
+
+    out.writeResponseSeparator();
+    out.write(asUint8(status));
+    if (status != CboxError::OK) {
+        return;
+    }
+
+    for (auto it = objects.cbegin(); it < objects.cend(); it++) {
+        const auto& profile = it->profile();
+        out.writeListSeparator();
+        out.put(it->id());
+        out.put(it->object()->typeId());
+        out.put(profile.updateCount);
+        out.put(profile.updateMicros);
+        out.put(profile.updateMicrosMax);
+        out.put(profile.streamToMicros);
+        out.put(profile.streamFromMicros);
+        out.put(profile.persistMicros);
+        for (auto& count : profile.updateHistogram) {
+            out.put(count);
+        }
+    }
+    if (reset) {
+        objects.resetProfiles();
+    }
+}
+#endif
+
+/**
+ * Sends traced events, starting at the sequence number sent by the client.
+ * The response contains the sequence number of the first sent event, which is higher than requested if events
+ * have been overwritten, the number of events and the events as action, id, type and timestamp.
+ * At most 32 events are sent per response, the client should repeat the command with the next sequence number
+ * until fewer events are returned.
+ */
+void
+Box::readTrace(DataIn& in, EncodedDataOut& out)
+{
+    CboxError status = CboxError::OK;
+    uint32_t cursor = 0;
+    if (!in.get(cursor)) {
+        status = CboxError::INPUT_STREAM_READ_ERROR; // LCOV_EXCL_LINE
+    }
+
+    in.spool();
+    if (out.crc()) {
+        status = CboxError::CRC_ERROR_IN_COMMAND;
+    }
+
+    out.writeResponseSeparator();
+    out.write(asUint8(status));
+    if (status != CboxError::OK) {
+        return;
+    }
+
+    std::array<tracing::TraceEvent, 32> events;
+    uint8_t count = tracing::drain(cursor, events.data(), events.size());
+    out.put(cursor);
+    out.put(count);
+    for (uint8_t i = 0; i < count; i++) {
+        out.put(events[i].action);
+        out.put(events[i].id);
+        out.put(events[i].type);
+        out.put(events[i].time);
+    }
+}
+
+/**
+ * Lists the counters of each connection, as kept by the connection pool.
+ * Each connection is a list item of commands handled, time spent handling them in us and input queued for the next loop.
+ */
+void
+Box::readConnectionStats(DataIn& in, EncodedDataOut& out)
+{
+    in.spool();
+    auto crc = out.crc();
+
+    out.writeResponseSeparator();
+
+    if (crc) {
+        out.write(asUint8(CboxError::CRC_ERROR_IN_COMMAND));
+        return;
+    }
+
+    out.write(asUint8(CboxError::OK));
+    connections.forEach([&out](Connection& conn) {
+        const auto& stats = conn.stats();
+        out.writeListSeparator();
+        out.put(stats.commands);
+        out.put(stats.micros);
+        out.put(stats.queuedBytes);
+    });
+}
+
 /**
  * Walks the object container and lists all objects that implement a certain interface
  */
@@ -398,6 +920,7 @@ Box::readStoredObject(DataIn& in, EncodedDataOut& out)
         }
         return CboxError::OK;
     };
+    persistPendingObjects(); // the stored object should match the active object
     status = storage.retrieveObject(storage_id_t(id), objectStreamer);
     if (!handlerCalled) {
         out.write(asUint8(CboxError::PERSISTED_OBJECT_NOT_FOUND)); // write status if handler has not written it
@@ -428,6 +951,7 @@ Box::listStoredObjects(DataIn& in, EncodedDataOut& out)
         }
         return CboxError::OUTPUT_STREAM_WRITE_ERROR; // LCOV_EXCL_LINE
     };
+    persistPendingObjects(); // the stored objects should match the active objects
     storage.retrieveObjects(listObjectStreamer);
 }
 
@@ -455,6 +979,7 @@ Box::loadObjectsFromStorage()
         if (auto ptrCobj = objects.fetchContained(objId)) {
             // existing object
             status = ptrCobj->streamFrom(tee);
+            objects.refreshLinks(objId);
 
             tee.spool();
             if (crcCalculator.crc() != 0) {
@@ -508,6 +1033,7 @@ Box::reboot(DataIn& in, EncodedDataOut& out)
     }
 
     out.write(asUint8(CboxError::OK));
+    persistPendingObjects();
 
     ::handleReset(true, 2);
 }
@@ -525,6 +1051,7 @@ Box::factoryReset(DataIn& in, EncodedDataOut& out)
         return;
     }
     out.write(asUint8(CboxError::OK));
+    pendingStores.clear(); // discard, storage is erased
     storage.clear();
 
     ::handleReset(true, 3);
@@ -609,13 +1136,33 @@ Box::discoverNewObjects(DataIn& in, EncodedDataOut& out)
  * Processes the command request from a data stream.
  * @param dataIn The request data. The first byte is the command id. The stream is assumed to contain at least
  *   this data.
+ * Commands starting with binary_framing::start are decoded as binary and answered with binary framing.
+ * Other commands are hex encoded.
  */
 void
 Box::handleCommand(DataIn& dataIn, DataOut& dataOut)
 {
-    HexTextToBinaryIn hexIn(dataIn);
-    EncodedDataOut out(dataOut); // hex encodes and adds CRC after response, supports protocol special characters
-    TeeDataIn in(hexIn, out);    // ensure command input is also echoed to output
+    if (dataIn.peek() == binary_framing::start) {
+        dataIn.next();
+        dataOut.write(binary_framing::start);
+        EscapedBinaryIn binaryIn(dataIn);
+        EncodedDataOut out(dataOut, Framing::Binary);
+        handleDecodedCommand(binaryIn, out, dataOut);
+        binaryIn.unBlock(); // consumes any leftover \r or \n
+        out.endMessage();
+    } else {
+        HexTextToBinaryIn hexIn(dataIn);
+        EncodedDataOut out(dataOut); // hex encodes and adds CRC after response, supports protocol special characters
+        handleDecodedCommand(hexIn, out, dataOut);
+        hexIn.unBlock(); // consumes any leftover \r or \n
+        out.endMessage();
+    }
+}
+
+void
+Box::handleDecodedCommand(DataIn& decodedIn, EncodedDataOut& out, DataOut& dataOut)
+{
+    TeeDataIn in(decodedIn, out); // ensure command input is also echoed to output
     uint16_t msg_id;
     in.get(msg_id);             // echo message id back
     uint8_t cmd_id = in.next(); // get command type code
@@ -663,6 +1210,29 @@ Box::handleCommand(DataIn& dataIn, DataOut& dataOut)
         case DISCOVER_NEW_OBJECTS:
             discoverNewObjects(in, out);
             break;
+        case READ_OBJECTS:
+            readObjects(in, out);
+            break;
+        case WRITE_OBJECTS:
+            writeObjects(in, out);
+            break;
+        case LIST_CHANGED_OBJECTS:
+            listChangedObjects(in, out);
+            break;
+        case SUBSCRIBE_OBJECTS:
+            subscribeObjects(in, out);
+            break;
+#if CBOX_PROFILING
+        case READ_OBJECT_PROFILES:
+            readObjectProfiles(in, out);
+            break;
+#endif
+        case READ_TRACE:
+            readTrace(in, out);
+            break;
+        case READ_CONNECTION_STATS:
+            readConnectionStats(in, out);
+            break;
         default:
             invalidCommand(in, out);
             break;
@@ -673,25 +1243,21 @@ Box::handleCommand(DataIn& dataIn, DataOut& dataOut)
             invalidCommand(in, out);
         }
     }
-
-    hexIn.unBlock(); // consumes any leftover \r or \n
-
-    out.endMessage();
 }
 
 void
 Box::hexCommunicate()
 {
+    // the pool calls the handler for each command, taking turns between connections
     connections.process([this](DataIn& in, DataOut& out) {
-        while (in.hasNext()) {
-            this->handleCommand(in, out);
-        }
+        this->handleCommand(in, out);
     });
 }
 
 void
 Box::setActiveGroupsAndUpdateObjects(const uint8_t newGroups)
 {
+    persistPendingObjects(); // deactivated objects cannot be persisted and activated objects are loaded from storage
     activeGroups = newGroups | 0x80; // system group cannot be disabled
     for (auto cit = objects.userbegin(); cit != objects.cend(); cit++) {
         obj_id_t objId = cit->id();
@@ -744,7 +1310,7 @@ Box::setActiveGroupsAndUpdateObjects(const uint8_t newGroups)
 }
 
 CboxError
-Box::storeUpdatedObject(const obj_id_t& id) const
+Box::storeUpdatedObject(const obj_id_t& id)
 {
 
     auto cobj = objects.fetchContained(id);
@@ -752,10 +1318,7 @@ Box::storeUpdatedObject(const obj_id_t& id) const
         return CboxError::INVALID_OBJECT_ID;
     }
 
-    auto storeContained = [&cobj](DataOut& storage) -> CboxError {
-        return cobj->streamPersistedTo(storage);
-    };
-    return storage.storeObject(id, storeContained);
+    return persistObject(*cobj);
 }
 
 CboxError
@@ -765,6 +1328,7 @@ Box::reloadStoredObject(const obj_id_t& id)
     if (cobj == nullptr) {
         return CboxError::INVALID_OBJECT_ID;
     }
+    persistPendingObjects();
 
     bool handlerCalled = false;
     auto streamHandler = [&cobj, &handlerCalled](RegionDataIn& objInStorage) -> CboxError {
@@ -790,6 +1354,7 @@ Box::reloadStoredObject(const obj_id_t& id)
     if (!handlerCalled) {
         return CboxError::INVALID_OBJECT_ID; // write status if handler has not written it
     }
+    objects.refreshLinks(id);
 
     return status;
 }
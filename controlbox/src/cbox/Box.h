@@ -47,6 +47,30 @@ private:
     uint8_t activeGroups = 0x81; // system group and first user group
     update_t lastUpdateTime = 0;
 
+    // Written objects are persisted after this delay, so repeated writes to the same object result in a single store.
+    // Pending objects are persisted one per update, in the order they were first written.
+    // When a store fails, the object stays pending and is retried after the delay.
+    struct PendingStore {
+        obj_id_t id;
+        update_t due;
+        bool failed; // the error of the first failed store has been reported
+    };
+    update_t persistDelay = 0;
+    std::vector<PendingStore> pendingStores;
+
+    // Cursors handed to clients hold the epoch in the high half and the change counter in the low half.
+    // The change counter restarts at each boot, so the application sets a new epoch at each boot.
+    uint32_t cursorEpoch = 0;
+    uint64_t cursorFor(uint32_t changeCounter) const
+    {
+        return (uint64_t(cursorEpoch) << 32) | changeCounter;
+    }
+    // returns the change counter of a cursor, or 0 for a cursor handed out in another epoch
+    uint32_t changeCounterOf(uint64_t cursor) const
+    {
+        return uint32_t(cursor >> 32) == cursorEpoch ? uint32_t(cursor) : 0;
+    }
+
     // command handlers
     void noop(DataIn& in, EncodedDataOut& out);
     void invalidCommand(DataIn& in, EncodedDataOut& out);
@@ -62,6 +86,26 @@ private:
     void factoryReset(DataIn& in, EncodedDataOut& out);
     void listCompatibleObjects(DataIn& in, EncodedDataOut& out);
     void discoverNewObjects(DataIn& in, EncodedDataOut& out);
+    void readObjects(DataIn& in, EncodedDataOut& out);
+    void writeObjects(DataIn& in, EncodedDataOut& out);
+    void listChangedObjects(DataIn& in, EncodedDataOut& out);
+    void subscribeObjects(DataIn& in, EncodedDataOut& out);
+#if CBOX_PROFILING
+    void readObjectProfiles(DataIn& in, EncodedDataOut& out);
+#endif
+    void readTrace(DataIn& in, EncodedDataOut& out);
+    void readConnectionStats(DataIn& in, EncodedDataOut& out);
+
+    void streamListedObject(const ContainedObject& cobj, EncodedDataOut& out);
+    void streamListedError(const obj_id_t& id, CboxError status, EncodedDataOut& out);
+    CboxError storeWrittenObject(ContainedObject& cobj);
+    CboxError persistObject(const ContainedObject& cobj);
+    CboxError storeObjectNow(const ContainedObject& cobj);
+    void persistDueObject(const update_t& now);
+    void reportPersistError(const obj_id_t& id, CboxError error);
+
+    void handleDecodedCommand(DataIn& decodedIn, EncodedDataOut& out, DataOut& dataOut);
+    void pushSubscriptions(const update_t& now);
 
     std::tuple<CboxError, std::shared_ptr<Object>, uint8_t> createObjectFromStream(DataIn& in);
     CboxError loadSingleObjectFromStorage(const storage_id_t& id, RegionDataIn& objInStorage);
@@ -81,7 +125,8 @@ public:
 
     void handleCommand(DataIn& data, DataOut& out);
 
-    // process all incoming messages assuming they are hex encoded
+    // process incoming messages, which can be hex encoded or use binary framing
+    // messages that do not fit in the time budget of the connection pool are processed in the next call
     void hexCommunicate();
 
     auto getObject(const obj_id_t& id)
@@ -101,6 +146,9 @@ public:
         lastUpdateTime = now;
         tracing::add(cbox::tracing::Action::UPDATE_OBJECTS);
         objects.update(now);
+        pushSubscriptions(now);
+        persistDueObject(now);
+        storage.compact();
     }
 
     void forcedUpdate(const update_t& now)
@@ -125,9 +173,30 @@ public:
     obj_id_t
     discoverNewObject(std::function<std::shared_ptr<Object>()>& discoverObject, std::function<bool(Object&, Object&)> isSame);
 
-    CboxError storeUpdatedObject(const obj_id_t& id) const;
+    CboxError storeUpdatedObject(const obj_id_t& id);
     CboxError reloadStoredObject(const obj_id_t& id);
 
+    /**
+     * Sets how long written objects may wait before they are persisted, in the same unit as update time.
+     * With the default of 0, objects are persisted when they are written.
+     */
+    void setPersistDelay(const update_t& delay)
+    {
+        persistDelay = delay;
+    }
+
+    /**
+     * Sets the epoch of the cursors handed out by LIST_CHANGED_OBJECTS and subscriptions.
+     * It should be different at each boot, for example a random number, so cursors from before a reboot list all objects.
+     */
+    void setCursorEpoch(uint32_t epoch)
+    {
+        cursorEpoch = epoch;
+    }
+
+    // persist all written objects that have not been persisted yet, for example before a reset
+    void persistPendingObjects();
+
     enum CommandID : uint8_t {
         NONE = 0,                     // no-op
         READ_OBJECT = 1,              // stream an object to the data out
@@ -142,6 +211,13 @@ public:
         FACTORY_RESET = 10,           // erase all settings and reboot
         LIST_COMPATIBLE_OBJECTS = 11, // list object IDs implementing the requested interface
         DISCOVER_NEW_OBJECTS = 12,    // discover newly connected objects that support auto discovery
+        READ_OBJECTS = 13,            // stream multiple objects to the data out in a single response
+        WRITE_OBJECTS = 14,           // stream new data into multiple objects from the data in
+        LIST_CHANGED_OBJECTS = 15,    // list active objects that changed since the cursor sent by the client
+        SUBSCRIBE_OBJECTS = 16,       // push changed objects to the connection, without polling
+        READ_OBJECT_PROFILES = 17,    // list time spent per object, only available when built with CBOX_PROFILING
+        READ_TRACE = 18,              // stream traced events, starting at the cursor sent by the client
+        READ_CONNECTION_STATS = 19,   // list the command counters of each connection
     };
     // application can add additional commands, starting at 100.
 
@@ -32,6 +32,27 @@ private:
     ObjectContainer& objects;
     std::weak_ptr<Object> ptr;
 
+    // The interface pointer found for the last requested type is cached, to skip the virtual implements() call.
+    // The lookup in the container is only repeated when the weak pointer expired or the container generation changed.
+    void* cachedInterface = nullptr;
+    obj_type_t cachedType = obj_type_t::invalid();
+    uint32_t cachedGeneration = 0;
+
+    std::shared_ptr<Object> lockObject()
+    {
+        auto sptr = ptr.lock();
+        auto generation = objects.generation();
+        if (!sptr || generation != cachedGeneration) {
+            // Try to lookup the object in the container
+            ptr = objects.fetch(id);
+            sptr = ptr.lock();
+            cachedGeneration = generation;
+            cachedType = obj_type_t::invalid();
+            cachedInterface = nullptr;
+        }
+        return sptr;
+    }
+
 public:
     explicit CboxPtr(ObjectContainer& _objects, const obj_id_t& _id = 0)
         : id(_id)
@@ -45,6 +66,8 @@ public:
         if (newId != id) {
             id = std::move(newId);
             ptr.reset();
+            cachedType = obj_type_t::invalid();
+            cachedInterface = nullptr;
         }
     }
 
@@ -74,17 +97,15 @@ public:
     std::shared_ptr<U> lock_as()
     {
         // try to lock the weak pointer we already had. If it cannot be locked, we need to do a lookup again
-        std::shared_ptr<Object> sptr;
-        sptr = ptr.lock();
-        if (!sptr) {
-            // Try to lookup the object in the container
-            ptr = objects.fetch(id);
-            sptr = ptr.lock();
-        }
+        std::shared_ptr<Object> sptr = lockObject();
         if (sptr) {
             // if the lookup succeeded, check if the Object implements the requested interface using the object types
             auto requestedType = interfaceId<U>();
-            void* thisPtr = sptr->implements(requestedType);
+            if (requestedType != cachedType) {
+                cachedInterface = sptr->implements(requestedType);
+                cachedType = requestedType;
+            }
+            void* thisPtr = cachedInterface;
             if (thisPtr != nullptr) {
                 // If the object returned a non-zero pointer, it supports the interface
                 // If multiple-inheritance is involved, it is possible that the shared pointer and interface pointer
@@ -112,12 +133,12 @@ public:
 
     std::function<std::shared_ptr<T>()> lockFunctor()
     {
-        return std::bind(&cbox::CboxPtr<T>::lock, this);
+        return [this]() { return lock(); };
     }
 
     std::function<std::shared_ptr<const T>()> lockFunctor() const
     {
-        return std::bind(&cbox::CboxPtr<T>::const_lock, this);
+        return [this]() { return const_lock(); };
     }
 
     /*
@@ -64,6 +64,13 @@ public:
         }
         return result;
     }
+
+    virtual void flush() override
+    {
+        for (auto& source : container) {
+            transformFunc(source).flush();
+        }
+    }
 };
 
 } // end namespace cbox
@@ -22,6 +22,8 @@
 #include "CompositeDataStream.h"
 #include "DataStream.h"
 #include "DataStreamConverters.h"
+#include "Object.h"
+#include "ObjectIds.h"
 #include "Tracing.h"
 #include <functional>
 #include <memory>
@@ -38,7 +40,38 @@ namespace cbox {
  *
  */
 
+/**
+ * The objects a connection wants to receive when they change, without polling.
+ * Changed objects are pushed at most once per interval, all in a single message.
+ */
+struct Subscription {
+    std::vector<obj_id_t> ids;      // sorted ids of the objects to push, empty for all objects
+    obj_type_t interfaceType = 0;   // only push objects implementing this interface, 0 for any type
+    update_t interval = 0;          // minimum time between pushes, 0 when not subscribed
+    update_t nextPush = 0;          // earliest time for the next push
+    uint64_t cursor = 0;            // cursor of the last push, with the epoch of the box
+    Framing framing = Framing::Hex; // framing of the subscribe command, also used for pushed messages
+
+    bool active() const
+    {
+        return interval != 0;
+    }
+};
+
+/**
+ * Counters for the commands a connection sent, kept by the ConnectionPool.
+ */
+struct ConnectionStats {
+    uint32_t commands = 0;    // number of commands handled
+    uint32_t micros = 0;      // time spent handling commands, only counted when the pool has a clock
+    uint16_t queuedBytes = 0; // input that was left for the next process call
+};
+
 class Connection {
+private:
+    Subscription _subscription;
+    ConnectionStats _stats;
+
 public:
     Connection() = default;
     virtual ~Connection() = default;
@@ -49,6 +82,16 @@ public:
     virtual DataIn& getDataIn() = 0;
     virtual bool isConnected() = 0;
     virtual void stop() = 0;
+
+    Subscription& subscription()
+    {
+        return _subscription;
+    }
+
+    ConnectionStats& stats()
+    {
+        return _stats;
+    }
 };
 
 class ConnectionSource {
@@ -140,18 +183,24 @@ public:
     }
 };
 
+// Size of the output buffer of stream connections.
+// Writes are collected in this buffer, so the stream is not written per byte.
+constexpr stream_size_t connectionBufferSize = 128;
+
 template <typename T>
 class StreamRefConnection : public Connection {
 private:
     T& stream;
     StreamDataIn<T> in;
-    StreamDataOut<T> out;
+    StreamDataOut<T> streamOut;
+    BufferedDataOut<connectionBufferSize> out;
 
 public:
     StreamRefConnection(T& _stream)
         : stream(_stream)
         , in(stream)
-        , out(stream)
+        , streamOut(stream)
+        , out(streamOut)
     {
     }
     virtual ~StreamRefConnection() = default;
@@ -184,13 +233,15 @@ class StreamConnection : public Connection {
 private:
     T stream;
     StreamDataIn<T> in;
-    StreamDataOut<T> out;
+    StreamDataOut<T> streamOut;
+    BufferedDataOut<connectionBufferSize> out;
 
 public:
     explicit StreamConnection(T&& _stream)
         : stream(std::move(_stream))
         , in(stream)
-        , out(stream)
+        , streamOut(stream)
+        , out(streamOut)
     {
     }
     virtual ~StreamConnection() = default;
@@ -228,6 +279,11 @@ private:
 
     CompositeDataOut<decltype(connections)> allConnectionsDataOut;
     DataOut* currentDataOut;
+    Connection* currentConnection = nullptr;
+
+    std::function<uint32_t()> clock;   // microseconds, no time budget when not set
+    uint32_t budget = 0;               // time to spend handling commands per process call
+    size_t nextConnection = 0;         // connection that is served first in the next process call
 
 public:
     ConnectionPool(std::initializer_list<std::reference_wrapper<ConnectionSource>> list)
@@ -254,10 +310,12 @@ public:
                         auto& out = (*oldest)->getDataOut();
                         const char message[] = "<!Max connections exceeded, closing oldest>";
                         out.writeBuffer(message, sizeof(message) / sizeof(message[0]));
+                        out.flush();
                         connections.erase(oldest);
                     }
                     auto& out = con->getDataOut();
                     connectionStarted(out);
+                    out.flush();
                     connections.push_back(std::move(con));
                 } else {
                     break;
@@ -271,17 +329,66 @@ public:
         return connections.size();
     }
 
+    /**
+     * Limits the time spent in process(). Commands that did not fit in the budget are handled in the next call.
+     * @param budgetMicros time to spend handling commands per process call
+     * @param micros microsecond clock
+     */
+    void timeBudget(uint32_t budgetMicros, std::function<uint32_t()>&& micros)
+    {
+        budget = budgetMicros;
+        clock = std::move(micros);
+    }
+
+    /**
+     * Calls the handler to handle one command of each connection that has input, in turns, until all input is handled.
+     * When a time budget is set, no new command is started after it is used up.
+     * The next call then starts with the connection that was not served, so a busy connection cannot starve the others.
+     * Output written to logDataOut() since the last call is flushed at the end, also for connections without input.
+     */
     void process(std::function<void(DataIn& in, DataOut& out)> handler)
     {
         tracing::add(tracing::Action::UPDATE_CONNECTIONS);
         updateConnections();
+
+        auto now = [this]() -> uint32_t { return clock ? clock() : 0; };
+        const uint32_t start = now();
+        bool pending = true;
+        bool budgetUsed = false;
+        while (pending && !budgetUsed) {
+            pending = false;
+            for (size_t served = 0; served < connections.size(); served++) {
+                nextConnection = nextConnection % connections.size();
+                auto& conn = connections[nextConnection];
+                DataIn& in = conn->getDataIn();
+                if (!in.hasNext()) {
+                    ++nextConnection;
+                    continue;
+                }
+                if (clock && uint32_t(now() - start) >= budget) {
+                    budgetUsed = true;
+                    break;
+                }
+                DataOut& out = conn->getDataOut();
+                currentDataOut = &out;
+                currentConnection = conn.get();
+                const uint32_t commandStart = now();
+                handler(in, out);
+                out.flush(); // pass on the output of the processed command and any logs in one write
+                conn->stats().commands++;
+                conn->stats().micros += now() - commandStart;
+                pending = pending || in.hasNext();
+                ++nextConnection;
+            }
+        }
         for (auto& conn : connections) {
-            DataIn& in = conn->getDataIn();
-            DataOut& out = conn->getDataOut();
-            currentDataOut = &out;
-            handler(in, out);
+            auto queued = conn->getDataIn().available();
+            conn->stats().queuedBytes = queued;
         }
         currentDataOut = &allConnectionsDataOut;
+        currentConnection = nullptr;
+        // logs and events written outside of command handling are buffered per connection, pass them on
+        allConnectionsDataOut.flush();
     }
 
     DataOut& logDataOut() const
@@ -289,6 +396,19 @@ public:
         return *currentDataOut;
     }
 
+    // the connection that is being processed, nullptr outside of process()
+    Connection* current() const
+    {
+        return currentConnection;
+    }
+
+    void forEach(const std::function<void(Connection& conn)>& func)
+    {
+        for (auto& conn : connections) {
+            func(*conn);
+        }
+    }
+
     void disconnect()
     {
         connections.clear();
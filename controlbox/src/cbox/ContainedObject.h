@@ -22,6 +22,7 @@
 #include "DataStream.h"
 #include "InactiveObject.h"
 #include "Object.h"
+#include "Profiling.h"
 #include "Tracing.h"
 #include <limits>
 #include <memory>
@@ -38,6 +39,9 @@ public:
         , _groups(std::move(groups))
         , _obj(std::move(obj))
         , _nextUpdateTime(0)
+        , _version(0)
+        , _streamHash(0)
+        , _rank(0)
     {
         if (_obj) {
             tracing::add(tracing::Action::CONSTRUCT_OBJECT, _id, _obj->typeId());
@@ -62,6 +66,12 @@ private:
     uint8_t _groups;              // active in these groups
     std::shared_ptr<Object> _obj; // pointer to runtime object
     update_t _nextUpdateTime;     // next time update should be called on _obj
+    uint32_t _version;            // change counter of the container when a change in streamed state was detected
+    uint64_t _streamHash;         // hash of the streamed state at the last check for changes, 64 bits to make collisions negligible
+    uint16_t _rank;               // number of links between this object and the first object it depends on
+#if CBOX_PROFILING
+    mutable profiling::ObjectProfile _profile; // also updated when streaming out
+#endif
 
 public:
     const obj_id_t& id() const
@@ -85,10 +95,34 @@ public:
         _obj = std::make_shared<InactiveObject>(oldType);
     }
 
-    void update(const update_t& now)
+    uint16_t rank() const
+    {
+        return _rank;
+    }
+
+    void rank(uint16_t r)
+    {
+        _rank = r;
+    }
+
+    const update_t& nextUpdateTime() const
+    {
+        return _nextUpdateTime;
+    }
+
+    /**
+     * Checks whether an update scheduled at time next is due at time now.
+     * Times more than half the range of update_t in the past are considered to be in the future, to handle overflow.
+     */
+    static bool isDue(const update_t& next, const update_t& now)
     {
         const update_t overflowGuard = std::numeric_limits<update_t>::max() / 2;
-        if (overflowGuard - now + _nextUpdateTime <= overflowGuard) {
+        return overflowGuard - now + next <= overflowGuard;
+    }
+
+    void update(const update_t& now)
+    {
+        if (isDue(_nextUpdateTime, now)) {
             forcedUpdate(now);
         }
     }
@@ -97,16 +131,83 @@ public:
     {
         if (_obj) {
             tracing::add(tracing::Action::UPDATE_OBJECT, _id, _obj->typeId());
+#if CBOX_PROFILING
+            auto start = profiling::micros();
+            _nextUpdateTime = _obj->update(now);
+            _profile.addUpdate(profiling::micros() - start);
+#else
             _nextUpdateTime = _obj->update(now);
+#endif
             return;
         }
         _nextUpdateTime += 1000;
     }
 
+    // update because a linked object has new data, see Object::pulledUpdate
+    void pulledUpdate(const uint32_t& now)
+    {
+        if (_obj) {
+            tracing::add(tracing::Action::UPDATE_OBJECT, _id, _obj->typeId());
+#if CBOX_PROFILING
+            auto start = profiling::micros();
+            _nextUpdateTime = _obj->pulledUpdate(now);
+            _profile.addUpdate(profiling::micros() - start);
+#else
+            _nextUpdateTime = _obj->pulledUpdate(now);
+#endif
+        }
+    }
+
+    bool hasNewOutput() const
+    {
+        return _obj && _obj->hasNewOutput();
+    }
+
+    const uint32_t& version() const
+    {
+        return _version;
+    }
+
+#if CBOX_PROFILING
+    const profiling::ObjectProfile& profile() const
+    {
+        return _profile;
+    }
+
+    void resetProfile()
+    {
+        _profile = profiling::ObjectProfile();
+    }
+#endif
+
+    /**
+     * Compares a hash of the streamed state of the object to the hash at the last check.
+     * If it has changed, or the object has never been checked, the version is set to newVersion and true is returned.
+     */
+    bool refreshVersion(const uint32_t& newVersion)
+    {
+        if (!_obj) {
+            return false;
+        }
+        HashingBlackholeDataOut hasher;
+        hasher.put(_groups);
+        hasher.put(_obj->typeId());
+        _obj->streamTo(hasher);
+        if (_version == 0 || hasher.hash() != _streamHash) {
+            _streamHash = hasher.hash();
+            _version = newVersion;
+            return true;
+        }
+        return false;
+    }
+
     CboxError streamTo(DataOut& out) const
     {
         if (_obj) {
             tracing::add(tracing::Action::STREAM_TO_OBJECT, _id, _obj->typeId());
+#if CBOX_PROFILING
+            profiling::ScopedTimer timer(_profile.streamToMicros);
+#endif
             if (!out.put(_id)) {
                 return CboxError::OUTPUT_STREAM_WRITE_ERROR; // LCOV_EXCL_LINE
             }
@@ -126,6 +227,9 @@ public:
         if (_obj) {
             // id is not streamed in. It is immutable and assumed to be already read to find this entry
             tracing::add(tracing::Action::STREAM_FROM_OBJECT, _id, _obj->typeId());
+#if CBOX_PROFILING
+            profiling::ScopedTimer timer(_profile.streamFromMicros);
+#endif
             uint8_t newGroups;
             obj_type_t expectedType;
             if (!in.get(newGroups)) {
@@ -155,6 +259,9 @@ public:
     {
         if (_obj) {
             tracing::add(tracing::Action::PERSIST_OBJECT, _id, _obj->typeId());
+#if CBOX_PROFILING
+            profiling::ScopedTimer timer(_profile.persistMicros);
+#endif
             // id is not streamed out. It is passed to storage separately
             // if the object is not inactive, we write the groups and typeid to eeprom
             if (_obj->typeId() != InactiveObject::staticTypeId()) {
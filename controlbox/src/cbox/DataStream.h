@@ -100,6 +100,13 @@ public:
     {
         return writeBuffer(reinterpret_cast<const uint8_t*>(data), len);
     }
+
+    /**
+	 * Passes on data that is held back in a buffer. Streams without a buffer do nothing.
+	 */
+    virtual void flush()
+    {
+    }
 };
 
 /**
@@ -171,6 +178,75 @@ public:
     }
 };
 
+/**
+ * A DataOut decorator that collects small writes and passes them on in a single writeBuffer call.
+ * The buffer is passed on when it is full and when flush() is called.
+ * Writes that are larger than the buffer are passed on directly.
+ */
+template <stream_size_t N>
+class BufferedDataOut final : public DataOut {
+private:
+    DataOut& out;
+    uint8_t buffer[N];
+    stream_size_t used = 0;
+
+    bool writePending()
+    {
+        if (used == 0) {
+            return true;
+        }
+        bool success = out.writeBuffer(buffer, used);
+        used = 0; // on failure the data is dropped, like it would have been without buffering
+        return success;
+    }
+
+public:
+    explicit BufferedDataOut(DataOut& _out)
+        : out(_out)
+    {
+    }
+
+    BufferedDataOut(const BufferedDataOut&) = delete;
+    BufferedDataOut& operator=(const BufferedDataOut&) = delete;
+
+    using DataOut::writeBuffer;
+
+    virtual bool write(uint8_t data) override final
+    {
+        if (used == N && !writePending()) {
+            return false;
+        }
+        buffer[used++] = data;
+        return true;
+    }
+
+    virtual bool writeBuffer(const uint8_t* data, stream_size_t len) override final
+    {
+        if (len > N - used) {
+            if (!writePending()) {
+                return false;
+            }
+            if (len >= N) {
+                return out.writeBuffer(data, len);
+            }
+        }
+        std::copy(data, data + len, buffer + used);
+        used += len;
+        return true;
+    }
+
+    virtual void flush() override final
+    {
+        writePending();
+        out.flush();
+    }
+
+    stream_size_t pending() const
+    {
+        return used;
+    }
+};
+
 /**
  * A DataOut implementation that discards all data.
  */
@@ -206,6 +282,32 @@ public:
     }
 };
 
+/**
+ * A DataOut implementation that discards all data, but keeps a 64-bit FNV-1a hash of it.
+ * Used to detect a change in streamed data without keeping a copy.
+ */
+class HashingBlackholeDataOut final : public DataOut {
+private:
+    uint64_t hashValue;
+
+public:
+    HashingBlackholeDataOut()
+        : hashValue(14695981039346656037u)
+    {
+    }
+    virtual ~HashingBlackholeDataOut() = default;
+    virtual bool write(uint8_t data) override final
+    {
+        hashValue = (hashValue ^ data) * 1099511628211u;
+        return true;
+    }
+
+    uint64_t hash() const
+    {
+        return hashValue;
+    }
+};
+
 enum class StreamType : uint8_t {
     Mock = 0,
     Usb = 1,
@@ -213,6 +315,29 @@ enum class StreamType : uint8_t {
     Eeprom = 3,
 };
 
+/**
+ * Framing of the data bytes in a message.
+ * Hex framing sends each data byte as 2 hex characters.
+ * Binary framing sends data bytes as is and only escapes bytes that have a special meaning in the protocol.
+ * Separators and annotations are the same for both, so a client can parse both with the same code.
+ */
+enum class Framing : uint8_t {
+    Hex = 0,
+    Binary = 1,
+};
+
+namespace binary_framing {
+    const uint8_t start = 0xFE;      // first byte of a message with binary framing, repeated as first byte of the reply
+    const uint8_t escape = 0xFD;     // the next byte is a data byte XOR escapeMask
+    const uint8_t escapeMask = 0x20; // escaped bytes are never special characters themselves
+
+    inline bool needsEscape(uint8_t data)
+    {
+        return data == '\n' || data == '\r' || data == '|' || data == ',' || data == '<' || data == '>'
+               || data == escape || data == start;
+    }
+}
+
 /**
  * A data input stream. The stream contents may be determined asynchronously.
  * hasNext() returns true if the stream may eventually produce a new item, false if the stream is closed.
@@ -563,10 +688,12 @@ class EncodedDataOut final : public DataOut {
 private:
     uint8_t crcValue = 0;
     DataOut& out;
+    Framing framing;
 
 public:
-    EncodedDataOut(DataOut& _out)
+    EncodedDataOut(DataOut& _out, Framing _framing = Framing::Hex)
         : out(_out)
+        , framing(_framing)
     {
     }
 
@@ -581,19 +708,65 @@ public:
     {
         write(crcValue);
         out.write(',');
+        out.flush(); // pass on each list item, so long lists are not held back in the buffer
     }
 
     /**
-	 * Data is written as hex-encoded
+	 * Data is written as hex-encoded, or escaped for binary framing
 	 */
     virtual bool write(uint8_t data) override final
     {
         crcValue = *(dscrc_table + (crcValue ^ data));
+        if (framing == Framing::Binary) {
+            if (binary_framing::needsEscape(data)) {
+                return out.write(binary_framing::escape) && out.write(data ^ binary_framing::escapeMask);
+            }
+            return out.write(data);
+        }
         bool success = out.write(d2h(uint8_t(data & 0xF0) >> 4));
         success = success && out.write(d2h(uint8_t(data & 0xF)));
         return success;
     }
 
+    using DataOut::writeBuffer;
+
+    /**
+	 * Same result as writing each byte, but the output is passed on in blocks instead of per character.
+	 * With binary framing, the bytes that do not need escaping are passed on without copying them.
+	 */
+    virtual bool writeBuffer(const uint8_t* data, stream_size_t len) override final
+    {
+        const uint8_t* end = data + len;
+        bool success = true;
+        if (framing == Framing::Binary) {
+            const uint8_t* unescaped = data;
+            for (const uint8_t* d = data; d < end; d++) {
+                crcValue = *(dscrc_table + (crcValue ^ *d));
+                if (binary_framing::needsEscape(*d)) {
+                    success = success
+                              && (d == unescaped || out.writeBuffer(unescaped, stream_size_t(d - unescaped)))
+                              && out.write(binary_framing::escape)
+                              && out.write(*d ^ binary_framing::escapeMask);
+                    unescaped = d + 1;
+                }
+            }
+            return success && (end == unescaped || out.writeBuffer(unescaped, stream_size_t(end - unescaped)));
+        }
+
+        uint8_t hex[64];
+        stream_size_t used = 0;
+        for (const uint8_t* d = data; d < end; d++) {
+            crcValue = *(dscrc_table + (crcValue ^ *d));
+            hex[used++] = d2h(uint8_t(*d & 0xF0) >> 4);
+            hex[used++] = d2h(uint8_t(*d & 0xF));
+            if (used == sizeof(hex)) {
+                success = success && out.writeBuffer(hex, used);
+                used = 0;
+            }
+        }
+        return success && (used == 0 || out.writeBuffer(hex, used));
+    }
+
     uint8_t crc()
     {
         return crcValue;
@@ -604,6 +777,11 @@ public:
         crcValue += 1;
     }
 
+    Framing getFraming() const
+    {
+        return framing;
+    }
+
     /**
 	 * Rather than closing the global stream, write a newline to signify the end of this command.
 	 */
@@ -612,6 +790,7 @@ public:
         write(crcValue);
         crcValue = 0;
         out.write('\n');
+        out.flush();
     }
 
     void writeAnnotation(std::string&& ann)
@@ -95,6 +95,24 @@ HexTextToBinaryIn::fetchNextByte()
     }
 }
 
+/**
+ * Fetches the next data byte from the stream, removing the escape byte if present.
+ */
+void
+EscapedBinaryIn::fetchNextByte()
+{
+    if (hasData || !rawIn.hasNext()) {
+        return;
+    }
+
+    uint8_t d = blockingRead(rawIn, 0);
+    if (d == binary_framing::escape) {
+        d = blockingRead(rawIn, 0) ^ binary_framing::escapeMask;
+    }
+    data = d;
+    hasData = true;
+}
+
 /*
  * calculates 2 CRC characters to a hex string, used for testing
  */
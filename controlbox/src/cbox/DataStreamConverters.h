@@ -153,6 +153,67 @@ public:
     }
 };
 
+/*
+ * Removes the escaping of binary framing. The stream closes on a newline, like HexTextToBinaryIn.
+ */
+class EscapedBinaryIn : public DataIn {
+    DataIn& rawIn;
+    uint8_t data;
+    bool hasData;
+
+    void fetchNextByte();
+
+    bool peekEndline()
+    {
+        auto inByte = rawIn.peek();
+        return (inByte == '\r' || inByte == '\n');
+    }
+
+public:
+    EscapedBinaryIn(DataIn& _rawIn)
+        : rawIn(_rawIn)
+        , data(0)
+        , hasData(false)
+    {
+    }
+
+    bool hasNext() override
+    {
+        return hasData || (rawIn.hasNext() && !peekEndline());
+    }
+
+    uint8_t peek() override
+    {
+        fetchNextByte();
+        return data;
+    }
+
+    uint8_t next() override
+    {
+        fetchNextByte();
+        hasData = false;
+        return data;
+    }
+
+    stream_size_t available() override
+    {
+        fetchNextByte();
+        return hasData ? 1 : 0;
+    }
+
+    void unBlock()
+    {
+        while (peekEndline()) {
+            rawIn.next();
+        }
+    }
+
+    virtual StreamType streamType() const override final
+    {
+        return rawIn.streamType();
+    }
+};
+
 // helper function for testing. Appends the CRC to a hex string, the same way CrcDataOut would do
 std::string
 addCrc(const std::string& in);
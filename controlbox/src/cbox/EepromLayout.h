@@ -1,3 +1,6 @@
+#pragma once
+
+#include <cstddef>
 #include <cstdint>
 
 const uint16_t eepromStart = 0;
@@ -25,6 +25,8 @@
 #include "EepromAccess.h"
 #include "EepromLayout.h"
 #include "ObjectStorage.h"
+#include <algorithm>
+#include <vector>
 
 namespace cbox {
 
@@ -131,7 +133,8 @@ public:
                 defrag();
                 objectEepromData = newObjectWriter(id, requestedSize);
                 dataLocation = writer.offset();
-                if (objectEepromData.availableForWrite() < requestedSize) {
+                eepromBlockSize = objectEepromData.availableForWrite();
+                if (eepromBlockSize < requestedSize) {
                     // LCOV_EXCL_LINE still not enough free space, exclude from coverage, because this should not be possible with the check above
                     return CboxError::INSUFFICIENT_PERSISTENT_STORAGE; // LCOV_EXCL_LINE
                 }
@@ -146,9 +149,11 @@ public:
         // check how many bytes were written
         uint16_t actualSize = writer.offset() - dataLocation;
         // write the actual object size as first 2 bytes in the block
-        writer.reset(dataLocation - (objectHeaderLength() - blockHeaderLength()), 2 * sizeof(uint16_t));
+        uint16_t blockStart = dataLocation - objectHeaderLength();
+        writer.reset(blockStart + blockHeaderLength(), 2 * sizeof(uint16_t));
         writer.put(actualSize);
         writer.put(id); // overwrite invalid id with actual id
+        updateLocation(blockStart, id, actualSize);
         return res;
     }
 
@@ -164,10 +169,12 @@ public:
         const storage_id_t& id,
         const std::function<CboxError(RegionDataIn&)>& handler) override final
     {
-        RegionDataIn objectEepromData = getObjectReader(id, true);
-        if (objectEepromData.available() == 0) {
+        auto location = findLocation(id);
+        if (location == objectLocations.end() || location->actualSize == 0) {
             return cbox::CboxError::PERSISTED_OBJECT_NOT_FOUND;
         }
+        reader.reset(location->start + objectHeaderLength(), location->actualSize);
+        RegionDataIn objectEepromData(reader, location->actualSize);
         return handler(objectEepromData);
     }
     /**
@@ -237,13 +244,13 @@ public:
     virtual bool
     disposeObject(const storage_id_t& id, bool mergeDisposed = true) override final
     {
-        RegionDataIn block = getObjectReader(id, true); // sets reader to data start of block data
+        auto location = findLocation(id);
         bool found = false;
-        if (block.available() > 0) {
+        if (location != objectLocations.end() && location->actualSize > 0) {
             // overwrite block type with disposed block
-            uint16_t dataStart = reader.offset();
-            uint16_t blockTypeOffset = dataStart - objectHeaderLength();
-            eeprom.writeByte(blockTypeOffset, static_cast<uint8_t>(BlockType::disposed_block));
+            eeprom.writeByte(location->start, static_cast<uint8_t>(BlockType::disposed_block));
+            insertFreeBlock(FreeBlock{location->start, location->blockSize});
+            objectLocations.erase(location);
             found = true;
         }
         if (mergeDisposed) {
@@ -260,31 +267,23 @@ public:
     }
 
     stream_size_t
-    freeSpace()
+    freeSpace() const
     {
         stream_size_t total = 0;
-        resetReader();
-        while (reader.available()) {
-            RegionDataIn blockData = getBlockReader(BlockType::disposed_block);
-            auto blockSize = blockData.available();
-            total += blockSize;
+        for (auto& block : freeBlocks) {
+            total += block.blockSize;
             total += blockHeaderLength();
-            reader.skip(blockSize);
         }
         // subtract one header length, because that will not be available for the object
         return total - blockHeaderLength();
     }
 
     stream_size_t
-    continuousFreeSpace()
+    continuousFreeSpace() const
     {
         stream_size_t space = 0;
-        resetReader();
-        while (reader.available()) {
-            RegionDataIn blockData = getBlockReader(BlockType::disposed_block);
-            auto blockSize = blockData.available();
-            space = std::max(space, blockSize);
-            reader.skip(blockSize);
+        for (auto& block : freeBlocks) {
+            space = std::max(space, block.blockSize);
         }
         return space;
     }
@@ -312,6 +311,25 @@ private:
     EepromDataIn reader;
     EepromDataOut writer;
 
+    /**
+     * In RAM index of the blocks in EEPROM, built once in init() and kept up to date on every change.
+     * This prevents having to walk the blocks in EEPROM to find an object or a free block.
+     */
+    struct ObjectLocation {
+        storage_id_t id;
+        uint16_t start;      // offset of the block header
+        uint16_t blockSize;  // size of the block, excluding the block header
+        uint16_t actualSize; // size of the data written to the block, excluding the object header
+    };
+
+    struct FreeBlock {
+        uint16_t start;     // offset of the block header
+        uint16_t blockSize; // size of the block, excluding the block header
+    };
+
+    std::vector<ObjectLocation> objectLocations; // sorted by id, then by start
+    std::vector<FreeBlock> freeBlocks;           // sorted by start
+
     inline uint8_t
     magicByte() const
     {
@@ -352,77 +370,63 @@ private:
         return blockHeaderLength() + sizeof(uint16_t) + sizeof(storage_id_t);
     }
 
-    // This function assumes that the reader is at the start of a block.
-    // To ensure this, after using the RegionDataIn object, skip to the end of the block.
-    RegionDataIn
-    getBlockReader(const BlockType requestedType)
+    static bool
+    locationLess(const ObjectLocation& a, const ObjectLocation& b)
     {
-        while (reader.hasNext()) {
-            uint8_t type = reader.next();
-            uint16_t blockSize = 0;
-            if (!reader.get(blockSize)) {
-                break; // couldn't read blocksize, due to reaching end of reader
-            }
-            if (!(type == requestedType)) {
-                reader.skip(blockSize);
-                continue;
-            }
-            return RegionDataIn(reader, blockSize);
-        }
-        return RegionDataIn(reader, 0);
+        return a.id < b.id || (a.id == b.id && a.start < b.start);
     }
 
-    // This function assumes that the reader is at the start of a block.
-    RegionDataOut
-    getBlockWriter(const BlockType requestedType, uint16_t minSize)
+    // returns the location of the first block with the requested id, or end if not found
+    std::vector<ObjectLocation>::iterator
+    findLocation(const storage_id_t& id)
     {
-        // this sets the eeprom to the object location, with the full block size available
-        RegionDataIn objectData = getBlockReader(requestedType);
-        if (objectData.available() >= minSize) {
-            // block found. now wrap the eeprom location with a writer instead of a reader
-            writer.reset(reader.offset(), reader.available());
-            return RegionDataOut(writer, objectData.available());
+        auto it = std::lower_bound(objectLocations.begin(), objectLocations.end(), id,
+                                   [](const ObjectLocation& l, const storage_id_t& i) { return l.id < i; });
+        if (it != objectLocations.end() && it->id == id) {
+            return it;
         }
-        return RegionDataOut(writer, 0); // length 0 writer
+        return objectLocations.end();
     }
 
-    // Search for the block matching the requested id
-    // If found, return an EEPROM data stream limited to the block.
-    // If usedSize is true, only the length that was written previously is made available, not the reserved size
-    // This function assumes that the reader is at the start of a block.
-    // To ensure this, after using the RegionDataIn object, skip to the end of the block.
-    RegionDataIn
-    getObjectReader(const storage_id_t id, bool usedSize)
+    void
+    insertLocation(const ObjectLocation& location)
     {
-        resetReader();
-        while (reader.hasNext()) {
-            RegionDataIn block = getBlockReader(BlockType::object);
-            uint16_t objectSize = 0;
-            storage_id_t blockId = 0;
-            block.get(objectSize);
-            block.get(blockId);
-            if (blockId != id) {
-                reader.skip(block.available());
-                continue;
-            }
-            if (usedSize) {
-                block.reduceLength(objectSize);
-            }
+        auto pos = std::lower_bound(objectLocations.begin(), objectLocations.end(), location, locationLess);
+        objectLocations.insert(pos, location);
+    }
 
-            return block;
+    // update id and actual size of the object block at start, after it has been (re)written
+    void
+    updateLocation(uint16_t start, const storage_id_t& id, uint16_t actualSize)
+    {
+        auto it = std::find_if(objectLocations.begin(), objectLocations.end(),
+                               [&start](const ObjectLocation& l) { return l.start == start; });
+        if (it != objectLocations.end()) {
+            auto location = *it;
+            objectLocations.erase(it);
+            location.id = id;
+            location.actualSize = std::min(actualSize, uint16_t(location.blockSize - (objectHeaderLength() - blockHeaderLength())));
+            insertLocation(location);
         }
-        return RegionDataIn(reader, 0);
+    }
+
+    void
+    insertFreeBlock(const FreeBlock& block)
+    {
+        auto pos = std::lower_bound(freeBlocks.begin(), freeBlocks.end(), block,
+                                    [](const FreeBlock& a, const FreeBlock& b) { return a.start < b.start; });
+        freeBlocks.insert(pos, block);
     }
 
     RegionDataOut
     getObjectWriter(const storage_id_t id)
     {
         // this sets the eeprom to the object location and requestes the full available object size for writing
-        RegionDataIn objectData = getObjectReader(id, false);
-        if (objectData.available() > 0) {
-            // block found. now wrap the eeprom location with a writer instead of a reader
-            writer.reset(reader.offset(), reader.available());
-            return RegionDataOut(writer, objectData.available());
+        auto location = findLocation(id);
+        if (location != objectLocations.end()) {
+            uint16_t available = location->blockSize - (objectHeaderLength() - blockHeaderLength());
+            writer.reset(location->start + objectHeaderLength(), available);
+            return RegionDataOut(writer, available);
         }
         return RegionDataOut(writer, 0); // length 0 writer
     }
@@ -431,39 +435,40 @@ private:
     RegionDataOut
     newObjectWriter(const storage_id_t id, uint16_t objectSize)
     {
-        // find a disposed block with enough size available
-        resetReader();
+        // find the first disposed block with enough size available
         uint16_t neededSizeInclBlockHeader = objectSize + objectHeaderLength();
         uint16_t neededSizeExclBlockHeader = neededSizeInclBlockHeader - blockHeaderLength();
-        while (reader.available() >= neededSizeInclBlockHeader) {
-            RegionDataIn blockData = getBlockReader(BlockType::disposed_block);
-            uint16_t blockSize = uint16_t(blockData.available()); // this excludes the block header
+        for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+            uint16_t blockSize = it->blockSize; // this excludes the block header
             if (blockSize < neededSizeExclBlockHeader) {
-                reader.skip(blockSize);
                 continue;
             }
-            // Large enough block found. now wrap the eeprom location with a writer instead of a reader
+            uint16_t blockStart = it->start;
+            // Large enough block found. now wrap the eeprom location with a writer
             if (blockSize < neededSizeExclBlockHeader + 8) {
                 // don't create new disposed blocks smaller than 8 bytes, add space to this object instead
-                writer.reset(reader.offset() - blockHeaderLength(), blockSize + blockHeaderLength());
+                writer.reset(blockStart, blockSize + blockHeaderLength());
                 writer.put(BlockType::object);
                 writer.put(blockSize);
                 uint16_t availableObjectSize = blockSize - (objectHeaderLength() - blockHeaderLength());
                 writer.put(availableObjectSize);
                 writer.put(uint16_t(id));
+                freeBlocks.erase(it);
+                insertLocation(ObjectLocation{id, blockStart, blockSize, availableObjectSize});
                 return RegionDataOut(writer, availableObjectSize);
             } else {
                 // split into object block and new disposed block
-                uint16_t blockToSplitHeaderStart = reader.offset() - blockHeaderLength();
                 uint16_t newDisposedBlockSize = blockSize - neededSizeInclBlockHeader;
-                uint16_t newDisposedBlockStart = blockToSplitHeaderStart + neededSizeInclBlockHeader;
+                uint16_t newDisposedBlockStart = blockStart + neededSizeInclBlockHeader;
 
                 // first disposed block (at the end)
                 writer.reset(newDisposedBlockStart, blockHeaderLength());
                 writer.put(BlockType::disposed_block);
                 writer.put(newDisposedBlockSize);
+                it->start = newDisposedBlockStart;
+                it->blockSize = newDisposedBlockSize;
                 // then object block
-                writer.reset(blockToSplitHeaderStart, neededSizeInclBlockHeader);
+                writer.reset(blockStart, neededSizeInclBlockHeader);
                 writer.put(BlockType::object);
                 uint16_t newBlockSize = neededSizeExclBlockHeader;
                 uint16_t availableObjectSize = newBlockSize - (objectHeaderLength() - blockHeaderLength());
@@ -472,6 +477,7 @@ private:
                 // storeObject can adjust rewrite this if it doesn't use the full block
                 writer.put(availableObjectSize);
                 writer.put(uint16_t(id));
+                insertLocation(ObjectLocation{id, blockStart, newBlockSize, availableObjectSize});
                 return RegionDataOut(writer, availableObjectSize);
             }
         }
@@ -492,28 +498,60 @@ private:
             writer.put(BlockType::disposed_block);
             writer.put(uint16_t(EepromLocationSize(objects) - blockHeaderLength()));
         }
+        buildIndex();
     }
 
-    // move a single disposed block backwards by swapping it with an object
-    bool
-    moveDisposedBackwards()
+    // walk all blocks in EEPROM once to build the in RAM index
+    void
+    buildIndex()
     {
+        objectLocations.clear();
+        freeBlocks.clear();
         resetReader();
-        RegionDataIn disposedBlock = getBlockReader(BlockType::disposed_block);
+        while (reader.hasNext()) {
+            uint16_t blockStart = reader.offset();
+            uint8_t type = reader.next();
+            uint16_t blockSize = 0;
+            if (!reader.get(blockSize) || reader.available() < blockSize) {
+                break; // couldn't read block, due to reaching end of reader
+            }
+            if (type == BlockType::object) {
+                uint16_t actualSize = 0;
+                storage_id_t id = 0;
+                RegionDataIn block(reader, blockSize);
+                if (block.get(actualSize) && block.get(id)) {
+                    actualSize = std::min(actualSize, block.available());
+                    objectLocations.push_back(ObjectLocation{id, blockStart, blockSize, actualSize});
+                }
+                reader.skip(block.available());
+                continue;
+            }
+            if (type == BlockType::disposed_block) {
+                freeBlocks.push_back(FreeBlock{blockStart, blockSize});
+            }
+            reader.skip(blockSize);
+        }
+        std::sort(objectLocations.begin(), objectLocations.end(), locationLess);
+    }
 
-        uint16_t disposedStart = reader.offset();
-        uint16_t disposedLength = disposedBlock.available();
-        if (disposedLength == 0) {
+    // move a single disposed block backwards by swapping it with the object after it
+    bool
+    moveDisposedBackwards()
+    {
+        if (freeBlocks.empty() || freeBlocks.front().blockSize == 0) {
             return false;
         }
-        reader.skip(disposedLength);
-
-        RegionDataIn objectBlock = getBlockReader(BlockType::object);
-        uint16_t objectLength = objectBlock.available();
-
-        if (objectLength == 0) {
+        auto& disposed = freeBlocks.front();
+        uint16_t disposedStart = disposed.start + blockHeaderLength();
+        uint16_t disposedLength = disposed.blockSize;
+        uint16_t objectBlockStart = disposedStart + disposedLength;
+
+        auto object = std::find_if(objectLocations.begin(), objectLocations.end(),
+                                   [&objectBlockStart](const ObjectLocation& l) { return l.start == objectBlockStart; });
+        if (object == objectLocations.end()) {
             return false;
         }
+        uint16_t objectLength = object->blockSize;
 
         // write object at location of disposed block and mark the remainder as disposed.
         // essentially, they swap places
@@ -524,6 +562,7 @@ private:
         writer.put(uint16_t(disposedLength + objectLength + blockHeaderLength()));
 
         // Then we copy the data to the front of the block
+        reader.reset(objectBlockStart + blockHeaderLength(), objectLength);
         reader.push(writer, objectLength);
 
         // Then we mark the remainder as disposed
@@ -535,36 +574,33 @@ private:
         writer.put(BlockType::object);
         writer.put(objectLength);
 
+        auto moved = *object;
+        objectLocations.erase(object);
+        moved.start = disposed.start;
+        insertLocation(moved);
+        disposed.start = disposed.start + objectLength + blockHeaderLength();
+
         return true;
     }
 
     bool
     mergeDisposedBlocks()
     {
-        resetReader();
         bool didMerge = false;
-        while (reader.hasNext()) {
-            RegionDataIn disposedBlock1 = getBlockReader(BlockType::disposed_block);
-
-            uint16_t disposedDataStart1 = reader.offset();
-            uint16_t disposedDataLength1 = disposedBlock1.available();
-
-            reader.skip(disposedDataLength1);
-            if (!reader.hasNext()) {
-                return false; // end of EEPROM, no next block
-            }
-
-            uint8_t nextBlockType = reader.peek();
-            if (nextBlockType == BlockType::disposed_block) {
-                RegionDataIn disposedBlock2 = getBlockReader(BlockType::disposed_block);
-                uint16_t disposedLength2 = disposedBlock2.available();
-                // now merge the blocks
-                uint16_t combinedLength = disposedDataLength1 + disposedLength2 + blockHeaderLength();
-                writer.reset(disposedDataStart1 - blockHeaderLength() + sizeof(BlockType), sizeof(uint16_t));
-                writer.put(combinedLength);
-                didMerge = true;
-                reader.skip(disposedLength2);
+        auto it = freeBlocks.begin();
+        while (it != freeBlocks.end() && it + 1 != freeBlocks.end()) {
+            auto next = it + 1;
+            if (it->start + blockHeaderLength() + it->blockSize != next->start) {
+                ++it;
+                continue;
             }
+            // blocks are adjacent, merge them
+            uint16_t combinedLength = it->blockSize + next->blockSize + blockHeaderLength();
+            writer.reset(it->start + sizeof(BlockType), sizeof(uint16_t));
+            writer.put(combinedLength);
+            it->blockSize = combinedLength;
+            freeBlocks.erase(next);
+            didMerge = true;
         }
         return didMerge;
     }
@@ -0,0 +1,556 @@
+/*
+ * Copyright 2020 Elco Jacobs / BrewBlox.
+ *
+ * This file is part of BrewBlox.
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "CboxError.h"
+#include "DataStream.h"
+#include "DataStreamEeprom.h"
+#include "EepromAccess.h"
+#include "EepromLayout.h"
+#include "ObjectStorage.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace cbox {
+
+enum class LogRecordType : uint8_t {
+    end, // ensures cleared eeprom reads as the end of a page
+    object,
+    disposed,
+};
+
+/**
+ * Object storage that appends each new version of an object to a log, instead of overwriting it in place.
+ *
+ * The objects area of EEPROM is divided in pages. Each page starts with a sequence number, followed by records.
+ * A record is a type byte, the object id, the data size and the object data followed by a CRC.
+ * New records are only appended to the newest page, so writes are spread evenly over all pages.
+ * When no more pages are free, the live records of the oldest page are copied to the newest page and the oldest page is freed.
+ * One page is kept in reserve, so there is always room to copy the live records of the oldest page.
+ *
+ * Writes are ordered so that losing power leaves a valid log:
+ * a record is written with the type byte last, a page is opened by writing its sequence number last
+ * and a page is only freed after its live records are copied. On init(), the log is replayed in sequence order
+ * to rebuild the in RAM index, where later records of an id supersede earlier ones.
+ *
+ * The storage has a different header than EepromObjectStorage, so switching between them formats EEPROM.
+ *
+ * Limits of the layout, with the 2016 bytes of the objects area split in 8 pages of 252 bytes:
+ * - a record must fit in one page after its 4 byte sequence number, which limits the object data (including CRC)
+ *   to 248 - 5 = 243 bytes. EepromObjectStorage can store a single object of up to about 2000 bytes.
+ * - the reserve page is never used for live data, which leaves 7 x 248 = 1736 bytes for records,
+ *   each with 5 bytes of overhead. EepromObjectStorage can use about 2013 bytes, with 7 bytes of overhead per object.
+ * So this storage only replaces EepromObjectStorage when all objects are smaller than 243 bytes
+ * and they fit in about 1.7 KB in total.
+ */
+class LogObjectStorage : public ObjectStorage {
+public:
+    static const uint8_t pageCount = 8;
+    static const uint16_t pageSize = EepromLocationSize(objects) / pageCount;
+
+    LogObjectStorage(EepromAccess& _eeprom)
+        : eeprom(_eeprom)
+        , reader(_eeprom)
+        , writer(_eeprom)
+    {
+        init();
+    }
+    virtual ~LogObjectStorage() = default;
+
+    /**
+     * storeObject appends the data streamed by the handler to the log, superseding the previous version.
+     * The handler is called twice, the first time to determine the size, so it should stream the same data twice.
+     * @param id: id to store the object with
+     * @param handler: a callable that is provided with a DataOut to stream the new data to
+     * @return CboxError
+     */
+    virtual CboxError storeObject(
+        const storage_id_t& id,
+        const std::function<CboxError(DataOut&)>& handler) override final
+    {
+        if (!id) {
+            return CboxError::INVALID_OBJECT_ID;
+        }
+
+        // write to counter to get size and to do a test serialization
+        CountingBlackholeDataOut counter;
+        CboxError res = handler(counter);
+        uint16_t dataSize = counter.count() + 1;
+
+        if (res == CboxError::PERSISTING_NOT_NEEDED) {
+            // exit for objects that don't need to exist in EEPROM. Not even their id/groups/existence
+            return CboxError::OK;
+        }
+
+        if (res != CboxError::OK) {
+            return res;
+        };
+
+        uint16_t recordLength = recordHeaderLength() + dataSize;
+        if (recordLength > pageSize - pageHeaderLength()) {
+            return CboxError::INSUFFICIENT_PERSISTENT_STORAGE;
+        }
+        auto existing = findEntry(id);
+        uint16_t existingLength = (existing != index.end()) ? recordHeaderLength() + existing->dataSize : 0;
+        if (liveBytes() - existingLength + recordLength > capacity()) {
+            return CboxError::INSUFFICIENT_PERSISTENT_STORAGE; // not even enough space after reclaiming all pages
+        }
+        if (!makeRoom(recordLength)) {
+            return CboxError::INSUFFICIENT_PERSISTENT_STORAGE;
+        }
+
+        uint16_t recordStart = tail;
+        writer.reset(recordStart + recordHeaderLength(), dataSize);
+
+        // we want the ID to be part of the CRC
+        // we stream it again to a discarded stream and start the actual stream with the resulting CRC
+        BlackholeDataOut hole;
+        CrcDataOut idCrc(hole);
+        idCrc.put(id);
+
+        CrcDataOut crcOut(writer, idCrc.crc());
+        res = handler(crcOut);
+        if (res != CboxError::OK) {
+            // the record is not committed, the previous version remains valid
+            return res;
+        }
+        if (writer.offset() != recordStart + dataSize + recordHeaderLength() - 1 || !crcOut.writeCrc()) {
+            // handler did not stream the same data twice
+            return CboxError::PERSISTED_STORAGE_WRITE_ERROR;
+        }
+
+        commitRecord(recordStart, LogRecordType::object, id, dataSize);
+        return CboxError::OK;
+    }
+
+    /**
+     * Retrieve a single object from storage
+     * @param id: id of object to retrieve
+     * @param handler: a callable with the following prototype: (DataIn &) -> CboxError.
+     * DataIn will contain the object's data followed by a CRC.
+     * @return CboxError
+     */
+    virtual CboxError
+    retrieveObject(
+        const storage_id_t& id,
+        const std::function<CboxError(RegionDataIn&)>& handler) override final
+    {
+        auto entry = findEntry(id);
+        if (entry == index.end()) {
+            return cbox::CboxError::PERSISTED_OBJECT_NOT_FOUND;
+        }
+        reader.reset(entry->start + recordHeaderLength(), entry->dataSize);
+        RegionDataIn objectEepromData(reader, entry->dataSize);
+        return handler(objectEepromData);
+    }
+
+    /**
+     * Retreive all objects from storage, in order of id
+     * @param handler: a callable with the following prototype: (const storage_id_t&, DataOut &) -> CboxError.
+     * The handler will be called for each object and the object, with the DataIn stream containing the object's data.
+     * @return
+     */
+    virtual CboxError
+    retrieveObjects(
+        const std::function<CboxError(const storage_id_t& id, RegionDataIn&)>& handler) override final
+    {
+        // iterate a copy, the handler is allowed to store objects
+        auto entries = index;
+        for (auto& entry : entries) {
+            reader.reset(entry.start + recordHeaderLength(), entry.dataSize);
+            RegionDataIn objectEepromData(reader, entry.dataSize);
+            handler(entry.id, objectEepromData); // errors are handled per object, continue with the next object
+        }
+        return CboxError::OK;
+    }
+
+    /**
+     * Marks the latest record of the object as disposed, which also disposes older records when the log is replayed.
+     * This only writes a single byte and doesn't need free space.
+     * @param mergeDisposed: unused, space of disposed objects is reclaimed when their page is compacted
+     */
+    virtual bool
+    disposeObject(const storage_id_t& id, bool = true) override final
+    {
+        auto entry = findEntry(id);
+        if (entry == index.end()) {
+            return false;
+        }
+        eeprom.writeByte(entry->start, static_cast<uint8_t>(LogRecordType::disposed));
+        pages[pageOf(entry->start)].liveBytes -= recordHeaderLength() + entry->dataSize;
+        index.erase(entry);
+        return true;
+    }
+
+    virtual void
+    clear() override final
+    {
+        format();
+    }
+
+    /**
+     * Reclaims the oldest page when free pages run low and its live records fit in the current page.
+     * This does at most one page of copying and prevents having to compact when an object is stored.
+     */
+    virtual void
+    compact() override final
+    {
+        if (freePageCount() >= backgroundThreshold()) {
+            return;
+        }
+        uint8_t oldest = oldestPage();
+        if (oldest < pageCount && pages[oldest].liveBytes <= pageEnd(activePage) - tail) {
+            reclaimPage(oldest);
+        }
+    }
+
+    /**
+     * @return total space for object records, excluding the reserve page
+     */
+    static stream_size_t
+    capacity()
+    {
+        return (pageCount - 1) * (pageSize - pageHeaderLength());
+    }
+
+    /**
+     * @return total size of the latest records of all objects
+     */
+    stream_size_t
+    liveBytes() const
+    {
+        stream_size_t total = 0;
+        for (auto& page : pages) {
+            total += page.liveBytes;
+        }
+        return total;
+    }
+
+    uint8_t
+    freePageCount() const
+    {
+        return std::count_if(pages.begin(), pages.end(), [](const Page& p) { return p.sequence == 0; });
+    }
+
+private:
+    /**
+     * The application supplied EEPROM storage class
+     */
+    EepromAccess& eeprom;
+
+    /**
+     * Stream wrappers for reading, writing and limiting region
+     */
+    EepromDataIn reader;
+    EepromDataOut writer;
+
+    struct Page {
+        uint32_t sequence;  // 0 for a free page, otherwise increasing in order of opening
+        uint16_t liveBytes; // size of the records in this page that are still in the index
+    };
+
+    /**
+     * In RAM index of the latest record of each object, rebuilt in init() by replaying the log.
+     */
+    struct IndexEntry {
+        storage_id_t id;
+        uint16_t start;    // offset of the record header
+        uint16_t dataSize; // size of the object data, including CRC
+    };
+
+    std::array<Page, pageCount> pages;
+    std::vector<IndexEntry> index; // sorted by id
+    uint8_t activePage = 0;
+    uint16_t tail = 0; // offset of the end of the newest record in the active page
+    uint32_t nextSequence = 1;
+    bool compacting = false;
+
+    inline uint8_t
+    magicByte() const
+    {
+        return 0x69;
+    }
+    inline uint8_t
+    storageVersion() const
+    {
+        return 0x81;
+    }
+    inline uint16_t
+    referenceHeader() const
+    {
+        return magicByte() << 8 | storageVersion();
+    }
+
+    static uint16_t
+    pageHeaderLength()
+    {
+        return sizeof(uint32_t);
+    }
+
+    static uint16_t
+    recordHeaderLength()
+    {
+        // type + id + data size
+        return sizeof(LogRecordType) + sizeof(storage_id_t) + sizeof(uint16_t);
+    }
+
+    static uint8_t
+    backgroundThreshold()
+    {
+        return 3;
+    }
+
+    static uint16_t
+    pageStart(uint8_t page)
+    {
+        return EepromLocation(objects) + page * pageSize;
+    }
+
+    static uint16_t
+    pageEnd(uint8_t page)
+    {
+        return pageStart(page) + pageSize;
+    }
+
+    static uint8_t
+    pageOf(uint16_t offset)
+    {
+        return (offset - EepromLocation(objects)) / pageSize;
+    }
+
+    std::vector<IndexEntry>::iterator
+    findEntry(const storage_id_t& id)
+    {
+        auto it = std::lower_bound(index.begin(), index.end(), id, [](const IndexEntry& e, const storage_id_t& i) {
+            return e.id < i;
+        });
+        if (it != index.end() && it->id == id) {
+            return it;
+        }
+        return index.end();
+    }
+
+    // point the index at a new record of an object and update the live bytes of the pages involved
+    void
+    indexRecord(const storage_id_t& id, uint16_t start, uint16_t dataSize)
+    {
+        auto it = std::lower_bound(index.begin(), index.end(), id, [](const IndexEntry& e, const storage_id_t& i) {
+            return e.id < i;
+        });
+        if (it != index.end() && it->id == id) {
+            pages[pageOf(it->start)].liveBytes -= recordHeaderLength() + it->dataSize;
+            *it = IndexEntry{id, start, dataSize};
+        } else {
+            index.insert(it, IndexEntry{id, start, dataSize});
+        }
+        pages[pageOf(start)].liveBytes += recordHeaderLength() + dataSize;
+    }
+
+    void
+    unindexRecord(const storage_id_t& id)
+    {
+        auto it = findEntry(id);
+        if (it != index.end()) {
+            pages[pageOf(it->start)].liveBytes -= recordHeaderLength() + it->dataSize;
+            index.erase(it);
+        }
+    }
+
+    // the record data has been written, write the header and make it part of the log
+    void
+    commitRecord(uint16_t recordStart, LogRecordType type, const storage_id_t& id, uint16_t dataSize)
+    {
+        uint16_t recordEnd = recordStart + recordHeaderLength() + dataSize;
+        writer.reset(recordStart + sizeof(LogRecordType), recordHeaderLength() - sizeof(LogRecordType));
+        writer.put(id);
+        writer.put(dataSize);
+        if (recordEnd + sizeof(LogRecordType) <= pageEnd(activePage)) {
+            // terminate the log before committing the record, in case the page contains old records
+            eeprom.writeByte(recordEnd, static_cast<uint8_t>(LogRecordType::end));
+        }
+        eeprom.writeByte(recordStart, static_cast<uint8_t>(type)); // the record is valid after this write
+        tail = recordEnd;
+        indexRecord(id, recordStart, dataSize);
+    }
+
+    uint8_t
+    oldestPage() const
+    {
+        uint8_t oldest = pageCount;
+        for (uint8_t p = 0; p < pageCount; p++) {
+            if (p != activePage && pages[p].sequence != 0
+                && (oldest == pageCount || pages[p].sequence < pages[oldest].sequence)) {
+                oldest = p;
+            }
+        }
+        return oldest;
+    }
+
+    void
+    openPage(uint8_t page)
+    {
+        // the page is empty when it becomes valid, so write the end marker before the sequence number
+        eeprom.writeByte(pageStart(page) + pageHeaderLength(), static_cast<uint8_t>(LogRecordType::end));
+        uint32_t sequence = nextSequence++;
+        eeprom.put(pageStart(page), sequence);
+        pages[page] = Page{sequence, 0};
+        activePage = page;
+        tail = pageStart(page) + pageHeaderLength();
+    }
+
+    // ensure that a record of the given length fits in the active page, opening and reclaiming pages as needed
+    bool
+    makeRoom(uint16_t recordLength)
+    {
+        for (uint8_t attempt = 0; attempt <= pageCount; attempt++) {
+            if (tail + recordLength <= pageEnd(activePage)) {
+                return true;
+            }
+            // only copying live records from a reclaimed page may use the reserve page
+            uint8_t free = freePageCount();
+            if (free > 1 || (compacting && free > 0)) {
+                auto it = std::find_if(pages.begin(), pages.end(), [](const Page& p) { return p.sequence == 0; });
+                openPage(it - pages.begin());
+                continue;
+            }
+            uint8_t oldest = oldestPage();
+            if (compacting || oldest == pageCount || !reclaimPage(oldest)) {
+                return false;
+            }
+        }
+        return false; // LCOV_EXCL_LINE: live bytes are checked against capacity before
+    }
+
+    // copy the live records of a page to the end of the log and free the page
+    bool
+    reclaimPage(uint8_t page)
+    {
+        compacting = true;
+        uint16_t pos = pageStart(page) + pageHeaderLength();
+        while (pages[page].liveBytes > 0 && pos + recordHeaderLength() <= pageEnd(page)) {
+            uint8_t type = eeprom.readByte(pos);
+            storage_id_t id;
+            uint16_t dataSize;
+            eeprom.get(pos + sizeof(LogRecordType), id);
+            eeprom.get(pos + sizeof(LogRecordType) + sizeof(storage_id_t), dataSize);
+            if (type != uint8_t(LogRecordType::object) && type != uint8_t(LogRecordType::disposed)) {
+                break;
+            }
+            auto entry = findEntry(id);
+            if (type == uint8_t(LogRecordType::object) && entry != index.end() && entry->start == pos) {
+                uint16_t recordLength = recordHeaderLength() + dataSize;
+                if (!makeRoom(recordLength)) {
+                    compacting = false;
+                    return false; // LCOV_EXCL_LINE: the reserve page can hold all records of a page
+                }
+                uint16_t recordStart = tail;
+                reader.reset(pos + recordHeaderLength(), dataSize);
+                writer.reset(recordStart + recordHeaderLength(), dataSize);
+                reader.push(writer, dataSize);
+                commitRecord(recordStart, LogRecordType::object, id, dataSize);
+            }
+            pos += recordHeaderLength() + dataSize;
+        }
+        compacting = false;
+
+        // clearing the sequence number only writes zero bits, so if power is lost halfway, the page still sorts as oldest
+        eeprom.put(pageStart(page), uint32_t(0));
+        pages[page] = Page{0, 0};
+        return true;
+    }
+
+    void
+    format()
+    {
+        eeprom.clear(); // writes zeros, all pages are free and empty
+        auto referenceHeaderValue = referenceHeader();
+        eeprom.put(EepromLocation(header), referenceHeaderValue);
+        index.clear();
+        pages.fill(Page{0, 0});
+        nextSequence = 1;
+        openPage(0);
+    }
+
+    void
+    init()
+    {
+        uint16_t header;
+        eeprom.get(EepromLocation(header), header);
+        if (header != referenceHeader()) {
+            format();
+            return;
+        }
+        buildIndex();
+    }
+
+    // replay the log in order of page sequence to build the in RAM index
+    void
+    buildIndex()
+    {
+        index.clear();
+        std::array<uint8_t, pageCount> order;
+        uint8_t used = 0;
+        for (uint8_t p = 0; p < pageCount; p++) {
+            uint32_t sequence;
+            eeprom.get(pageStart(p), sequence);
+            pages[p] = Page{sequence, 0};
+            if (sequence != 0) {
+                order[used++] = p;
+            }
+        }
+        if (used == 0) {
+            format();
+            return;
+        }
+        std::sort(order.begin(), order.begin() + used, [this](uint8_t a, uint8_t b) {
+            return pages[a].sequence < pages[b].sequence;
+        });
+
+        for (uint8_t i = 0; i < used; i++) {
+            uint8_t page = order[i];
+            uint16_t pos = pageStart(page) + pageHeaderLength();
+            while (pos + recordHeaderLength() <= pageEnd(page)) {
+                uint8_t type = eeprom.readByte(pos);
+                storage_id_t id;
+                uint16_t dataSize;
+                eeprom.get(pos + sizeof(LogRecordType), id);
+                eeprom.get(pos + sizeof(LogRecordType) + sizeof(storage_id_t), dataSize);
+                if (type != uint8_t(LogRecordType::object) && type != uint8_t(LogRecordType::disposed)) {
+                    break;
+                }
+                if (pos + recordHeaderLength() + dataSize > pageEnd(page)) {
+                    break; // corrupt size, ignore the rest of the page
+                }
+                if (type == uint8_t(LogRecordType::object)) {
+                    indexRecord(id, pos, dataSize);
+                } else {
+                    unindexRecord(id);
+                }
+                pos += recordHeaderLength() + dataSize;
+            }
+            activePage = page;
+            tail = pos;
+        }
+        nextSequence = pages[activePage].sequence + 1;
+    }
+};
+
+} // end namespace cbox
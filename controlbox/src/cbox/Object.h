@@ -22,12 +22,22 @@
 #include "CboxError.h"
 #include "DataStream.h"
 #include "ObjectIds.h"
+#include <functional>
 #include <limits>
 
 namespace cbox {
 
 using update_t = uint32_t;
 
+/**
+ * How an object uses another object it links to.
+ * An input is read by the object and is updated before it, an output is written by the object and is updated after it.
+ */
+enum class LinkType : uint8_t {
+    Input,
+    Output,
+};
+
 class Object {
 public:
     Object() = default;
@@ -86,6 +96,38 @@ public:
      * @param iface: typeId of the interface requested
      */
     virtual void* implements(const obj_type_t& iface) = 0;
+
+    /**
+     * Objects that hold links to other objects (for example with a CboxPtr) report them by calling func for each link.
+     * The container uses the links to update objects in order, and to update outputs in the same pass as their inputs
+     * when the inputs report new data. Do not report hardware that is written directly, like an IoArray on the OneWire
+     * bus: it would be accessed again each time the object has new output.
+     * The default is no links.
+     */
+    virtual void forEachLink(const std::function<void(const obj_id_t& id, LinkType type)>& /*func*/) const
+    {
+    }
+
+    /**
+     * Returns true when the last update produced new data for the objects linked to this object,
+     * like a new sensor reading or a new setting written to an output.
+     * Only then the container updates the linked objects in the same pass, with pulledUpdate.
+     * The default is false: linked objects are updated in order, but on their own schedule.
+     */
+    virtual bool hasNewOutput() const
+    {
+        return false;
+    }
+
+    /**
+     * Updates the object because a linked object has new data, see hasNewOutput.
+     * Objects that update at a fixed interval should process the new data right away and realign their interval.
+     * The default is a normal update.
+     */
+    virtual update_t pulledUpdate(const update_t& now)
+    {
+        return update(now);
+    }
 };
 
 } // end namespace cbox
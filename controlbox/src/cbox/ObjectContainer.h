@@ -21,17 +21,49 @@
 
 #include "ContainedObject.h"
 #include "Object.h"
+#include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <vector>
 
 namespace cbox {
 
 class ObjectContainer {
 private:
+    struct ScheduledUpdate {
+        update_t time;
+        obj_id_t id;
+    };
+
+    struct DueUpdate {
+        uint16_t rank;
+        obj_id_t id;
+        bool pulled; // an input of the object was updated in the same pass
+    };
+
+    struct Link {
+        obj_id_t owner; // the object that reported the link
+        obj_id_t from;  // updated first
+        obj_id_t to;    // updated after from, in the same pass
+    };
+
     std::vector<ContainedObject> objects;
     obj_id_t startId = obj_id_t::start();
 
+    // Min-heap of next update times, so an update only has to visit the objects that are due.
+    // Entries are not removed when an object is rescheduled or removed, outdated entries are skipped when they are popped.
+    std::vector<ScheduledUpdate> schedule;
+    std::vector<DueUpdate> dueUpdates; // re-used buffer for the objects to update in a single pass
+
+    // Links reported by the objects, sorted on from. Objects are ranked so each object comes after the objects it depends on.
+    // The ranks are recalculated on the next update after the links changed.
+    std::vector<Link> links;
+    bool ranksValid = true;
+    update_t lastUpdateTime = 0;
+    uint32_t changeCounter = 0; // incremented each time refreshVersions() detects a change
+    uint32_t generationCounter = 0; // incremented each time objects are added, removed or replaced
+
 public:
     using Iterator = decltype(objects)::iterator;
     using CIterator = decltype(objects)::const_iterator;
@@ -44,6 +76,11 @@ public:
     ObjectContainer(std::initializer_list<ContainedObject> systemObjects)
         : objects(systemObjects)
     {
+        for (auto& cobj : objects) {
+            addLinks(cobj);
+        }
+        sortLinks();
+        rebuildSchedule();
     }
 
     virtual ~ObjectContainer() = default;
@@ -74,6 +111,128 @@ private:
         return std::max(startId, objects.empty() ? startId : ++obj_id_t(objects.back().id()));
     }
 
+    // The heap is ordered on the time elapsed since half the update_t range before the last update.
+    // This gives a total order that is stable while time wraps around, as long as entries are not overdue by half the range.
+    // Entries with a key <= overflowGuard are due, consistent with ContainedObject::isDue.
+    update_t scheduleKey(const ScheduledUpdate& entry) const
+    {
+        const update_t overflowGuard = std::numeric_limits<update_t>::max() / 2;
+        return overflowGuard - lastUpdateTime + entry.time;
+    }
+
+    void rebuildSchedule()
+    {
+        schedule.clear();
+        schedule.reserve(objects.size());
+        for (auto& cobj : objects) {
+            schedule.push_back(ScheduledUpdate{cobj.nextUpdateTime(), cobj.id()});
+        }
+        std::make_heap(schedule.begin(), schedule.end(), [this](const ScheduledUpdate& a, const ScheduledUpdate& b) {
+            return scheduleKey(a) > scheduleKey(b);
+        });
+    }
+
+    static bool dueBefore(const DueUpdate& a, const DueUpdate& b)
+    {
+        return a.rank < b.rank || (a.rank == b.rank && a.id < b.id);
+    }
+
+    void addLinks(const ContainedObject& cobj)
+    {
+        auto& obj = cobj.object();
+        if (!obj) {
+            return;
+        }
+        obj_id_t id = cobj.id();
+        obj->forEachLink([this, &id](const obj_id_t& other, LinkType type) {
+            if (!other.isValid() || other == id) {
+                return;
+            }
+            if (type == LinkType::Input) {
+                links.push_back(Link{id, other, id});
+            } else {
+                links.push_back(Link{id, id, other});
+            }
+        });
+    }
+
+    void removeLinks(obj_id_t owner)
+    {
+        links.erase(std::remove_if(links.begin(), links.end(), [&owner](const Link& link) {
+                        return link.owner == owner;
+                    }),
+                    links.end());
+    }
+
+    void sortLinks()
+    {
+        std::sort(links.begin(), links.end(), [](const Link& a, const Link& b) {
+            return a.from < b.from;
+        });
+        ranksValid = false;
+    }
+
+    // Gives each object a rank that is higher than the ranks of the objects it depends on.
+    // The links are relaxed until nothing changes. For links in a cycle, this stops after a pass for each object.
+    void rankObjects()
+    {
+        for (auto& cobj : objects) {
+            cobj.rank(0);
+        }
+        for (size_t pass = 0; pass < objects.size(); pass++) {
+            bool changed = false;
+            for (auto& link : links) {
+                auto from = fetchContained(link.from);
+                auto to = fetchContained(link.to);
+                if (from && to && to->rank() <= from->rank()) {
+                    to->rank(uint16_t(from->rank() + 1));
+                    changed = true;
+                }
+            }
+            if (!changed) {
+                break;
+            }
+        }
+        ranksValid = true;
+    }
+
+    // adds the objects that depend on an updated object to the current pass, behind the object at position
+    void pullDependents(obj_id_t id, uint16_t rank, size_t position)
+    {
+        struct FromLess {
+            bool operator()(const Link& l, const obj_id_t& i) const { return l.from < i; }
+            bool operator()(const obj_id_t& i, const Link& l) const { return i < l.from; }
+        };
+
+        auto range = std::equal_range(links.cbegin(), links.cend(), id, FromLess{});
+        for (auto link = range.first; link != range.second; link++) {
+            auto to = fetchContained(link->to);
+            if (!to || to->rank() <= rank) {
+                continue; // the link is part of a cycle
+            }
+            DueUpdate entry{to->rank(), link->to, true};
+            auto it = std::lower_bound(dueUpdates.begin() + position + 1, dueUpdates.end(), entry, dueBefore);
+            if (it != dueUpdates.end() && it->id == entry.id) {
+                it->pulled = true;
+            } else {
+                dueUpdates.insert(it, entry);
+            }
+        }
+    }
+
+    void scheduleUpdate(const ContainedObject& cobj)
+    {
+        if (schedule.size() >= 2 * objects.size()) {
+            // too many outdated entries have accumulated, start over
+            rebuildSchedule();
+            return;
+        }
+        schedule.push_back(ScheduledUpdate{cobj.nextUpdateTime(), cobj.id()});
+        std::push_heap(schedule.begin(), schedule.end(), [this](const ScheduledUpdate& a, const ScheduledUpdate& b) {
+            return scheduleKey(a) > scheduleKey(b);
+        });
+    }
+
 public:
     /**
      * finds the object entry with the given id.
@@ -143,11 +302,23 @@ public:
             *position = ContainedObject(newId, active_in_groups, std::move(obj));
         } else {
             // insert new entry in container in sorted position
-            objects.emplace(position, newId, active_in_groups, std::move(obj));
+            position = objects.emplace(position, newId, active_in_groups, std::move(obj));
         }
+        ++generationCounter;
+        scheduleUpdate(*position);
+        refreshLinks(newId);
         return newId;
     }
 
+    /**
+     * Returns a counter that changes each time objects are added, removed or replaced through the container.
+     * Lookups that cache a pointer to an object can skip searching the container while it is unchanged.
+     */
+    uint32_t generation() const
+    {
+        return generationCounter;
+    }
+
     CboxError remove(obj_id_t id)
     {
         if (id < startId) {
@@ -156,6 +327,8 @@ public:
         // find existing object
         auto p = findPosition(id);
         objects.erase(p.first, p.second); // doesn't remove anything if no objects found (first == second)
+        ++generationCounter;
+        refreshLinks(id);
         return p.first == p.second ? CboxError::INVALID_OBJECT_ID : CboxError::OK;
     }
 
@@ -180,6 +353,8 @@ public:
     {
         auto it = objects.erase(cit, cit); // convert to non-const iterator
         it->deactivate();
+        ++generationCounter;
+        refreshLinks(it->id());
     }
 
     // replace an object with an inactive object by id
@@ -188,6 +363,8 @@ public:
         auto p = findPosition(id);
         if (p.first != p.second) {
             p.first->deactivate();
+            ++generationCounter;
+            refreshLinks(id);
         }
     }
 
@@ -195,6 +372,13 @@ public:
     void clear()
     {
         objects.erase(userbegin(), cend());
+        ++generationCounter;
+        links.erase(std::remove_if(links.begin(), links.end(), [this](const Link& link) {
+                        return !(link.owner < startId);
+                    }),
+                    links.end());
+        ranksValid = false;
+        rebuildSchedule();
     }
 
     // remove all objects from the container
@@ -202,21 +386,118 @@ public:
     {
         objects.clear();
         objects.shrink_to_fit();
+        ++generationCounter;
+        schedule.clear();
+        schedule.shrink_to_fit();
+        links.clear();
+        links.shrink_to_fit();
     }
 
+    /**
+     * Replaces the links reported by an object.
+     * Objects added, removed or deactivated through the container are handled automatically.
+     * Call this when the links of an object might have changed otherwise, for example after new settings were written to it.
+     */
+    void refreshLinks(obj_id_t id)
+    {
+        removeLinks(id);
+        if (auto cobj = fetchContained(id)) {
+            addLinks(*cobj);
+        }
+        sortLinks();
+    }
+
+    // Update all objects that are due, after the objects they depend on and otherwise in order of their id.
+    // When an update produces new data for linked objects, they are updated in the same pass with a pulled update.
     void update(update_t now)
     {
-        for (auto& cobj : objects) {
-            cobj.update(now);
+        lastUpdateTime = now;
+        auto laterFirst = [this](const ScheduledUpdate& a, const ScheduledUpdate& b) {
+            return scheduleKey(a) > scheduleKey(b);
+        };
+
+        if (!ranksValid) {
+            rankObjects();
+        }
+
+        dueUpdates.clear();
+        while (!schedule.empty() && ContainedObject::isDue(schedule.front().time, now)) {
+            auto cobj = fetchContained(schedule.front().id);
+            dueUpdates.push_back(DueUpdate{cobj ? cobj->rank() : uint16_t(0), schedule.front().id, false});
+            std::pop_heap(schedule.begin(), schedule.end(), laterFirst);
+            schedule.pop_back();
+        }
+        // an object can have multiple entries in the schedule when it was rescheduled, only update it once
+        std::sort(dueUpdates.begin(), dueUpdates.end(), dueBefore);
+        dueUpdates.erase(std::unique(dueUpdates.begin(), dueUpdates.end(), [](const DueUpdate& a, const DueUpdate& b) {
+                             return a.id == b.id;
+                         }),
+                         dueUpdates.end());
+
+        // dependents are inserted behind the current position while iterating, so index instead of using an iterator
+        for (size_t i = 0; i < dueUpdates.size(); i++) {
+            auto due = dueUpdates[i];
+            if (auto cobj = fetchContained(due.id)) {
+                if (due.pulled || ContainedObject::isDue(cobj->nextUpdateTime(), now)) {
+                    if (due.pulled) {
+                        cobj->pulledUpdate(now);
+                    } else {
+                        cobj->forcedUpdate(now);
+                    }
+                    if (cobj->hasNewOutput()) {
+                        pullDependents(due.id, due.rank, i);
+                    }
+                }
+                // re-add outdated entries at their actual time, in case the object was rescheduled without the container
+                // if a valid entry also exists, they will be popped together and de-duplicated above
+                scheduleUpdate(*cobj);
+            }
         }
     }
 
+    // update a single object, regardless of whether it is due
+    void forcedUpdate(ContainedObject& cobj, update_t now)
+    {
+        cobj.forcedUpdate(now);
+        scheduleUpdate(cobj);
+    }
+
     void forcedUpdate(update_t now)
     {
+        lastUpdateTime = now;
         for (auto& cobj : objects) {
             cobj.forcedUpdate(now);
         }
+        rebuildSchedule();
+    }
+
+    /**
+     * Checks all objects for changes in their streamed state since the last check.
+     * Changed objects get the incremented change counter as version.
+     * Returns the change counter, which a client can use as cursor: objects with a higher version have changed since.
+     * Every object is streamed to compute its hash, so the cost grows with the size of all objects, not with the changes.
+     */
+    uint32_t refreshVersions()
+    {
+        const uint32_t next = changeCounter + 1;
+        bool changed = false;
+        for (auto& cobj : objects) {
+            changed |= cobj.refreshVersion(next);
+        }
+        if (changed) {
+            changeCounter = next;
+        }
+        return changeCounter;
+    }
+
+#if CBOX_PROFILING
+    void resetProfiles()
+    {
+        for (auto& cobj : objects) {
+            cobj.resetProfile();
+        }
     }
+#endif
 };
 
 } // end namespace cbox
@@ -45,6 +45,12 @@ public:
     virtual bool disposeObject(const storage_id_t& id, bool mergeDisposed = true) = 0;
 
     virtual void clear() = 0;
+
+    /**
+     * Called regularly from Box::update to do a bounded amount of housekeeping,
+     * so it doesn't have to be done when an object is stored. Does nothing by default.
+     */
+    virtual void compact() {}
 };
 
 } // end namespace cbox
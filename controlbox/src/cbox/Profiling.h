@@ -0,0 +1,87 @@
+/*
+ * Copyright 2020 Elco Jacobs / BrewBlox
+ *
+ * This file is part of ControlBox
+ *
+ * Controlbox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Controlbox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Per object accounting of the time spent in update, streamTo, streamFrom and persisting.
+// Enabled by building with -DCBOX_PROFILING=1. When disabled, no code or data is added to ContainedObject.
+#ifndef CBOX_PROFILING
+#define CBOX_PROFILING 0
+#endif
+
+namespace cbox {
+
+namespace profiling {
+    struct ObjectProfile {
+        uint32_t updateCount = 0;
+        uint32_t updateMicros = 0;    // cumulative time spent in update
+        uint32_t updateMicrosMax = 0; // longest single update
+        uint32_t streamToMicros = 0;
+        uint32_t streamFromMicros = 0;
+        uint32_t persistMicros = 0;
+        // update durations, bucket i counts durations shorter than 16 << i us, the last bucket counts all longer ones
+        std::array<uint16_t, 8> updateHistogram = {0};
+
+        void addUpdate(uint32_t duration)
+        {
+            ++updateCount;
+            updateMicros += duration;
+            if (duration > updateMicrosMax) {
+                updateMicrosMax = duration;
+            }
+            uint8_t bucket = 0;
+            while (bucket < updateHistogram.size() - 1 && duration >= (uint32_t(16) << bucket)) {
+                ++bucket;
+            }
+            if (updateHistogram[bucket] < UINT16_MAX) {
+                ++updateHistogram[bucket];
+            }
+        }
+    };
+
+#if CBOX_PROFILING
+    // microsecond clock, implemented by the application
+    uint32_t micros();
+
+    /**
+     * Adds the time between construction and destruction to a cumulative total
+     */
+    class ScopedTimer {
+    private:
+        uint32_t& total;
+        uint32_t start;
+
+    public:
+        ScopedTimer(uint32_t& _total)
+            : total(_total)
+            , start(micros())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            total += micros() - start;
+        }
+    };
+#endif
+}
+}
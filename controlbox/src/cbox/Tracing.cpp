@@ -21,14 +21,17 @@
 #include "ObjectIds.h"
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
 
 namespace cbox {
 
 namespace tracing {
     namespace detail {
-        __attribute__((section(".retained_user"))) std::array<TraceEvent, 10> historyRetained = std::array<TraceEvent, 10>{TraceEvent{uint8_t(tracing::Action::NONE), 0, 0}};
-        __attribute__((section(".retained_user"))) uint8_t lastIdx = 0;
+        // events and write counter are kept in retained memory to be able to read what happened before a reset
+        __attribute__((section(".retained_user"))) std::array<TraceEvent, capacity> eventsRetained = std::array<TraceEvent, capacity>{TraceEvent{uint8_t(tracing::Action::NONE), 0, 0, 0}};
+        __attribute__((section(".retained_user"))) std::atomic<uint32_t> writeCountRetained{0};
+        std::array<TraceEvent, 10> lastEvents;
         bool writeEnabled = false;
     }
 
@@ -36,25 +39,58 @@ namespace tracing {
     {
         using namespace detail;
         if (writeEnabled) {
-            if (historyRetained[lastIdx].action == uint8_t(Action::PERSIST_OBJECT) && historyRetained[lastIdx].id == i) {
-                return; // persisting a block can take a retry if a new block needs to be allocated, don't log twice.
+            uint32_t count = writeCountRetained.load(std::memory_order_relaxed);
+            if (count > 0) {
+                const auto& last = eventsRetained[(count - 1) & (capacity - 1)];
+                if (last.action == uint8_t(Action::PERSIST_OBJECT) && last.id == i) {
+                    return; // persisting a block can take a retry if a new block needs to be allocated, don't log twice.
+                }
             }
-            lastIdx = (lastIdx < 9) ? lastIdx + 1 : 0;
 
-            historyRetained[lastIdx] = TraceEvent{a, i, t};
+            eventsRetained[count & (capacity - 1)] = TraceEvent{a, i, t, timestamp()};
+            // publish the event after it has been written
+            writeCountRetained.store(count + 1, std::memory_order_release);
         }
     }
 
+    uint32_t writeCount()
+    {
+        return detail::writeCountRetained.load(std::memory_order_acquire);
+    }
+
+    uint16_t drain(uint32_t& cursor, TraceEvent* dest, uint16_t maxCount)
+    {
+        using namespace detail;
+        uint32_t end = writeCount();
+        if (end - cursor > capacity) {
+            cursor = end - capacity; // older events have been overwritten
+        }
+        uint16_t count = uint16_t(std::min(end - cursor, uint32_t(maxCount)));
+        for (uint16_t i = 0; i < count; i++) {
+            dest[i] = eventsRetained[(cursor + i) & (capacity - 1)];
+        }
+
+        // events that were overwritten while copying them are dropped
+        uint32_t overwritten = writeCount() - capacity;
+        if (int32_t(overwritten - cursor) > 0) {
+            uint32_t dropped = std::min(overwritten - cursor, uint32_t(count));
+            std::copy(dest + dropped, dest + count, dest);
+            cursor += dropped;
+            count -= dropped;
+        }
+        return count;
+    }
+
     const std::array<TraceEvent, 10>& history()
     {
-        // history is kept as a circular buffer,
-        // rotate array so oldest element is the first element before returning
+        // history is kept as a circular buffer, copy the last 10 events with the oldest event first
         using namespace detail;
-        if (lastIdx != 9) {
-            std::rotate(historyRetained.begin(), historyRetained.begin() + lastIdx + 1, historyRetained.end());
-            lastIdx = 9;
+        uint32_t end = writeCount();
+        for (uint32_t i = 0; i < lastEvents.size(); i++) {
+            // before the buffer has filled up, unused entries are empty events
+            lastEvents[i] = eventsRetained[(end - lastEvents.size() + i) & (capacity - 1)];
         }
-        return historyRetained;
+        return lastEvents;
     }
 
     void unpause()
@@ -67,4 +103,4 @@ namespace tracing {
         detail::writeEnabled = false;
     }
 }
-}
\ No newline at end of file
+}
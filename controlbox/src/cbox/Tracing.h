@@ -41,6 +41,13 @@ namespace tracing {
         FACTORY_RESET = 10,           // erase all settings and reboot
         LIST_COMPATIBLE_OBJECTS = 11, // list object IDs implementing the requested interface
         DISCOVER_NEW_OBJECTS = 12,    // discover newly connected objects that support auto discovery
+        READ_OBJECTS = 13,            // stream multiple objects to the data out in a single response
+        WRITE_OBJECTS = 14,           // stream new data into multiple objects from the data in
+        LIST_CHANGED_OBJECTS = 15,    // list active objects that changed since the cursor sent by the client
+        SUBSCRIBE_OBJECTS = 16,       // push changed objects to the connection, without polling
+        READ_OBJECT_PROFILES = 17,    // list time spent per object, only available when built with CBOX_PROFILING
+        READ_TRACE = 18,              // stream traced events, starting at the cursor sent by the client
+        READ_CONNECTION_STATS = 19,   // list the command counters of each connection
 
         // object actions
         CONSTRUCT_OBJECT = 20,
@@ -59,16 +66,40 @@ namespace tracing {
         // use raw uint16_t id's, using cbox id's overwrites backup memory on construction somewhere
         uint16_t id;
         uint16_t type;
+        uint32_t time; // timestamp in microseconds
     };
 
+// Number of events kept in retained memory. Must be a power of 2.
+#ifndef CBOX_TRACING_CAPACITY
+#define CBOX_TRACING_CAPACITY 64
+#endif
+    const uint32_t capacity = CBOX_TRACING_CAPACITY;
+    static_assert((capacity & (capacity - 1)) == 0, "tracing capacity must be a power of 2");
+
+    // timestamp for trace events in microseconds, implemented by the application
+    uint32_t timestamp();
+
     void add(uint8_t a, obj_id_t i, obj_type_t t);
     inline void add(uint8_t a)
     {
         add(a, 0, 0);
     }
 
+    // the last 10 events, oldest first
     const std::array<TraceEvent, 10>& history();
 
+    /**
+     * Copies at most maxCount events to dest, starting at sequence number cursor.
+     * Events older than the capacity of the buffer are lost. If the cursor points to a lost event,
+     * cursor is moved to the oldest event that is still available.
+     * Returns the number of copied events. The next call should use cursor + the returned count.
+     * Events are only overwritten by add(), so a reader never blocks the writer.
+     */
+    uint16_t drain(uint32_t& cursor, TraceEvent* dest, uint16_t maxCount);
+
+    // sequence number of the next event that will be added
+    uint32_t writeCount();
+
     void unpause();
 
     void pause();
@@ -20,6 +20,22 @@
 
 using namespace cbox;
 
+// converts a hex string to the escaped bytes used for binary framing
+std::string
+binaryFramed(const std::string& hex)
+{
+    std::string result;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        uint8_t data = uint8_t((h2d(hex[i]) << 4) | h2d(hex[i + 1]));
+        if (binary_framing::needsEscape(data)) {
+            result.push_back(char(binary_framing::escape));
+            data ^= binary_framing::escapeMask;
+        }
+        result.push_back(char(data));
+    }
+    return result;
+}
+
 SCENARIO("A controlbox Box")
 {
     ObjectContainer container{
@@ -50,6 +66,7 @@ SCENARIO("A controlbox Box")
     scanningFactories.push_back(std::move(longIntScanner));
 
     Box box(factory, container, storage, connPool, std::move(scanningFactories));
+    box.setCursorEpoch(0x12345678);
 
     auto in = std::make_shared<std::stringstream>();
     auto out = std::make_shared<std::stringstream>();
@@ -354,6 +371,620 @@ SCENARIO("A controlbox Box")
         CHECK(out->str() == expected.str());
     }
 
+    WHEN("A connection sends a read objects command without ids, all objects implementing the interface are sent with a status each")
+    {
+        *in << "00000D"  // read objects
+            << "E803"    // interface filter: LongIntObject
+            << "0000";   // no ids
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        expected << addCrc("00000DE8030000")
+                 << "|" << addCrc("00")
+                 << "," << addCrc("00020080E80311111111")
+                 << "," << addCrc("00030080E80322222222")
+                 << "\n";
+        CHECK(out->str() == expected.str());
+
+        AND_WHEN("The interface filter is 0, all objects are sent")
+        {
+            clearStreams();
+            *in << "00000D00000000";
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+
+            expected << addCrc("00000D00000000")
+                     << "|" << addCrc("00")
+                     << "," << addCrc("00010080FEFF81")
+                     << "," << addCrc("00020080E80311111111")
+                     << "," << addCrc("00030080E80322222222")
+                     << "\n";
+            CHECK(out->str() == expected.str());
+        }
+    }
+
+    WHEN("A connection sends a read objects command with ids, the requested objects are sent in order with a status each")
+    {
+        *in << "00000D" // read objects
+            << "E803"   // interface filter: LongIntObject
+            << "0400"   // 4 ids
+            << "0300"   // object 3
+            << "0800"   // object 8, does not exist
+            << "0100"   // object 1, does not implement LongIntObject
+            << "0200";  // object 2
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        expected << addCrc("00000DE8030400030008000100" "0200")
+                 << "|" << addCrc("00")
+                 << "," << addCrc("00030080E80322222222")
+                 << "," << addCrc("400800") // INVALID_OBJECT_ID
+                 << "," << addCrc("410100") // INVALID_OBJECT_TYPE
+                 << "," << addCrc("00020080E80311111111")
+                 << "\n";
+        CHECK(out->str() == expected.str());
+    }
+
+    WHEN("A connection sends a write objects command, each object is written and persisted with its own status")
+    {
+        *in << "00000E"                 // write objects
+            << "0300"                   // 3 objects
+            << "0200" "0700"            // object 2, 7 bytes
+            << "80E80333333333"         // groups 80, type 1000, value 33333333
+            << "0800" "0700"            // object 8, does not exist
+            << "80E80344444444"         // skipped
+            << "0300" "0700"            // object 3
+            << "80E90355555555";        // wrong type 1001
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        expected << addCrc("00000E0300"
+                           "0200070080E80333333333"
+                           "0800070080E80344444444"
+                           "0300070080E90355555555")
+                 << "|" << addCrc("00")
+                 << "," << addCrc("00020080E80333333333")
+                 << "," << addCrc("400800") // INVALID_OBJECT_ID
+                 << "," << addCrc("410300") // INVALID_OBJECT_TYPE
+                 << "\n";
+        CHECK(out->str() == expected.str());
+
+        THEN("The written object is persisted and the others are unchanged")
+        {
+            clearStreams();
+            *in << "0000060200"; // read stored object 2
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+
+            expected << addCrc("0000060200") << "|"
+                     << addCrc("00020080E80333333333")
+                     << "\n";
+            CHECK(out->str() == expected.str());
+
+            auto obj3 = box.makeCboxPtr<LongIntObject>(3).lock();
+            REQUIRE(obj3);
+            CHECK(obj3->value() == 0x22222222);
+        }
+    }
+
+    WHEN("A connection sends a write objects command with a CRC error, nothing is persisted")
+    {
+        *in << "00000E0100"
+            << "0200070080E80333333333"
+            << "00\n"; // invalid CRC
+        box.hexCommunicate();
+
+        expected << "00000E0100"
+                 << "0200070080E80333333333"
+                 << "00|" << addCrc("43") << "\n";
+        CHECK(out->str() == expected.str());
+
+        clearStreams();
+        *in << "0000060200"; // read stored object 2
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        expected << addCrc("0000060200") << "|" << addCrc("11") << "\n"; // PERSISTED_OBJECT_NOT_FOUND
+        CHECK(out->str() == expected.str());
+    }
+
+    WHEN("A connection sends a list changed objects command with cursor 0, all objects are sent with a new cursor")
+    {
+        *in << "00000F0000000000000000"; // list changed objects since cursor 0
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        expected << addCrc("00000F0000000000000000")
+                 << "|" << addCrc("00"                // status
+                                  "0100000078563412") // new cursor 1 in epoch 0x12345678
+                 << "," << addCrc("010080FEFF81")
+                 << "," << addCrc("020080E80311111111")
+                 << "," << addCrc("030080E80322222222")
+                 << "\n";
+        CHECK(out->str() == expected.str());
+
+        AND_WHEN("Nothing has changed, no objects are sent and the cursor is unchanged")
+        {
+            clearStreams();
+            *in << "00000F0100000078563412";
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+
+            expected << addCrc("00000F0100000078563412")
+                     << "|" << addCrc("000100000078563412")
+                     << "\n";
+            CHECK(out->str() == expected.str());
+        }
+
+        AND_WHEN("An object is changed, only that object is sent")
+        {
+            auto obj = box.makeCboxPtr<LongIntObject>(3).lock();
+            REQUIRE(obj);
+            obj->value(0x33333333);
+
+            clearStreams();
+            *in << "00000F0100000078563412";
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+
+            expected << addCrc("00000F0100000078563412")
+                     << "|" << addCrc("000200000078563412")
+                     << "," << addCrc("030080E80333333333")
+                     << "\n";
+            CHECK(out->str() == expected.str());
+
+            THEN("A client with an older cursor still receives all objects changed since that cursor")
+            {
+                clearStreams();
+                *in << "00000F0000000000000000";
+                *in << crc(in->str()) << "\n";
+                box.hexCommunicate();
+
+                expected << addCrc("00000F0000000000000000")
+                         << "|" << addCrc("000200000078563412")
+                         << "," << addCrc("010080FEFF81")
+                         << "," << addCrc("020080E80311111111")
+                         << "," << addCrc("030080E80333333333")
+                         << "\n";
+                CHECK(out->str() == expected.str());
+            }
+        }
+
+        AND_WHEN("A client sends a cursor from before a reboot, all objects are sent, even when its change counter is not ahead")
+        {
+            clearStreams();
+            *in << "00000F0100000011111111"; // cursor 1 in epoch 0x11111111
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+
+            expected << addCrc("00000F0100000011111111")
+                     << "|" << addCrc("000100000078563412")
+                     << "," << addCrc("010080FEFF81")
+                     << "," << addCrc("020080E80311111111")
+                     << "," << addCrc("030080E80322222222")
+                     << "\n";
+            CHECK(out->str() == expected.str());
+        }
+    }
+
+    WHEN("A connection sends a read object command with binary framing, the reply uses binary framing")
+    {
+        const char start = char(binary_framing::start);
+        *in << start << binaryFramed(addCrc("0000010200")) << "\n";
+        box.hexCommunicate();
+
+        expected << start << binaryFramed(addCrc("0000010200"))
+                 << "|" << binaryFramed(addCrc("000200" "80" "E803" "11111111"))
+                 << "\n";
+        CHECK(out->str() == expected.str());
+
+        AND_WHEN("The data contains protocol special characters, they are escaped and the next command can use hex again")
+        {
+            clearStreams();
+            *in << start << binaryFramed(addCrc("000002020080E8030A7C2CFE")) << "\n";
+            *in << addCrc("0000010200") << "\n";
+            box.hexCommunicate();
+
+            auto binaryReply = binaryFramed(addCrc("000200" "80" "E803" "0A7C2CFE"));
+            CHECK(binaryReply.find('\n') == std::string::npos);
+            CHECK(binaryReply.find(',') == std::string::npos);
+            CHECK(binaryReply.find('|') == std::string::npos);
+
+            expected << start << binaryFramed(addCrc("000002020080E8030A7C2CFE"))
+                     << "|" << binaryReply
+                     << "\n"
+                     << addCrc("0000010200")
+                     << "|" << addCrc("00020080E8030A7C2CFE")
+                     << "\n";
+            CHECK(out->str() == expected.str());
+        }
+    }
+
+    WHEN("A connection sends a command with binary framing and a CRC error, a CRC error is returned")
+    {
+        const char start = char(binary_framing::start);
+        *in << start << binaryFramed("000001020000") << "\n";
+        box.hexCommunicate();
+
+        expected << start << binaryFramed("000001020000")
+                 << "|" << binaryFramed(addCrc("43"))
+                 << "\n";
+        CHECK(out->str() == expected.str());
+    }
+
+    WHEN("A connection sends a list objects command with binary framing, list items are separated like with hex")
+    {
+        const char start = char(binary_framing::start);
+        *in << start << binaryFramed(addCrc("000005")) << "\n";
+        box.hexCommunicate();
+
+        expected << start << binaryFramed(addCrc("000005"))
+                 << "|" << binaryFramed(addCrc("00"))
+                 << "," << binaryFramed(addCrc("010080FEFF81"))
+                 << "," << binaryFramed(addCrc("020080E80311111111"))
+                 << "," << binaryFramed(addCrc("030080E80322222222"))
+                 << "\n";
+        CHECK(out->str() == expected.str());
+    }
+
+    WHEN("A connection subscribes to an object, changes are pushed at most once per interval")
+    {
+        *in << "000010" // subscribe objects
+            << "E803"   // interval 1000 ms
+            << "0000"   // any type
+            << "0100"   // 1 id
+            << "0300";  // object 3
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        expected << addCrc("000010E8030000010003" "00")
+                 << "|" << addCrc("00")
+                 << "\n";
+        CHECK(out->str() == expected.str());
+
+        THEN("The subscribed object is pushed on the next update")
+        {
+            clearStreams();
+            box.update(0);
+
+            expected << "|" << addCrc("000100000078563412")
+                     << "," << addCrc("030080E80322222222")
+                     << "\n";
+            CHECK(out->str() == expected.str());
+
+            AND_THEN("Nothing is pushed when the object has not changed or the interval has not passed")
+            {
+                auto obj = box.makeCboxPtr<LongIntObject>(3).lock();
+                REQUIRE(obj);
+
+                clearStreams();
+                box.update(1000);
+                CHECK(out->str() == "");
+
+                obj->value(0x33333333);
+                box.update(1500);
+                CHECK(out->str() == "");
+
+                box.update(2000);
+                expected << "|" << addCrc("000200000078563412")
+                         << "," << addCrc("030080E80333333333")
+                         << "\n";
+                CHECK(out->str() == expected.str());
+            }
+
+            AND_THEN("A change in an object that is not subscribed to is not pushed")
+            {
+                auto obj = box.makeCboxPtr<LongIntObject>(2).lock();
+                REQUIRE(obj);
+                obj->value(0x33333333);
+
+                clearStreams();
+                box.update(1000);
+                CHECK(out->str() == "");
+            }
+
+            AND_THEN("The cursor epoch changes, the subscribed object is pushed again with a cursor in the new epoch")
+            {
+                box.setCursorEpoch(0x11111111);
+                clearStreams();
+                box.update(1000);
+                expected << "|" << addCrc("000100000011111111")
+                         << "," << addCrc("030080E80322222222")
+                         << "\n";
+                CHECK(out->str() == expected.str());
+            }
+
+            AND_WHEN("The subscription is cancelled with interval 0, nothing is pushed")
+            {
+                clearStreams();
+                *in << "00001000000000000000";
+                *in << crc(in->str()) << "\n";
+                box.hexCommunicate();
+                CHECK(out->str() == addCrc("00001000000000000000") + "|" + addCrc("00") + "\n");
+
+                auto obj = box.makeCboxPtr<LongIntObject>(3).lock();
+                REQUIRE(obj);
+                obj->value(0x33333333);
+
+                clearStreams();
+                box.update(1000);
+                CHECK(out->str() == "");
+            }
+        }
+    }
+
+    WHEN("A connection subscribes with binary framing, pushed messages use binary framing")
+    {
+        const char start = char(binary_framing::start);
+        *in << start << binaryFramed(addCrc("0000100A00E8030000")) << "\n"; // interval 10 ms, LongIntObject, all ids
+        box.hexCommunicate();
+        clearStreams();
+
+        box.update(0);
+        expected << start
+                 << "|" << binaryFramed(addCrc("000100000078563412"))
+                 << "," << binaryFramed(addCrc("020080E80311111111"))
+                 << "," << binaryFramed(addCrc("030080E80322222222"))
+                 << "\n";
+        CHECK(out->str() == expected.str());
+    }
+
+    WHEN("A persist delay is set, repeated writes to an object are persisted once after the delay")
+    {
+        box.setPersistDelay(1000);
+        box.update(0);
+
+        auto storedValue = [&storage](const obj_id_t& id) -> uint32_t {
+            uint32_t value = 0;
+            storage.retrieveObject(storage_id_t(id), [&value](RegionDataIn& in) -> CboxError {
+                uint8_t groups;
+                obj_type_t typeId;
+                in.get(groups);
+                in.get(typeId);
+                in.get(value);
+                return CboxError::OK;
+            });
+            return value;
+        };
+
+        auto writeValue = [&](const std::string& value) {
+            clearStreams();
+            *in << "000002020080E803" << value; // write object 2
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+        };
+
+        eeprom.hasChanged(); // reset changed flag
+        writeValue("33333333");
+        writeValue("44444444");
+        CHECK(box.getObject(2).lock());
+        CHECK_FALSE(eeprom.hasChanged());
+        CHECK(storedValue(2) == 0);
+
+        box.update(999);
+        CHECK(storedValue(2) == 0);
+        box.update(1000);
+        CHECK(storedValue(2) == 0x44444444);
+
+        AND_WHEN("An object is written and a reboot command is sent before the delay has passed, the object is persisted before the reset")
+        {
+            writeValue("55555555");
+            CHECK(storedValue(2) == 0x44444444);
+
+            auto rebootCount = testInfo.rebootCount;
+            clearStreams();
+            *in << "000009";
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+            CHECK(testInfo.rebootCount == rebootCount + 1);
+            CHECK(storedValue(2) == 0x55555555);
+            testInfo.rebootCount = rebootCount; // other tests expect no reboots
+        }
+
+        AND_WHEN("An object is written and the stored object is read, it is persisted first")
+        {
+            writeValue("55555555");
+            clearStreams();
+            *in << "0000060200"; // read stored object 2
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+            CHECK(storedValue(2) == 0x55555555);
+        }
+
+        AND_WHEN("The application stores updated objects, they are persisted one per update")
+        {
+            CHECK(box.storeUpdatedObject(2) == CboxError::OK);
+            CHECK(box.storeUpdatedObject(3) == CboxError::OK);
+            eeprom.hasChanged();
+            box.update(1999);
+            CHECK_FALSE(eeprom.hasChanged());
+            box.update(2000);
+            CHECK(storedValue(3) == 0);
+            box.update(2001);
+            CHECK(storedValue(3) == 0x22222222);
+        }
+
+        AND_WHEN("Storage is full when an object is persisted, the error is reported once as an event and the store is retried")
+        {
+            // remove object 2 from storage and fill it with filler data: large blocks first, then small blocks for the gaps
+            storage.disposeObject(storage_id_t(2));
+            uint16_t nextFillerId = 1000;
+            for (uint16_t fillerSize : {uint16_t(100), uint16_t(1)}) {
+                auto writeFiller = [fillerSize](DataOut& out) -> CboxError {
+                    for (uint16_t i = 0; i < fillerSize; ++i) {
+                        out.write(0);
+                    }
+                    return CboxError::OK;
+                };
+                while (storage.storeObject(storage_id_t(nextFillerId), writeFiller) == CboxError::OK) {
+                    ++nextFillerId;
+                }
+            }
+
+            writeValue("55555555");
+            CHECK(out->str() == addCrc("000002020080E80355555555") + "|" + addCrc("00020080E80355555555") + "\n");
+
+            clearStreams();
+            box.update(2000);
+            CHECK(storedValue(2) == 0);
+            box.hexCommunicate();
+            CHECK(out->str() == "<!PERSIST ERROR ID:0002 CBOXERROR:10>");
+
+            THEN("The failed store is retried after the delay without reporting the error again")
+            {
+                clearStreams();
+                box.update(3000);
+                box.hexCommunicate();
+                CHECK(storedValue(2) == 0);
+                CHECK(out->str() == "");
+
+                AND_WHEN("Storage is freed, the object is persisted on the next retry")
+                {
+                    for (uint16_t id = 1000; id < nextFillerId; ++id) {
+                        storage.disposeObject(storage_id_t(id));
+                    }
+                    box.update(3999);
+                    CHECK(storedValue(2) == 0);
+                    box.update(4000);
+                    CHECK(storedValue(2) == 0x55555555);
+                }
+            }
+        }
+    }
+
+#if CBOX_PROFILING
+    WHEN("Objects are updated and streamed, the time spent per object can be read with the profiling command")
+    {
+        // the test runner has a fake clock that advances 10 us each time it is read
+        *in << "00001101"; // read object profiles and reset them
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+        clearStreams();
+
+        box.forcedUpdate(0);
+        *in << "0000010200"; // read object 2
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+        clearStreams();
+
+        *in << "00001100"; // read object profiles without reset
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        const std::string updatedOnce = "01000000"  // update count
+                                        "0A000000"  // cumulative update time 10 us
+                                        "0A000000"; // max update time 10 us
+        const std::string histogram = "0100" // 1 update shorter than 16 us
+                                      "0000" "0000" "0000" "0000" "0000" "0000" "0000";
+        expected << addCrc("00001100")
+                 << "|" << addCrc("00")
+                 << "," << addCrc("0100FEFF" + updatedOnce + "00000000" "00000000" "00000000" + histogram)
+                 << "," << addCrc("0200E803" + updatedOnce + "0A000000" "00000000" "00000000" + histogram)
+                 << "," << addCrc("0300E803" + updatedOnce + "00000000" "00000000" "00000000" + histogram)
+                 << "\n";
+        CHECK(out->str() == expected.str());
+    }
+#endif
+
+    WHEN("A connection sends a read connection stats command, it receives the counters of each connection")
+    {
+        *in << "000013"; // read connection stats
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        // the command that is being handled is not counted yet, the test pool has no clock
+        expected << addCrc("000013")
+                 << "|" << addCrc("00")
+                 << "," << addCrc("00000000"  // commands
+                                  "00000000"  // time spent
+                                  "0000")     // queued input
+                 << "\n";
+        CHECK(out->str() == expected.str());
+
+        AND_WHEN("The command is sent again, the first command is counted")
+        {
+            clearStreams();
+            *in << "000013";
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+
+            expected << addCrc("000013")
+                     << "|" << addCrc("00")
+                     << "," << addCrc("01000000"
+                                      "00000000"
+                                      "0000")
+                     << "\n";
+            CHECK(out->str() == expected.str());
+        }
+    }
+
+    WHEN("A connection sends read trace commands, traced events are streamed incrementally with timestamps")
+    {
+        // the test runner timestamps each event with a counter
+        auto asHex = [](uint32_t value, uint8_t bytes) {
+            std::stringstream ss;
+            for (uint8_t i = 0; i < bytes; i++) {
+                ss << std::uppercase << std::setfill('0') << std::setw(2) << std::hex << ((value >> (8 * i)) & 0xFF);
+            }
+            return ss.str();
+        };
+        auto event = [&asHex](uint8_t action, uint16_t id, uint16_t type, uint32_t time) {
+            return asHex(action, 1) + asHex(id, 2) + asHex(type, 2) + asHex(time, 4);
+        };
+
+        cbox::tracing::unpause();
+        auto cursor = cbox::tracing::writeCount();
+        auto t = testInfo.traceTimestamp;
+        cbox::tracing::add(cbox::tracing::Action::UPDATE_OBJECT, 2, 1000);
+        cbox::tracing::add(cbox::tracing::Action::UPDATE_OBJECT, 3, 1000);
+
+        std::string cmd = "000012" + asHex(cursor, 4);
+        *in << cmd << crc(cmd) << "\n";
+        box.hexCommunicate();
+
+        expected << addCrc(cmd)
+                 << "|" << addCrc("00" + asHex(cursor, 4) + "04"
+                                  + event(cbox::tracing::Action::UPDATE_OBJECT, 2, 1000, t + 1)
+                                  + event(cbox::tracing::Action::UPDATE_OBJECT, 3, 1000, t + 2)
+                                  + event(cbox::tracing::Action::UPDATE_CONNECTIONS, 0, 0, t + 3)
+                                  + event(cbox::tracing::Action::READ_TRACE, 0, 0, t + 4))
+                 << "\n";
+        CHECK(out->str() == expected.str());
+
+        AND_WHEN("The next command continues where the previous one ended")
+        {
+            clearStreams();
+            cmd = "000012" + asHex(cursor + 4, 4);
+            *in << cmd << crc(cmd) << "\n";
+            box.hexCommunicate();
+
+            expected << addCrc(cmd)
+                     << "|" << addCrc("00" + asHex(cursor + 4, 4) + "02"
+                                      + event(cbox::tracing::Action::UPDATE_CONNECTIONS, 0, 0, t + 5)
+                                      + event(cbox::tracing::Action::READ_TRACE, 0, 0, t + 6))
+                     << "\n";
+            CHECK(out->str() == expected.str());
+        }
+
+        AND_WHEN("More events are added than fit in the buffer, the cursor skips to the oldest available event")
+        {
+            for (uint32_t i = 0; i < cbox::tracing::capacity; i++) {
+                cbox::tracing::add(cbox::tracing::Action::UPDATE_OBJECTS);
+            }
+            auto end = cbox::tracing::writeCount();
+            std::array<cbox::tracing::TraceEvent, 10> events;
+            auto drainCursor = cursor;
+            CHECK(cbox::tracing::drain(drainCursor, events.data(), events.size()) == 10);
+            CHECK(drainCursor == end - cbox::tracing::capacity);
+            CHECK(events[0].action == cbox::tracing::Action::UPDATE_OBJECTS);
+
+            drainCursor = end - 3;
+            CHECK(cbox::tracing::drain(drainCursor, events.data(), events.size()) == 3);
+            CHECK(drainCursor == end - 3);
+            CHECK(events[2].time == testInfo.traceTimestamp);
+        }
+    }
+
     WHEN("A connection sends a noop command, it receives a reply.")
     {
         *in << "000000"; // noop command
@@ -471,6 +1102,10 @@ SCENARIO("A controlbox Box")
         THEN("Writing groups of an inactive object can re-activate it")
         {
             clearStreams();
+            // keep the inactive object alive, so a cached lookup does not expire by itself
+            auto inactive = box.getObject(100).lock();
+            auto lookup = box.makeCboxPtr<LongIntObject>(100);
+            CHECK(!lookup.lock());
 
             *in << "000002" // write object
                 << "6400"   // id 100
@@ -490,6 +1125,7 @@ SCENARIO("A controlbox Box")
                      << "\n";
 
             CHECK(out->str() == expected.str());
+            CHECK(lookup.lock()); // the replaced object is found by the existing lookup
 
             AND_THEN("The stored data will be contain the new groups")
             {
@@ -579,6 +1215,11 @@ SCENARIO("A controlbox Box")
 
         WHEN("An object is given an active groups value that would disable it, it is replaced by InactiveObject")
         {
+            // keep the active object alive, so a cached lookup does not expire by itself
+            auto lookup = box.makeCboxPtr<LongIntObject>(100);
+            auto active = lookup.lock();
+            CHECK(active);
+
             *in << "000002"    // command
                 << "6400"      // id
                 << "00"        // groups of object
@@ -587,6 +1228,7 @@ SCENARIO("A controlbox Box")
             *in << crc(in->str()) << "\n";
             box.hexCommunicate();
             CHECK(box.getObject(100).lock()->typeId() == InactiveObject::staticTypeId());
+            CHECK(!lookup.lock()); // the existing lookup does not return the deactivated object
         }
 
         WHEN("The active groups setting is changed (through the persisted block representing it)")
@@ -1409,3 +2051,54 @@ SCENARIO("A controlbox Box")
         }
     }
 }
+
+// Run with --durations yes to compare the time spent in each section
+TEST_CASE("Benchmark throughput of hex encoding versus binary framing", "[.][benchmark]")
+{
+    ObjectContainer container;
+    for (uint16_t i = 0; i < 50; i++) {
+        container.add(std::make_shared<LongIntVectorObject>(std::initializer_list<LongIntObject>{
+                          LongIntObject(0x01020304 * i), LongIntObject(0xFFFF0000 + i), LongIntObject(i), LongIntObject(0x7C2C3C0A),
+                          LongIntObject(0x11111111 * i), LongIntObject(0), LongIntObject(0x00001000), LongIntObject(0x12345678)}),
+                      0x80, obj_id_t(100 + i));
+    }
+    ArrayEepromAccess<2048> eeprom;
+    EepromObjectStorage storage(eeprom);
+    ObjectFactory factory = {};
+    StringStreamConnectionSource connSource;
+    ConnectionPool connPool = {connSource};
+    Box box(factory, container, storage, connPool);
+
+    auto in = std::make_shared<std::stringstream>();
+    auto out = std::make_shared<std::stringstream>();
+    connSource.add(in, out);
+
+    const uint16_t repetitions = 1000;
+    std::string hexCommand = addCrc("000005") + "\n";
+    std::string binaryCommand = char(binary_framing::start) + binaryFramed(addCrc("000005")) + "\n";
+
+    auto run = [&](const std::string& command) {
+        size_t bytes = 0;
+        for (uint16_t i = 0; i < repetitions; i++) {
+            in->str(command);
+            in->clear();
+            out->str("");
+            out->clear();
+            box.hexCommunicate();
+            bytes += out->str().size();
+        }
+        return bytes;
+    };
+
+    SECTION("Hex encoding")
+    {
+        auto bytes = run(hexCommand);
+        WARN("Hex encoding: " << bytes / repetitions << " bytes per list of 50 objects");
+    }
+
+    SECTION("Binary framing")
+    {
+        auto bytes = run(binaryCommand);
+        WARN("Binary framing: " << bytes / repetitions << " bytes per list of 50 objects");
+    }
+}
@@ -22,6 +22,8 @@
 #include "ObjectContainer.h"
 #include "TestObjects.h"
 #include <catch.hpp>
+#include <functional>
+#include <vector>
 
 using namespace cbox;
 
@@ -146,3 +148,111 @@ SCENARIO("A CboxPtr is a dynamic lookup that checks type compatibility and works
         }
     }
 }
+
+SCENARIO("A CboxPtr caches the interface pointer until the container changes")
+{
+    ObjectContainer objects = {
+        ContainedObject(1, 0xFF, std::make_shared<LongIntObject>(0x11111111)),
+    };
+    objects.add(std::make_shared<NameableLongIntObject>(0x22222222), 0xFF, 100);
+
+    CboxPtr<Nameable> nameablePtr(objects, 100);
+    auto oldPtr = nameablePtr.lock();
+    REQUIRE(oldPtr);
+    CHECK(nameablePtr.lock() == oldPtr);
+
+    WHEN("The object is replaced while a shared pointer to the old object still exists, the new object is returned")
+    {
+        objects.add(std::make_shared<NameableLongIntObject>(0x33333333), 0xFF, 100, true);
+        auto newPtr = nameablePtr.lock();
+        REQUIRE(newPtr);
+        CHECK(newPtr != oldPtr);
+        CHECK(newPtr.get() == static_cast<Nameable*>(std::static_pointer_cast<NameableLongIntObject>(objects.fetch(100).lock()).get()));
+    }
+
+    WHEN("The object is replaced with an object that does not implement the interface, the CboxPtr cannot be locked")
+    {
+        objects.add(std::make_shared<LongIntObject>(0x33333333), 0xFF, 100, true);
+        CHECK(!nameablePtr.lock());
+    }
+
+    WHEN("The CboxPtr is locked as a different type, the interface pointer is looked up again")
+    {
+        auto liPtr = nameablePtr.lock_as<LongIntObject>();
+        REQUIRE(liPtr);
+        CHECK(static_cast<Nameable*>(static_cast<NameableLongIntObject*>(liPtr.get())) == oldPtr.get());
+        CHECK(nameablePtr.lock() == oldPtr);
+    }
+
+    WHEN("Other objects are added or removed, the same object is returned")
+    {
+        objects.add(std::make_shared<LongIntObject>(0x44444444), 0xFF, 101);
+        CHECK(nameablePtr.lock() == oldPtr);
+        objects.remove(101);
+        CHECK(nameablePtr.lock() == oldPtr);
+    }
+}
+
+namespace {
+
+// the lookup done by CboxPtr before the interface pointer was cached, for comparison
+template <class U>
+std::shared_ptr<U>
+uncachedLock(ObjectContainer& objects, std::weak_ptr<Object>& ptr, obj_id_t id)
+{
+    auto sptr = ptr.lock();
+    if (!sptr) {
+        ptr = objects.fetch(id);
+        sptr = ptr.lock();
+    }
+    if (sptr) {
+        if (void* thisPtr = sptr->implements(interfaceId<U>())) {
+            return std::shared_ptr<U>(sptr, static_cast<U*>(thisPtr));
+        }
+    }
+    return std::shared_ptr<U>();
+}
+
+} // end anonymous namespace
+
+// Run with --durations yes to compare the time spent in each section
+TEST_CASE("Benchmark CboxPtr lock in an update loop, cached versus uncached", "[.][benchmark]")
+{
+    ObjectContainer objects;
+    for (uint16_t i = 0; i < 50; i++) {
+        objects.add(std::make_shared<NameableLongIntObject>(i), 0xFF, obj_id_t(100 + i));
+    }
+    const int updates = 200000;
+
+    SECTION("Uncached lookup")
+    {
+        std::vector<std::weak_ptr<Object>> ptrs(50);
+        std::vector<std::function<std::shared_ptr<Nameable>()>> functors;
+        for (uint16_t i = 0; i < 50; i++) {
+            functors.push_back([&objects, &ptr = ptrs[i], i]() {
+                return uncachedLock<Nameable>(objects, ptr, obj_id_t(100 + i));
+            });
+        }
+        size_t found = 0;
+        for (int u = 0; u < updates; u++) {
+            found += functors[u % 50]() ? 1 : 0;
+        }
+        CHECK(found == updates);
+    }
+
+    SECTION("Cached lookup")
+    {
+        std::vector<CboxPtr<Nameable>> ptrs;
+        ptrs.reserve(50);
+        std::vector<std::function<std::shared_ptr<Nameable>()>> functors;
+        for (uint16_t i = 0; i < 50; i++) {
+            ptrs.emplace_back(objects, obj_id_t(100 + i));
+            functors.push_back(ptrs.back().lockFunctor());
+        }
+        size_t found = 0;
+        for (int u = 0; u < updates; u++) {
+            found += functors[u % 50]() ? 1 : 0;
+        }
+        CHECK(found == updates);
+    }
+}
@@ -23,7 +23,9 @@
 #include "DataStream.h"
 #include <catch.hpp>
 #include <cstdio>
+#include <random>
 #include <sstream>
+#include <vector>
 
 using namespace cbox;
 
@@ -198,3 +200,264 @@ SCENARIO("Connections are generated by connection sources and managed by a conne
         }
     }
 }
+
+// A stream that counts how often it is written, like a socket that sends a packet for each write
+class CountingStream {
+public:
+    std::string input;
+    std::string output;
+    int writeCalls = 0;
+
+    size_t write(uint8_t data)
+    {
+        ++writeCalls;
+        output.push_back(char(data));
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t len)
+    {
+        ++writeCalls;
+        output.append(reinterpret_cast<const char*>(data), len);
+        return len;
+    }
+
+    int available() { return int(input.size()); }
+
+    int read()
+    {
+        int c = peek();
+        input.erase(0, 1);
+        return c;
+    }
+
+    int peek() { return input.empty() ? -1 : uint8_t(input[0]); }
+    explicit operator bool() const { return true; }
+    bool status() { return true; }
+};
+
+namespace cbox {
+template <>
+StreamType
+StreamDataIn<CountingStream>::streamTypeImpl()
+{
+    return StreamType::Mock;
+}
+}
+
+class CountingConnection : public StreamConnection<CountingStream> {
+public:
+    CountingConnection()
+        : StreamConnection<CountingStream>(CountingStream())
+    {
+    }
+
+    virtual void stop() override final {}
+};
+
+class CountingConnectionSource : public ConnectionSource {
+public:
+    CountingStream* stream = nullptr;
+
+    virtual std::unique_ptr<Connection> newConnection() override final
+    {
+        if (stream) {
+            return nullptr; // only one connection
+        }
+        auto conn = std::make_unique<CountingConnection>();
+        stream = &conn->get();
+        std::unique_ptr<Connection> retval = std::move(conn);
+        return retval;
+    }
+
+    virtual void start() override final {}
+    virtual void stop() override final {}
+};
+
+SCENARIO("A stream connection buffers its output and writes it to the stream at flush points")
+{
+    CountingConnectionSource source;
+    ConnectionPool pool = {source};
+    pool.updateConnections();
+    REQUIRE(source.stream);
+
+    // the same output written to a string without buffering, to compare against
+    std::stringstream expected;
+    OStreamDataOut expectedOut(expected);
+
+    auto writeList = [](DataOut& dataOut) {
+        EncodedDataOut out(dataOut);
+        out.writeResponseSeparator();
+        out.write(0);
+        for (uint32_t i = 0; i < 100; i++) {
+            out.writeListSeparator();
+            out.put(i);
+            out.put(uint16_t(i * 3));
+            out.write(uint8_t(i));
+        }
+        out.endMessage();
+    };
+
+    source.stream->input = "command\n";
+
+    WHEN("A command with a list of 100 items is processed, the stream is written once per item instead of per character")
+    {
+        pool.process([&writeList](DataIn& in, DataOut& out) {
+            in.spool();
+            writeList(out);
+        });
+        writeList(expectedOut);
+
+        CHECK(source.stream->output == expected.str());
+        CHECK(source.stream->writeCalls == 101);
+    }
+
+    WHEN("A large message without list items is processed, the stream is only written when the buffer is full")
+    {
+        std::vector<uint8_t> data(1000);
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = uint8_t(i);
+        }
+        auto writeData = [&data](DataOut& dataOut) {
+            EncodedDataOut out(dataOut);
+            out.writeBuffer(data.data(), data.size());
+            out.endMessage();
+        };
+        pool.process([&writeData](DataIn& in, DataOut& out) {
+            in.spool();
+            writeData(out);
+        });
+        writeData(expectedOut);
+
+        CHECK(source.stream->output == expected.str());
+        CHECK(source.stream->writeCalls == 2000 / connectionBufferSize + 1);
+    }
+
+    WHEN("A log is written while processing a command, it is written together with the command output")
+    {
+        pool.process([&pool](DataIn& in, DataOut& out) {
+            in.spool();
+            const char log[] = "<log>";
+            pool.logDataOut().writeBuffer(log, 5);
+            out.write('a');
+        });
+        CHECK(source.stream->output == "<log>a");
+        CHECK(source.stream->writeCalls == 1);
+    }
+
+    WHEN("A log is written outside of processing, it is written on the next flush")
+    {
+        const char log[] = "<log>";
+        pool.logDataOut().writeBuffer(log, 5);
+        CHECK(source.stream->writeCalls == 0);
+        pool.logDataOut().flush();
+        CHECK(source.stream->output == "<log>");
+        CHECK(source.stream->writeCalls == 1);
+    }
+
+    WHEN("A log is written outside of processing, it is written when the pool is processed without input")
+    {
+        source.stream->input = "";
+        const char log[] = "<log>";
+        pool.logDataOut().writeBuffer(log, 5);
+        bool handled = false;
+        pool.process([&handled](DataIn&, DataOut&) {
+            handled = true;
+        });
+        CHECK_FALSE(handled);
+        CHECK(source.stream->output == "<log>");
+        CHECK(source.stream->writeCalls == 1);
+    }
+}
+
+SCENARIO("An encoded stream gives the same output when a buffer is written at once or byte by byte")
+{
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<uint8_t> data(2000);
+    for (auto& d : data) {
+        d = uint8_t(byte(gen));
+    }
+
+    for (auto framing : {Framing::Hex, Framing::Binary}) {
+        std::stringstream perByte;
+        std::stringstream buffered;
+        OStreamDataOut perByteStream(perByte);
+        OStreamDataOut bufferedStream(buffered);
+        EncodedDataOut perByteOut(perByteStream, framing);
+        EncodedDataOut bufferedOut(bufferedStream, framing);
+
+        for (auto d : data) {
+            perByteOut.write(d);
+        }
+        CHECK(bufferedOut.writeBuffer(data.data(), data.size()));
+        CHECK(buffered.str() == perByte.str());
+        CHECK(bufferedOut.crc() == perByteOut.crc());
+    }
+}
+
+SCENARIO("A connection pool takes turns between connections and stops starting commands when its time budget is used")
+{
+    StringStreamConnectionSource source;
+    ConnectionPool pool = {source};
+    uint32_t clock = 0;
+    pool.timeBudget(3000, [&clock]() { return clock; });
+
+    auto in1 = std::make_shared<std::stringstream>();
+    auto out1 = std::make_shared<std::stringstream>();
+    auto in2 = std::make_shared<std::stringstream>();
+    auto out2 = std::make_shared<std::stringstream>();
+    source.add(in1, out1);
+    source.add(in2, out2);
+
+    // each command is a line that takes 1 ms to handle
+    std::string order;
+    auto handleLine = [&clock, &order](DataIn& in, DataOut& out) {
+        clock += 1000;
+        order.push_back(char(in.peek()));
+        while (in.hasNext()) {
+            auto c = in.next();
+            out.write(c);
+            if (c == '\n') {
+                break;
+            }
+        }
+    };
+
+    auto stats = [&pool]() {
+        std::vector<ConnectionStats> result;
+        pool.forEach([&result](Connection& conn) { result.push_back(conn.stats()); });
+        return result;
+    };
+
+    *in1 << "a1\na2\na3\n";
+    *in2 << "b1\nb2\n";
+    pool.process(handleLine);
+
+    THEN("The connections are served in turns until the budget is used")
+    {
+        CHECK(order == "aba");
+        CHECK(out1->str() == "a1\na2\n");
+        CHECK(out2->str() == "b1\n");
+        REQUIRE(stats().size() == 2);
+        CHECK(stats()[0].commands == 2);
+        CHECK(stats()[0].micros == 2000);
+        CHECK(stats()[0].queuedBytes != 0);
+        CHECK(stats()[1].commands == 1);
+        CHECK(stats()[1].micros == 1000);
+        CHECK(stats()[1].queuedBytes != 0);
+    }
+
+    THEN("The next call starts with the connection that was not served")
+    {
+        order.clear();
+        pool.process(handleLine);
+        CHECK(order == "ba");
+        CHECK(out1->str() == "a1\na2\na3\n");
+        CHECK(out2->str() == "b1\nb2\n");
+        CHECK(stats()[0].commands == 3);
+        CHECK(stats()[0].queuedBytes == 0);
+        CHECK(stats()[1].commands == 2);
+        CHECK(stats()[1].queuedBytes == 0);
+    }
+}
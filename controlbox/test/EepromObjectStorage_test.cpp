@@ -23,6 +23,9 @@
 #include "TestObjects.h"
 #include <catch.hpp>
 #include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
 
 using namespace cbox;
 
@@ -616,3 +619,117 @@ SCENARIO("Storing and retreiving blocks with EEPROM storage")
         }
     }
 }
+
+namespace {
+
+std::vector<uint8_t>
+readAll(DataIn& in)
+{
+    std::vector<uint8_t> data;
+    while (in.hasNext()) {
+        data.push_back(in.next());
+    }
+    return data;
+}
+
+} // end anonymous namespace
+
+SCENARIO("The in RAM index of EEPROM storage matches a fresh scan of EEPROM after random operations")
+{
+    ArrayEepromAccess<2048> eeprom;
+    EepromObjectStorage storage(eeprom);
+    std::mt19937 rng(1234);
+    std::map<storage_id_t, LongIntVectorObject> stored;
+
+    auto store = [&storage](const storage_id_t& id, const LongIntVectorObject& obj) {
+        return storage.storeObject(id, [&obj](DataOut& out) -> CboxError {
+            return obj.streamPersistedTo(out);
+        });
+    };
+
+    auto checkIndex = [&eeprom, &storage, &stored]() {
+        // a second storage object on the same EEPROM builds its index from scratch
+        EepromObjectStorage fresh(eeprom);
+        CHECK(storage.freeSpace() == fresh.freeSpace());
+        CHECK(storage.continuousFreeSpace() == fresh.continuousFreeSpace());
+
+        std::map<storage_id_t, std::vector<uint8_t>> scanned;
+        auto res = storage.retrieveObjects([&scanned](const storage_id_t& id, RegionDataIn& in) -> CboxError {
+            scanned[id] = readAll(in);
+            return CboxError::OK;
+        });
+        CHECK(res == CboxError::OK);
+        CHECK(scanned.size() == stored.size());
+
+        for (auto& entry : stored) {
+            INFO(entry.first);
+            REQUIRE(scanned.count(entry.first) == 1);
+            std::vector<uint8_t> indexed;
+            std::vector<uint8_t> freshIndexed;
+            CHECK(storage.retrieveObject(entry.first, [&indexed](RegionDataIn& in) -> CboxError {
+                indexed = readAll(in);
+                return CboxError::OK;
+            }) == CboxError::OK);
+            CHECK(fresh.retrieveObject(entry.first, [&freshIndexed](RegionDataIn& in) -> CboxError {
+                freshIndexed = readAll(in);
+                return CboxError::OK;
+            }) == CboxError::OK);
+            CHECK(indexed == scanned[entry.first]);
+            CHECK(freshIndexed == scanned[entry.first]);
+
+            REQUIRE(indexed.size() > 0);
+            LongIntVectorObject received;
+            BufferDataIn withoutCrc(indexed.data(), indexed.size() - 1);
+            received.streamFrom(withoutCrc);
+            CHECK(received == entry.second);
+        }
+    };
+
+    for (int i = 0; i < 2000; i++) {
+        storage_id_t id = 1 + rng() % 60;
+        auto action = rng() % 10;
+        if (action < 7) {
+            LongIntVectorObject obj;
+            obj.values.resize(rng() % 12, LongIntObject(rng()));
+            auto res = store(id, obj);
+            if (res == CboxError::OK) {
+                stored[id] = obj;
+            } else {
+                CHECK(res == CboxError::INSUFFICIENT_PERSISTENT_STORAGE);
+            }
+        } else if (action < 9) {
+            bool found = storage.disposeObject(id, rng() % 2);
+            CHECK(found == (stored.erase(id) == 1));
+        } else {
+            storage.defrag();
+        }
+
+        if (i % 50 == 0) {
+            checkIndex();
+        }
+    }
+    checkIndex();
+}
+
+// Run with --durations yes to compare the time spent in each section
+TEST_CASE("Benchmark EEPROM storage store latency versus object count", "[.][benchmark]")
+{
+    for (uint16_t count : {25, 50, 100}) {
+        DYNAMIC_SECTION("Rewriting objects with " << count << " objects in storage")
+        {
+            ArrayEepromAccess<2048> eeprom;
+            EepromObjectStorage storage(eeprom);
+            LongIntObject obj(0x11111111);
+            auto handler = [&obj](DataOut& out) -> CboxError {
+                return obj.streamPersistedTo(out);
+            };
+            for (storage_id_t id = 1; id <= count; id++) {
+                REQUIRE(storage.storeObject(id, handler) == CboxError::OK);
+            }
+            for (uint16_t i = 0; i < 1000; i++) {
+                obj.value(i);
+                storage.storeObject(count - (i % count), handler);
+            }
+        }
+    }
+}
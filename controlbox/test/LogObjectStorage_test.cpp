@@ -0,0 +1,513 @@
+/*
+ * Copyright 2020 BrewPi
+ *
+ * This file is part of BrewPi.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ArrayEepromAccess.h"
+#include "EepromObjectStorage.h"
+#include "LogObjectStorage.h"
+#include "Object.h"
+#include "TestObjects.h"
+#include <algorithm>
+#include <catch.hpp>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace cbox;
+
+namespace {
+
+/**
+ * EEPROM simulator that counts writes per byte, to compare wear and store latency.
+ * It can also simulate losing power by ignoring all writes after a number of bytes.
+ */
+class WearCountingEepromAccess : public EepromAccess {
+public:
+    WearCountingEepromAccess()
+        : writes(eeprom.length(), 0)
+    {
+    }
+
+    virtual uint8_t readByte(uint16_t offset) const override final
+    {
+        return eeprom.readByte(offset);
+    }
+
+    virtual void writeByte(uint16_t offset, uint8_t value) override final
+    {
+        if (powerBudget == 0) {
+            return;
+        }
+        if (powerBudget > 0) {
+            --powerBudget;
+        }
+        ++writes[offset];
+        ++bytesWritten;
+        eeprom.writeByte(offset, value);
+    }
+
+    virtual void readBlock(uint8_t* target, uint16_t offset, uint16_t size) const override final
+    {
+        eeprom.readBlock(target, offset, size);
+    }
+
+    virtual void writeBlock(uint16_t target, const uint8_t* source, uint16_t size) override final
+    {
+        for (uint16_t i = 0; i < size; i++) {
+            writeByte(target + i, source[i]);
+        }
+    }
+
+    virtual uint16_t length() const override final
+    {
+        return eeprom.length();
+    }
+
+    virtual void clear() override final
+    {
+        for (uint16_t i = 0; i < length(); i++) {
+            writeByte(i, 0);
+        }
+    }
+
+    uint32_t maxWrites() const
+    {
+        return *std::max_element(writes.begin(), writes.end());
+    }
+
+    ArrayEepromAccess<2048> eeprom;
+    std::vector<uint32_t> writes;
+    uint32_t bytesWritten = 0;
+    int32_t powerBudget = -1; // negative for unlimited
+};
+
+std::vector<uint8_t>
+readAll(DataIn& in)
+{
+    std::vector<uint8_t> data;
+    while (in.hasNext()) {
+        data.push_back(in.next());
+    }
+    return data;
+}
+
+template <class T>
+CboxError
+store(ObjectStorage& storage, const storage_id_t& id, const T& obj)
+{
+    return storage.storeObject(id, [&obj](DataOut& out) -> CboxError {
+        return obj.streamPersistedTo(out);
+    });
+}
+
+template <class T>
+CboxError
+retrieve(ObjectStorage& storage, const storage_id_t& id, T& obj)
+{
+    return storage.retrieveObject(id, [&obj](RegionDataIn& in) -> CboxError {
+        RegionDataIn withoutCrc(in, in.available() - 1);
+        return obj.streamFrom(withoutCrc);
+    });
+}
+
+} // end anonymous namespace
+
+SCENARIO("Storing and retrieving objects with log structured storage")
+{
+    ArrayEepromAccess<2048> eeprom;
+    LogObjectStorage storage(eeprom);
+
+    THEN("All pages except the first one are free initially")
+    {
+        CHECK(storage.freePageCount() == LogObjectStorage::pageCount - 1);
+        CHECK(storage.liveBytes() == 0);
+    }
+
+    WHEN("An object is stored")
+    {
+        LongIntObject obj(0x33333333);
+        CHECK(store(storage, 1, obj) == CboxError::OK);
+
+        THEN("It takes 4 bytes of data, 1 byte CRC and 5 bytes record header")
+        {
+            CHECK(storage.liveBytes() == 10);
+        }
+
+        THEN("It can be retrieved, including a valid CRC over id and data")
+        {
+            LongIntObject received;
+            CHECK(retrieve(storage, 1, received) == CboxError::OK);
+            CHECK(received == obj);
+
+            CHECK(storage.retrieveObject(1, [](RegionDataIn& in) -> CboxError {
+                BlackholeDataOut hole;
+                CrcDataOut crcCalculator(hole);
+                crcCalculator.put(storage_id_t(1));
+                while (in.hasNext()) {
+                    crcCalculator.write(in.next());
+                }
+                CHECK(crcCalculator.crc() == 0);
+                return CboxError::OK;
+            }) == CboxError::OK);
+        }
+
+        AND_WHEN("It is stored again with a different value")
+        {
+            obj = LongIntObject(0x44444444);
+            CHECK(store(storage, 1, obj) == CboxError::OK);
+
+            THEN("The new value is retrieved and the old record no longer counts as live")
+            {
+                LongIntObject received;
+                CHECK(retrieve(storage, 1, received) == CboxError::OK);
+                CHECK(received == obj);
+                CHECK(storage.liveBytes() == 10);
+            }
+
+            THEN("A new storage instance on the same EEPROM rebuilds the same index")
+            {
+                LogObjectStorage rebooted(eeprom);
+                LongIntObject received;
+                CHECK(retrieve(rebooted, 1, received) == CboxError::OK);
+                CHECK(received == obj);
+                CHECK(rebooted.liveBytes() == 10);
+            }
+        }
+
+        AND_WHEN("It is disposed")
+        {
+            CHECK(storage.disposeObject(1));
+
+            THEN("It cannot be retrieved, also not after rebuilding the index")
+            {
+                LongIntObject received;
+                CHECK(retrieve(storage, 1, received) == CboxError::PERSISTED_OBJECT_NOT_FOUND);
+                LogObjectStorage rebooted(eeprom);
+                CHECK(retrieve(rebooted, 1, received) == CboxError::PERSISTED_OBJECT_NOT_FOUND);
+                CHECK(rebooted.liveBytes() == 0);
+            }
+
+            THEN("Disposing it again returns false")
+            {
+                CHECK_FALSE(storage.disposeObject(1));
+            }
+        }
+
+        AND_WHEN("Storage is cleared")
+        {
+            storage.clear();
+            LongIntObject received;
+            CHECK(retrieve(storage, 1, received) == CboxError::PERSISTED_OBJECT_NOT_FOUND);
+            CHECK(storage.freePageCount() == LogObjectStorage::pageCount - 1);
+        }
+    }
+
+    WHEN("Multiple objects are stored, they are all retrieved in order of id")
+    {
+        for (storage_id_t id : {5, 3, 9, 1}) {
+            CHECK(store(storage, id, LongIntObject(id)) == CboxError::OK);
+        }
+
+        std::vector<storage_id_t> ids;
+        CHECK(storage.retrieveObjects([&ids](const storage_id_t& id, RegionDataIn& in) -> CboxError {
+            LongIntObject received;
+            RegionDataIn withoutCrc(in, in.available() - 1);
+            received.streamFrom(withoutCrc);
+            CHECK(received.value() == id);
+            ids.push_back(id);
+            return CboxError::OK;
+        }) == CboxError::OK);
+        CHECK(ids == std::vector<storage_id_t>{1, 3, 5, 9});
+    }
+
+    WHEN("An object is stored with id 0, INVALID_OBJECT_ID is returned")
+    {
+        CHECK(store(storage, 0, LongIntObject(1)) == CboxError::INVALID_OBJECT_ID);
+    }
+
+    WHEN("An object does not need persistence, nothing is stored")
+    {
+        CHECK(storage.storeObject(1, [](DataOut&) { return CboxError::PERSISTING_NOT_NEEDED; }) == CboxError::OK);
+        CHECK(storage.liveBytes() == 0);
+    }
+
+    WHEN("The handler returns an error, the previous version remains")
+    {
+        CHECK(store(storage, 1, LongIntObject(1)) == CboxError::OK);
+        CHECK(storage.storeObject(1, [](DataOut&) { return CboxError::OUTPUT_STREAM_WRITE_ERROR; })
+              == CboxError::OUTPUT_STREAM_WRITE_ERROR);
+        LongIntObject received;
+        CHECK(retrieve(storage, 1, received) == CboxError::OK);
+        CHECK(received.value() == 1);
+    }
+
+    WHEN("An object is bigger than a page, INSUFFICIENT_PERSISTENT_STORAGE is returned")
+    {
+        LongIntVectorObject big;
+        big.values.resize(LogObjectStorage::pageSize / 4, LongIntObject(1));
+        CHECK(store(storage, 1, big) == CboxError::INSUFFICIENT_PERSISTENT_STORAGE);
+    }
+
+    WHEN("An object takes exactly the 243 bytes that fit in a page after the headers, it is stored")
+    {
+        CHECK(uint16_t(LogObjectStorage::pageSize) == 252);
+        CHECK(LogObjectStorage::capacity() == 7 * 248);
+
+        LongIntVectorObject largest;
+        largest.values.resize(60, LongIntObject(1)); // 2 + 60 * 4 bytes of data and 1 byte CRC
+        CHECK(store(storage, 1, largest) == CboxError::OK);
+        CHECK(storage.liveBytes() == 5 + 243);
+
+        largest.values.resize(61, LongIntObject(1));
+        CHECK(store(storage, 2, largest) == CboxError::INSUFFICIENT_PERSISTENT_STORAGE);
+    }
+
+    WHEN("Objects are stored until storage is full")
+    {
+        LongIntVectorObject obj;
+        obj.values.resize(20, LongIntObject(0x11111111));
+        storage_id_t id = 1;
+        while (store(storage, id, obj) == CboxError::OK) {
+            ++id;
+        }
+
+        THEN("All pages except the reserve page are used, with less than a record of unused space per page")
+        {
+            CHECK(storage.freePageCount() == 1);
+            CHECK(storage.liveBytes() > LogObjectStorage::capacity() - (LogObjectStorage::pageCount - 1) * 88);
+        }
+
+        THEN("Storing a new version of an object fails and the old version remains")
+        {
+            LongIntVectorObject changed = obj;
+            changed.values[0] = LongIntObject(0x22222222);
+            CHECK(store(storage, 1, changed) == CboxError::INSUFFICIENT_PERSISTENT_STORAGE);
+            LongIntVectorObject received;
+            CHECK(retrieve(storage, 1, received) == CboxError::OK);
+            CHECK(received == obj);
+        }
+
+        AND_WHEN("An object is disposed")
+        {
+            CHECK(storage.disposeObject(1));
+
+            THEN("The other objects can be rewritten and are intact after a rebuild")
+            {
+                obj.values[0] = LongIntObject(0x22222222);
+                for (storage_id_t i = 2; i < id; i++) {
+                    CHECK(store(storage, i, obj) == CboxError::OK);
+                }
+                LogObjectStorage rebooted(eeprom);
+                for (storage_id_t i = 2; i < id; i++) {
+                    LongIntVectorObject received;
+                    CHECK(retrieve(rebooted, i, received) == CboxError::OK);
+                    CHECK(received == obj);
+                }
+            }
+        }
+    }
+
+    WHEN("The EEPROM was formatted by EepromObjectStorage")
+    {
+        ArrayEepromAccess<2048> other;
+        {
+            EepromObjectStorage old(other);
+            CHECK(store(old, 1, LongIntObject(1)) == CboxError::OK);
+        }
+
+        THEN("Log storage formats it")
+        {
+            LogObjectStorage log(other);
+            LongIntObject received;
+            CHECK(retrieve(log, 1, received) == CboxError::PERSISTED_OBJECT_NOT_FOUND);
+            CHECK(log.freePageCount() == LogObjectStorage::pageCount - 1);
+        }
+    }
+}
+
+SCENARIO("The index of log structured storage matches a replay of the log after random operations")
+{
+    ArrayEepromAccess<2048> eeprom;
+    LogObjectStorage storage(eeprom);
+    std::mt19937 rng(1234);
+    std::map<storage_id_t, LongIntVectorObject> stored;
+
+    auto checkIndex = [&eeprom, &storage, &stored]() {
+        LogObjectStorage rebooted(eeprom);
+        CHECK(storage.liveBytes() == rebooted.liveBytes());
+        CHECK(storage.freePageCount() == rebooted.freePageCount());
+
+        std::map<storage_id_t, std::vector<uint8_t>> scanned;
+        CHECK(rebooted.retrieveObjects([&scanned](const storage_id_t& id, RegionDataIn& in) -> CboxError {
+            scanned[id] = readAll(in);
+            return CboxError::OK;
+        }) == CboxError::OK);
+        CHECK(scanned.size() == stored.size());
+
+        for (auto& entry : stored) {
+            INFO(entry.first);
+            REQUIRE(scanned.count(entry.first) == 1);
+            std::vector<uint8_t> indexed;
+            CHECK(storage.retrieveObject(entry.first, [&indexed](RegionDataIn& in) -> CboxError {
+                indexed = readAll(in);
+                return CboxError::OK;
+            }) == CboxError::OK);
+            CHECK(indexed == scanned[entry.first]);
+
+            REQUIRE(indexed.size() > 0);
+            LongIntVectorObject received;
+            BufferDataIn withoutCrc(indexed.data(), indexed.size() - 1);
+            received.streamFrom(withoutCrc);
+            CHECK(received == entry.second);
+        }
+    };
+
+    for (int i = 0; i < 3000; i++) {
+        storage_id_t id = 1 + rng() % 60;
+        auto action = rng() % 10;
+        if (action < 7) {
+            LongIntVectorObject obj;
+            obj.values.resize(rng() % 12, LongIntObject(rng()));
+            auto res = store(storage, id, obj);
+            if (res == CboxError::OK) {
+                stored[id] = obj;
+            } else {
+                CHECK(res == CboxError::INSUFFICIENT_PERSISTENT_STORAGE);
+            }
+        } else if (action < 9) {
+            bool found = storage.disposeObject(id);
+            CHECK(found == (stored.erase(id) == 1));
+        } else {
+            storage.compact();
+        }
+
+        if (i % 50 == 0) {
+            checkIndex();
+        }
+    }
+    checkIndex();
+}
+
+SCENARIO("Log structured storage survives losing power at any point during a store")
+{
+    WearCountingEepromAccess eeprom;
+    LongIntVectorObject first;
+    first.values.resize(8, LongIntObject(0x11111111));
+    LongIntVectorObject second;
+    second.values.resize(8, LongIntObject(0x22222222));
+
+    {
+        LogObjectStorage storage(eeprom);
+        // fill storage until the next store has to reclaim a page
+        for (storage_id_t id = 1; id <= 40; id++) {
+            REQUIRE(store(storage, id, first) == CboxError::OK);
+        }
+    }
+
+    // find out how many bytes a store of every object writes, then lose power after each possible number of bytes.
+    // Only the first store and the first stores that reclaim a page are interrupted, the others write the same sequence.
+    uint16_t reclaimingStores = 0;
+    for (storage_id_t id = 1; id <= 40; id++) {
+        auto saved = eeprom.eeprom;
+        LogObjectStorage storage(eeprom);
+        uint32_t before = eeprom.bytesWritten;
+        REQUIRE(store(storage, id, second) == CboxError::OK);
+        uint32_t storeBytes = eeprom.bytesWritten - before;
+        if (id > 1 && (storeBytes < 2 * 40 || reclaimingStores > 1)) {
+            continue;
+        }
+        ++reclaimingStores;
+
+        for (uint32_t budget = 0; budget < storeBytes; budget++) {
+            eeprom.eeprom = saved;
+            LogObjectStorage interrupted(eeprom);
+            eeprom.powerBudget = budget;
+            store(interrupted, id, second);
+            eeprom.powerBudget = -1;
+
+            LogObjectStorage rebooted(eeprom);
+            bool intact = true;
+            for (storage_id_t other = 1; other <= 40; other++) {
+                LongIntVectorObject received;
+                intact = intact && retrieve(rebooted, other, received) == CboxError::OK;
+                if (other < id) {
+                    intact = intact && received == second;
+                } else if (other > id) {
+                    intact = intact && received == first;
+                } else {
+                    intact = intact && (received == first || received == second);
+                }
+            }
+            INFO("id " << id << ", budget " << budget);
+            CHECK(intact);
+        }
+        eeprom.eeprom = saved;
+        LogObjectStorage completed(eeprom);
+        REQUIRE(store(completed, id, second) == CboxError::OK);
+    }
+    CHECK(reclaimingStores > 1);
+}
+
+SCENARIO("Log structured storage spreads wear and has bounded store latency compared to EEPROM storage")
+{
+    // A typical setup: 30 objects that are written once, a setpoint that is written often
+    const uint16_t rewrites = 2000;
+    LongIntVectorObject config;
+    config.values.resize(6, LongIntObject(0x11111111));
+
+    auto simulate = [&](ObjectStorage& storage, WearCountingEepromAccess& eeprom, uint32_t& maxStoreBytes) {
+        for (storage_id_t id = 1; id <= 30; id++) {
+            REQUIRE(store(storage, id, config) == CboxError::OK);
+        }
+        maxStoreBytes = 0;
+        for (uint16_t i = 0; i < rewrites; i++) {
+            uint32_t before = eeprom.bytesWritten;
+            REQUIRE(store(storage, 31, LongIntObject(i)) == CboxError::OK);
+            maxStoreBytes = std::max(maxStoreBytes, eeprom.bytesWritten - before);
+            storage.compact();
+        }
+    };
+
+    WearCountingEepromAccess inPlaceEeprom;
+    EepromObjectStorage inPlace(inPlaceEeprom);
+    uint32_t inPlaceMaxStoreBytes;
+    simulate(inPlace, inPlaceEeprom, inPlaceMaxStoreBytes);
+
+    WearCountingEepromAccess logEeprom;
+    LogObjectStorage log(logEeprom);
+    uint32_t logMaxStoreBytes;
+    simulate(log, logEeprom, logMaxStoreBytes);
+
+    THEN("In place storage writes the same bytes on every store")
+    {
+        CHECK(inPlaceEeprom.maxWrites() >= rewrites);
+    }
+
+    THEN("Log storage wears the most written byte at least 10 times less")
+    {
+        INFO("in place: " << inPlaceEeprom.maxWrites() << ", log: " << logEeprom.maxWrites());
+        CHECK(logEeprom.maxWrites() * 10 < inPlaceEeprom.maxWrites());
+    }
+
+    THEN("When compact() is called regularly, a store never has to copy a page")
+    {
+        INFO("in place: " << inPlaceMaxStoreBytes << ", log: " << logMaxStoreBytes);
+        // 4 bytes data + CRC + record header + end marker, and opening a new page: end marker + sequence number
+        CHECK(logMaxStoreBytes <= 4 + 1 + 5 + 1 + 1 + 4);
+    }
+}
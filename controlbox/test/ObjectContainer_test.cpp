@@ -239,3 +239,270 @@ SCENARIO("A container with system objects passed in the initializer list")
         CHECK(obj_id_t(100) == objects.add(std::make_unique<LongIntObject>(0x33333333), 0xFF)); // will get start ID (100)
     }
 }
+
+SCENARIO("The container only updates objects that are due, equivalent to updating all objects in a linear walk")
+{
+    ObjectContainer container;
+    std::vector<ContainedObject> reference;
+    const uint16_t intervals[] = {10, 100, 250, 1000, 1000, 1500, 5000};
+
+    for (uint16_t i = 0; i < 50; i++) {
+        auto interval = intervals[i % (sizeof(intervals) / sizeof(intervals[0]))];
+        container.add(std::make_shared<UpdateCounter>(interval), 0xFF, obj_id_t(100 + i));
+        reference.emplace_back(obj_id_t(100 + i), 0xFF, std::make_shared<UpdateCounter>(interval));
+    }
+    container.add(std::make_shared<LongIntObject>(0x11111111), 0xFF, obj_id_t(200)); // never updated after the first time
+    reference.emplace_back(obj_id_t(200), 0xFF, std::make_shared<LongIntObject>(0x11111111));
+
+    auto checkCounts = [&container, &reference]() {
+        for (auto& ref : reference) {
+            auto obj = container.fetch(ref.id()).lock();
+            auto refObj = ref.object();
+            REQUIRE(obj);
+            REQUIRE(obj->typeId() == refObj->typeId());
+            if (obj->typeId() == UpdateCounter::staticTypeId()) {
+                INFO(ref.id());
+                CHECK(static_cast<UpdateCounter*>(obj.get())->count() == static_cast<UpdateCounter*>(refObj.get())->count());
+            }
+        }
+    };
+
+    auto run = [&container, &reference](update_t from, update_t duration, update_t step) {
+        update_t now = from;
+        for (update_t elapsed = 0; elapsed < duration; elapsed += step, now += step) {
+            container.update(now);
+            for (auto& ref : reference) {
+                ref.update(now);
+            }
+        }
+        return now;
+    };
+
+    WHEN("Time advances in steps of 1 ms")
+    {
+        run(0, 20000, 1);
+        checkCounts();
+    }
+
+    WHEN("Time advances in irregular steps")
+    {
+        run(0, 20000, 7);
+        run(20000, 20000, 333);
+        checkCounts();
+    }
+
+    WHEN("Time overflows")
+    {
+        update_t start = std::numeric_limits<update_t>::max() - 10000;
+        for (auto& ref : reference) {
+            ref.forcedUpdate(start);
+        }
+        container.forcedUpdate(start);
+        run(start, 20000, 3);
+        checkCounts();
+    }
+
+    WHEN("Objects are updated individually and removed in between updates")
+    {
+        auto now = run(0, 5000, 5);
+        for (obj_id_t id = 100; id < 150; id = id + 7) {
+            container.forcedUpdate(*container.fetchContained(id), now);
+            reference[id - 100].forcedUpdate(now);
+        }
+        container.remove(105);
+        reference.erase(reference.begin() + 5);
+        container.add(std::make_shared<UpdateCounter>(500), 0xFF, obj_id_t(105));
+        reference.emplace(reference.begin() + 5, obj_id_t(105), 0xFF, std::make_shared<UpdateCounter>(500));
+
+        run(now, 20000, 5);
+        checkCounts();
+    }
+}
+
+namespace {
+
+// records the order in which objects are updated and reports configurable links
+class LinkedObject : public ObjectBase<1010> {
+public:
+    std::vector<obj_id_t>& log;
+    obj_id_t self;
+    update_t interval;
+    obj_id_t input;
+    obj_id_t output;
+    bool newOutput = true; // whether an update produces new data for linked objects
+    std::vector<obj_id_t>* pulledLog = nullptr;
+
+    LinkedObject(std::vector<obj_id_t>& log_, obj_id_t self_, update_t interval_, obj_id_t input_ = 0, obj_id_t output_ = 0)
+        : log(log_)
+        , self(self_)
+        , interval(interval_)
+        , input(input_)
+        , output(output_)
+    {
+    }
+    virtual ~LinkedObject() = default;
+
+    virtual CboxError streamTo(DataOut&) const override final
+    {
+        return CboxError::OK;
+    }
+
+    virtual CboxError streamFrom(DataIn&) override final
+    {
+        return CboxError::OK;
+    }
+
+    virtual CboxError streamPersistedTo(DataOut&) const override final
+    {
+        return CboxError::OK;
+    }
+
+    virtual update_t update(const update_t& now) override final
+    {
+        log.push_back(self);
+        return now + interval;
+    }
+
+    virtual update_t pulledUpdate(const update_t& now) override final
+    {
+        if (pulledLog) {
+            pulledLog->push_back(self);
+        }
+        return update(now);
+    }
+
+    virtual bool hasNewOutput() const override final
+    {
+        return newOutput;
+    }
+
+    virtual void forEachLink(const std::function<void(const obj_id_t&, LinkType)>& func) const override final
+    {
+        func(input, LinkType::Input);
+        func(output, LinkType::Output);
+    }
+};
+
+} // end anonymous namespace
+
+SCENARIO("Linked objects are updated in order of their links, and dependents of new output are updated in the same pass")
+{
+    ObjectContainer container;
+    std::vector<obj_id_t> log;
+
+    // sensor -> pair -> pid -> pwm, with ids that do not match the order of the chain
+    // the pid reports the pair as input and the pwm as output
+    container.add(std::make_shared<LinkedObject>(log, 104, 1000), 0xFF, obj_id_t(104));                  // sensor
+    container.add(std::make_shared<LinkedObject>(log, 103, 5000, 104), 0xFF, obj_id_t(103));             // pair
+    container.add(std::make_shared<LinkedObject>(log, 101, 5000, 103, 102), 0xFF, obj_id_t(101));       // pid
+    container.add(std::make_shared<LinkedObject>(log, 102, 5000), 0xFF, obj_id_t(102));                  // pwm
+    container.add(std::make_shared<LinkedObject>(log, 100, 5000), 0xFF, obj_id_t(100));                  // unlinked
+
+    container.update(0);
+    CHECK(log == std::vector<obj_id_t>{100, 104, 103, 101, 102});
+
+    WHEN("Only the first object in the chain is due, the rest of the chain is updated in the same pass")
+    {
+        log.clear();
+        container.update(1000);
+        CHECK(log == std::vector<obj_id_t>{104, 103, 101, 102});
+
+        AND_THEN("The next update of the dependents is scheduled from the pass they were updated in")
+        {
+            CHECK(container.fetchContained(103)->nextUpdateTime() == 6000);
+            CHECK(container.fetchContained(100)->nextUpdateTime() == 5000);
+        }
+    }
+
+    WHEN("An object in the chain has no new output, its dependents are not pulled into the pass")
+    {
+        auto pair = std::static_pointer_cast<LinkedObject>(container.fetch(103).lock());
+        pair->newOutput = false;
+        log.clear();
+        container.update(1000);
+        CHECK(log == std::vector<obj_id_t>{104, 103});
+    }
+
+    WHEN("Dependents are pulled into the pass, they get a pulled update instead of a normal update")
+    {
+        std::vector<obj_id_t> pulled;
+        for (auto id : {101, 102, 103, 104}) {
+            std::static_pointer_cast<LinkedObject>(container.fetch(obj_id_t(id)).lock())->pulledLog = &pulled;
+        }
+        container.update(1000);
+        CHECK(pulled == std::vector<obj_id_t>{103, 101, 102});
+    }
+
+    WHEN("An object in the chain is removed, its dependents are not updated with the first object")
+    {
+        container.remove(103);
+        log.clear();
+        container.update(1000);
+        CHECK(log == std::vector<obj_id_t>{104});
+    }
+
+    WHEN("The links of an object change, they are used after the links are refreshed")
+    {
+        auto pair = std::static_pointer_cast<LinkedObject>(container.fetch(103).lock());
+        pair->input = 0;
+        container.refreshLinks(103);
+        log.clear();
+        container.update(1000);
+        CHECK(log == std::vector<obj_id_t>{104});
+    }
+
+    WHEN("Objects link to each other in a cycle, they are updated once per pass")
+    {
+        container.add(std::make_shared<LinkedObject>(log, 110, 1000, 111), 0xFF, obj_id_t(110));
+        container.add(std::make_shared<LinkedObject>(log, 111, 1000, 110), 0xFF, obj_id_t(111));
+        container.update(1);
+        log.clear();
+        container.update(1001);
+        CHECK(std::count(log.begin(), log.end(), obj_id_t(110)) == 1);
+        CHECK(std::count(log.begin(), log.end(), obj_id_t(111)) == 1);
+    }
+}
+
+namespace {
+
+// fills a container with counter objects with typical update intervals
+void
+addBenchmarkObjects(ObjectContainer& container, std::vector<ContainedObject>& linear, uint16_t count)
+{
+    const uint16_t intervals[] = {100, 1000, 1000, 1000, 2000, 5000};
+    for (uint16_t i = 0; i < count; i++) {
+        auto interval = intervals[i % (sizeof(intervals) / sizeof(intervals[0]))];
+        container.add(std::make_shared<UpdateCounter>(interval), 0xFF, obj_id_t(100 + i));
+        linear.emplace_back(obj_id_t(100 + i), 0xFF, std::make_shared<UpdateCounter>(interval));
+    }
+}
+
+const update_t benchmarkDuration = 10000; // simulate 10 seconds with an update every 1 ms
+
+} // end anonymous namespace
+
+// Run with --durations yes to compare the time spent in each section
+TEST_CASE("Benchmark update loop cost, scheduled versus linear walk", "[.][benchmark]")
+{
+    for (uint16_t count : {50, 200, 1000}) {
+        ObjectContainer container;
+        std::vector<ContainedObject> linear;
+        addBenchmarkObjects(container, linear, count);
+
+        DYNAMIC_SECTION("Linear walk with " << count << " objects")
+        {
+            for (update_t now = 0; now < benchmarkDuration; ++now) {
+                for (auto& cobj : linear) {
+                    cobj.update(now);
+                }
+            }
+        }
+
+        DYNAMIC_SECTION("Scheduled update with " << count << " objects")
+        {
+            for (update_t now = 0; now < benchmarkDuration; ++now) {
+                container.update(now);
+            }
+        }
+    }
+}
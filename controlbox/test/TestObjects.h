@@ -174,8 +174,8 @@ private:
     uint16_t _count;    // not writable
 
 public:
-    UpdateCounter()
-        : _interval(1000)
+    UpdateCounter(uint16_t interval = 1000)
+        : _interval(interval)
         , _count(0)
     {
     }
@@ -4,6 +4,7 @@
 #include "CboxError.h"
 #include "Connections.h"
 #include "DataStream.h"
+#include "Profiling.h"
 #include "Tracing.h"
 #include "testinfo.h"
 #include <catch.hpp>
@@ -22,6 +23,23 @@ connectionStarted(DataOut& out)
 {
 }
 
+namespace tracing {
+    // fake clock that advances 1 us for each traced event
+    uint32_t timestamp()
+    {
+        return ++testInfo.traceTimestamp;
+    }
+}
+
+namespace profiling {
+    // fake clock that advances 10 us each time it is read, so each profiled call takes 10 us
+    uint32_t micros()
+    {
+        testInfo.profilingMicros += 10;
+        return testInfo.profilingMicros;
+    }
+}
+
 bool
 applicationCommand(uint8_t cmdId, DataIn& in, EncodedDataOut& out)
 {
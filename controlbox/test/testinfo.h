@@ -1,7 +1,11 @@
 #pragma once
 
+#include <cstdint>
+
 struct TestInfo {
     int rebootCount = 0;
+    uint32_t profilingMicros = 0;
+    uint32_t traceTimestamp = 0;
 };
 
 extern TestInfo testInfo;
@@ -59,8 +59,18 @@ private:
     bool m_enabled = true;
 
 #if PLATFORM_ID != PLATFORM_GCC
-    uint8_t timerFuncId = 0;
-    duration_millis_t m_fastPwmElapsed = 0;
+    // channel of the shared PwmScheduler, 0 when slow PWM is used
+    uint8_t m_fastPwmChannel = 0;
+
+    static constexpr duration_micros_t fastPwmPeriod()
+    {
+        return 10000;
+    }
+
+    duration_micros_t fastPwmDutyTime() const
+    {
+        return uint64_t(m_dutySetting * fastPwmPeriod()) / 100;
+    }
 #endif
 
 public:
@@ -122,9 +132,10 @@ public:
     update_t fastUpdate(const update_t& now);
 
     /**
-    When the period is less than 1000ms, switch to timer interrupt based tasks
+    When the period is less than 1000ms, the edges are generated by the PwmScheduler that is shared by all fast PWM actuators.
+    It calls this function from the timer interrupt at each edge.
     */
-    void timerTask();
+    void fastPwmEdge(State state);
 
     void manageTimerTask();
 #endif
@@ -45,7 +45,7 @@ class DS18B20 final : public TempSensor, public OneWireDevice {
             return data[i];
         }
 
-        bool valid()
+        bool valid() const
         {
             return OneWireCrc8(data, 8) == data[8];
         }
@@ -58,6 +58,8 @@ public:
 private:
     temp_t m_calibrationOffset;
     temp_t m_cachedValue = 0;
+    uint16_t m_lastConversion = 0; // conversion sequence of the bus when the scratchpad was last read
+    bool m_retried = false;        // the queued scratchpad read is a retry after a CRC error
 
 public:
     /**
@@ -85,7 +87,14 @@ public:
     }
 
     virtual temp_t value() const override final; // return cached value
-    void update();                               // read from hardware sensor
+
+    /**
+     * Reads the result of the last conversion from the hardware sensor.
+     * When the bus starts conversions for all sensors, the scratchpad is only read once per bus conversion.
+     * That read is queued on the bus and can finish in a later update, so the update does not wait for the bus.
+     * Otherwise, the sensor starts its own next conversion after reading.
+     */
+    void update();
 
     void setCalibration(temp_t const& calib)
     {
@@ -108,6 +117,13 @@ private:
 	 */
     temp_t readAndConstrainTemp();
 
+    // Constrains a raw reading to the range of the temperature type and updates the connected state
+    temp_t constrainTemp(int32_t tempRaw);
+
+    void submitScratchPadRead();
+
+    void processScratchPadRead();
+
     bool readScratchPad(ScratchPad& scratchPad);
 
     void writeScratchPad(const ScratchPad& scratchPad, bool copyToEeprom);
@@ -118,5 +134,5 @@ private:
 
     void startConversion();
 
-    int16_t getRawTemp();
+    int16_t getRawTemp(const ScratchPad& scratchPad);
 };
@@ -28,6 +28,7 @@ private:
     uint8_t scratchpad[9];
     uint8_t eeprom[3];
     bool parasite = false;
+    uint32_t conversions = 0;
 
 public:
     static constexpr uint8_t family_code{0x28};
@@ -80,6 +81,7 @@ public:
         } break;
 
         case 0x44: // CONVERT
+            ++conversions;
             break;
         default:
             break;
@@ -94,6 +96,11 @@ public:
         scratchpad[1] = (int8_t)(raw >> 8);
         scratchpad[8] = OneWireCrc8(scratchpad, 8);
     }
+    uint32_t conversionCount() const
+    {
+        return conversions;
+    }
+
     temp_t getTemperature() const
     {
         int16_t rawTemperature = (((int16_t)scratchpad[1]) << 8) | scratchpad[0];
@@ -65,6 +65,10 @@ public:
 
     static constexpr uint8_t familyCode{0x29};
 
+    /**
+     * Reads the PIO registers and writes the latches when they differ from the desired state.
+     * The read is queued on the bus. When the bus is slow, the result is processed in the next update.
+     */
     bool update();
     bool writeNeeded() const;
 
@@ -77,4 +81,7 @@ public:
     {
         return false;
     }
+
+private:
+    bool processRead();
 };
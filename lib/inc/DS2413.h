@@ -62,6 +62,7 @@ public:
     /**
      * Periodic update to make sure the cache is valid.
      * Performs a simultaneous read of both channels and saves value to the cache.
+     * The read is queued on the bus. When the bus is slow, the result is processed in the next update.
      * When read fails, prints a warning that the DS2413 is disconnected
      *
      * @return					true on successful communication
@@ -84,4 +85,6 @@ public:
 
 private:
     bool processStatus(uint8_t data);
+
+    bool processRead();
 };
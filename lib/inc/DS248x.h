@@ -98,9 +98,16 @@ public:
     // Returns – The DS248X status byte result from the triplet command
     virtual uint8_t search_triplet(bool search_direction) override final;
 
+    // Issue the 1-Wire command over I2C without waiting for the DS248X to finish it
+    virtual bool start(Operation op, uint8_t value) override final;
+
+    // Read the status register once. Fetches the read data register when a byte read has finished.
+    virtual Progress poll(uint8_t& result) override final;
+
 private:
     uint8_t mAddress;
     uint8_t mStatus = 0;
+    Operation mPendingOperation = Operation::Reset;
 
     bool busyWait(); //blocks until ready or timeout, updates status
 };
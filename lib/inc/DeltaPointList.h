@@ -0,0 +1,127 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "Temperature.h"
+#include "TicksTypes.h"
+#include <cstdint>
+#include <vector>
+
+/*
+ * A list of setpoint profile points, each stored as the difference to the previous point.
+ * The differences are zigzag encoded variable length integers: 7 bits per byte, small values first.
+ * Points in a profile are usually minutes to days and a few degrees apart, which takes 3 to 6 bytes instead of 8.
+ * The list can only be read in order, with a Reader.
+ */
+class DeltaPointList {
+public:
+    struct Point {
+        utc_seconds_t time;
+        temp_t temp;
+    };
+
+    class Reader {
+    private:
+        const DeltaPointList* list;
+        size_t offset;
+        size_t idx;
+        Point current;
+
+    public:
+        explicit Reader(const DeltaPointList& l)
+            : list(&l)
+            , offset(0)
+            , idx(0)
+            , current{0, 0}
+        {
+            next();
+        }
+
+        // true when the reader points at a valid point
+        bool valid() const
+        {
+            return idx <= list->count && idx > 0;
+        }
+
+        const Point& point() const
+        {
+            return current;
+        }
+
+        // index of the current point
+        size_t index() const
+        {
+            return idx - 1;
+        }
+
+        // advance to the next point
+        void next();
+    };
+
+private:
+    std::vector<uint8_t> data;
+    size_t count = 0;
+    Point last{0, 0};
+
+    void putVarint(int64_t value);
+    static int64_t getVarint(const std::vector<uint8_t>& data, size_t& offset);
+
+public:
+    DeltaPointList() = default;
+    ~DeltaPointList() = default;
+
+    void push_back(const Point& p);
+
+    void clear()
+    {
+        data.clear();
+        data.shrink_to_fit();
+        count = 0;
+        last = Point{0, 0};
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    // number of bytes used to store the points
+    size_t encodedSize() const
+    {
+        return data.size();
+    }
+
+    Reader begin() const
+    {
+        return Reader(*this);
+    }
+
+    const Point& back() const
+    {
+        return last;
+    }
+
+    std::vector<Point> decode() const;
+};
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "FixedPoint.h"
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/*
+ * Integer implementations of the fixed point multiply and quotient used on the control path.
+ * cnl checks and widens every intermediate result, which generates a lot of code on the Cortex-M3.
+ * These primitives work on the raw integers and give identical results:
+ * - dropping fraction bits truncates toward zero
+ * - cnl::quotient keeps the fraction bits of the dividend plus the integer bits of the divisor
+ * - the result saturates to the range of the target type, only after it has been scaled
+ *
+ * fp_multiply and fp_quotient use cnl by default and these primitives when built with -DFAST_FIXED_POINT=1.
+ * FastFixedPoint_test compares both paths. Pid and ActuatorPwm still call cnl directly:
+ * move them to fp_multiply and fp_quotient only after that test has passed against cnl in both modes.
+ */
+#ifndef FAST_FIXED_POINT
+#define FAST_FIXED_POINT 0
+#endif
+
+namespace fast_fp {
+
+// number of bits in the raw integer and how many of them are fraction bits
+template <class T, class Enable = void>
+struct format {
+    static constexpr int digits = cnl::digits_v<T>;
+    static constexpr int fractionBits = cnl::_impl::fractional_digits<T>::value;
+    static constexpr int integerBits = digits - fractionBits;
+};
+
+template <class T>
+struct format<T, std::enable_if_t<std::is_integral<T>::value>> {
+    static constexpr int digits = std::numeric_limits<T>::digits;
+    static constexpr int fractionBits = 0;
+    static constexpr int integerBits = digits;
+};
+
+template <class T>
+std::enable_if_t<std::is_integral<T>::value, int64_t>
+raw(const T& v)
+{
+    return v;
+}
+
+template <class T>
+std::enable_if_t<!std::is_integral<T>::value, int64_t>
+raw(const T& v)
+{
+    return int64_t(cnl::unwrap(v));
+}
+
+constexpr int64_t
+pow2(int bits)
+{
+    return int64_t(1) << bits;
+}
+
+// divides by 2^shift, rounding toward zero
+constexpr int64_t
+scaleDown(int64_t v, int shift)
+{
+    return v < 0 ? -((-v) >> shift) : v >> shift;
+}
+
+constexpr int64_t
+rescale(int64_t v, int fromBits, int toBits)
+{
+    return toBits >= fromBits ? v * pow2(toBits - fromBits) : scaleDown(v, fromBits - toBits);
+}
+
+template <class To>
+To
+saturate(int64_t v)
+{
+    const int64_t max = raw(cnl::numeric_limits<To>::max());
+    const int64_t lowest = raw(cnl::numeric_limits<To>::lowest());
+    if (v > max) {
+        v = max;
+    } else if (v < lowest) {
+        v = lowest;
+    }
+    return cnl::wrap<To>(v);
+}
+
+// same result as To(a * b)
+template <class To, class A, class B>
+To
+multiply(const A& a, const B& b)
+{
+    static_assert(format<A>::digits + format<B>::digits <= 63, "product does not fit in 64 bits");
+    constexpr int productBits = format<A>::fractionBits + format<B>::fractionBits;
+    return saturate<To>(rescale(raw(a) * raw(b), productBits, format<To>::fractionBits));
+}
+
+// same result as To(cnl::quotient(a, b)), b should not be zero
+template <class To, class A, class B>
+To
+quotient(const A& a, const B& b)
+{
+    constexpr int quotientBits = format<A>::fractionBits + format<B>::integerBits;
+    // truncating twice toward zero gives the same result as truncating once
+    // so the division can directly produce the fraction bits of the result when it has less of them
+    constexpr int divisionBits = format<To>::fractionBits < quotientBits ? format<To>::fractionBits : quotientBits;
+    constexpr int dividendShift = divisionBits - format<A>::fractionBits + format<B>::fractionBits;
+    static_assert(dividendShift >= 0, "quotient has less fraction bits than the dividend");
+    static_assert(format<A>::digits + dividendShift <= 63, "scaled dividend does not fit in 64 bits");
+    return saturate<To>(rescale(raw(a) * pow2(dividendShift) / raw(b), divisionBits, format<To>::fractionBits));
+}
+
+} // end namespace fast_fp
+
+template <class To, class A, class B>
+To
+fp_multiply(const A& a, const B& b)
+{
+#if FAST_FIXED_POINT
+    return fast_fp::multiply<To>(a, b);
+#else
+    return To(a * b);
+#endif
+}
+
+template <class To, class A, class B>
+To
+fp_quotient(const A& a, const B& b)
+{
+#if FAST_FIXED_POINT
+    return fast_fp::quotient<To>(a, b);
+#else
+    return To(cnl::quotient(a, b));
+#endif
+}
@@ -39,3 +39,8 @@ using fp12_t = safe_elastic_fixed_point<11, 12>;
 
 std::string
 to_string_dec(const fp12_t& t, uint8_t decimals);
+
+// writes the value like to_string_dec, including the terminating zero, without allocating.
+// Returns the string length, or 0 with an empty string when it does not fit in len.
+uint8_t
+to_chars_dec(const fp12_t& t, uint8_t decimals, char* buf, uint8_t len);
@@ -6,7 +6,7 @@
 #define FILTER_ORDER 6
 
 class IirFilter {
-private:
+public:
     struct FilterParams {
         // params can be stored as int32_t, because they will be promoted when multiplied with _xv and _yv
         int32_t b[FILTER_ORDER + 1]; // multiplied with _xv
@@ -16,16 +16,119 @@ private:
         int32_t maxDerivative;       // max derivative on a step response of 1<<shift
     };
 
+    // Try out these filters in pyFDA to view Magnitude response and stability
+    // The table is constexpr, so filters with a fixed index can have their coefficients folded at compile time
+    static constexpr FilterParams availableFilters[] = {
+        // 0 - Bessel 6th order, -60 dB > 1/4 FS, To downsample 2x. -3dB at 0.0575 FS
+        {
+            {
+                34,
+                202,
+                506,
+                675,
+                506,
+                202,
+                34,
+            },
+            {
+                131072,
+                -449749,
+                672637,
+                -556881,
+                267670,
+                -70519,
+                7929,
+            },
+            17,
+            2,
+            20773,
+        },
+        // 1 - Bessel 6th order, -50 dB > 1/4 FS, To downsample 2x. -3dB at 0.069 FS
+        {
+            {
+                77,
+                460,
+                1149,
+                1531,
+                1149,
+                460,
+                77,
+            },
+            {
+                131072,
+                -394137,
+                530035,
+                -401475,
+                178825,
+                -44094,
+                4677,
+            },
+            17,
+            2,
+            24599,
+        },
+        // 2 - Bessel 6th order, -40 dB > 1/8 FS, To downsample 4x. Fc at 0.06125, -3dB at 0.035 FS
+        {
+            {
+                3,
+                18,
+                46,
+                61,
+                46,
+                18,
+                3,
+            },
+            {
+                131072,
+                -569338,
+                1045651,
+                -1037968,
+                586655,
+                -178824,
+                22947,
+            },
+            17,
+            4,
+            13073,
+        },
+    };
+    static constexpr uint8_t numFilterDefinitions = sizeof(availableFilters) / sizeof(availableFilters[0]);
+
+    // shift with the rounding and sign handling used for the filter history
+    static int64_t shift(const int64_t val, uint8_t shift)
+    {
+        // prevent left shift of negative number, which is undefined behavior
+        uint64_t sign_mask = (uint64_t(1) << 63);
+        int64_t sign = val & sign_mask;
+        uint64_t abs = val & ~sign_mask;
+        return int64_t(abs << shift) | sign;
+    }
+
+    static int64_t unshift(const int64_t val, uint8_t shift)
+    {
+        auto rounder = uint32_t{1} << (shift - 1);
+        int64_t rounded = val + rounder;
+        return rounded >> shift;
+    }
+
+private:
+    // input and output history, used as a ring: the newest value is at index head, older values follow it
     int64_t xv[FILTER_ORDER + 1];
     int64_t yv[FILTER_ORDER + 1];
+    uint8_t head;
     uint8_t paramsIdx;
     int32_t fastStepThreshold;
 
     FilterParams const& params() const;
     int64_t shift(const int64_t val) const;
     int64_t unshift(const int64_t val) const;
-    int64_t shift(const int64_t val, uint8_t shift) const;
-    int64_t unshift(const int64_t val, uint8_t shift) const;
+
+    // index in the history of the value added age samples ago
+    uint8_t historyIndex(uint8_t age) const
+    {
+        uint8_t idx = head + age;
+        return idx > FILTER_ORDER ? idx - (FILTER_ORDER + 1) : idx;
+    }
 
 public:
     IirFilter(uint8_t idx, int32_t threshold = std::numeric_limits<int32_t>::max());
@@ -50,7 +153,7 @@ public:
     }
     int32_t readLastInput() const
     {
-        return unshift(xv[0]);
+        return unshift(xv[head]);
     }
 
     struct DerivativeResult {
@@ -60,12 +163,12 @@ public:
 
     DerivativeResult readDerivative() const // returns unshifted derivative
     {
-        return {yv[0] - yv[1], fractionBits()};
+        return {yv[head] - yv[historyIndex(1)], fractionBits()};
     }
 
     DerivativeResult readPreviousDerivative() const // returns unshifted derivative
     {
-        return {yv[1] - yv[2], fractionBits()};
+        return {yv[historyIndex(1)] - yv[historyIndex(2)], fractionBits()};
     }
 
     int32_t unityStepDerivative() const
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "IirFilter.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/*
+ * A bank of IIR filters that share the same filter parameters, updated together with one call.
+ * The history is stored as a structure of arrays: all filters' values for one tap are contiguous.
+ * A new sample moves the ring index instead of shifting the history, and the multiply-accumulate loops run over all
+ * filters for one tap at a time, which the compiler can vectorize on targets that support it.
+ * The results are identical to an IirFilter with the same parameters and step threshold fed the same samples.
+ */
+class IirFilterBank {
+private:
+    static constexpr uint8_t taps = FILTER_ORDER + 1;
+
+    std::vector<int64_t> xv; // xv[slot * count + filter]
+    std::vector<int64_t> yv; // yv[slot * count + filter]
+    std::vector<int64_t> acc;
+    size_t count;
+    uint8_t head; // slot of the newest sample
+    uint8_t paramsIdx;
+    int32_t fastStepThreshold;
+
+    size_t index(uint8_t age, size_t filter) const
+    {
+        uint8_t slot = head + age;
+        if (slot >= taps) {
+            slot -= taps;
+        }
+        return slot * count + filter;
+    }
+
+    uint8_t shiftBits() const
+    {
+        return IirFilter::FilterDefinition(paramsIdx).shift;
+    }
+
+    void resetFilter(size_t filter, int64_t value);
+
+    // moves the ring index to the slot for the new input and returns the inputs of that slot
+    int64_t* advance();
+
+    // runs the filters on the newest input and handles step detection
+    size_t filterNewInput();
+
+public:
+    IirFilterBank(uint8_t idx, size_t filterCount, int32_t threshold = std::numeric_limits<int32_t>::max());
+    IirFilterBank(const IirFilterBank&) = delete;
+    IirFilterBank(IirFilterBank&&) = default;
+    IirFilterBank& operator=(const IirFilterBank&) = delete;
+    ~IirFilterBank() = default;
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    // Add one sample to each filter. values must hold size() elements.
+    // Returns the number of filters that detected a step and copied the input to their output.
+    size_t add(const int32_t* values);
+    size_t add(const int64_t* values, uint8_t fractionBits);
+
+    void setParamsIdx(const uint8_t idx);
+    uint8_t getParamsIdx() const
+    {
+        return paramsIdx;
+    }
+    void setStepThreshold(const int32_t threshold)
+    {
+        fastStepThreshold = threshold;
+    }
+    int32_t getStepThreshold() const
+    {
+        return fastStepThreshold;
+    }
+    uint8_t fractionBits() const
+    {
+        return shiftBits();
+    }
+
+    int32_t read(size_t filter) const;
+    int32_t readPrevious(size_t filter) const;
+    int64_t readWithNFractionBits(size_t filter, uint8_t bits) const;
+    int32_t readLastInput(size_t filter) const;
+    IirFilter::DerivativeResult readDerivative(size_t filter) const;
+
+    void reset(size_t filter, const int32_t& value);
+    void resetInternal(size_t filter, const int64_t& value)
+    {
+        resetFilter(filter, value);
+    }
+};
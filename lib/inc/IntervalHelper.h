@@ -29,6 +29,7 @@ class IntervalHelper {
 private:
     duration_millis_t m_accumulatedUpdateLateness = 0;
     ticks_millis_t m_lastUpdate = -INTERVAL;
+    bool m_pullPending = false;
 
 public:
     IntervalHelper() = default;
@@ -38,6 +39,9 @@ public:
 
     ticks_millis_t update(const ticks_millis_t& now, bool& doUpdate)
     {
+        if (m_pullPending) {
+            return pull(now, doUpdate);
+        }
         // interval is max 1000ms. Can be shortened to make up for previous updates that were overdue
         auto interval = m_accumulatedUpdateLateness >= INTERVAL ? 0 : INTERVAL - m_accumulatedUpdateLateness;
         auto elapsed = now - m_lastUpdate;
@@ -52,4 +56,21 @@ public:
         }
         return now + interval - elapsed;
     }
+
+    // Update because new input data is available, to process it right away instead of at the next interval.
+    // The update happens now if at least half an interval has passed since the previous update, otherwise when it has.
+    // The next regular update is a full interval later, so regular updates follow the phase of the input.
+    ticks_millis_t pull(const ticks_millis_t& now, bool& doUpdate)
+    {
+        auto elapsed = now - m_lastUpdate;
+        if (elapsed >= INTERVAL / 2) {
+            doUpdate = true;
+            m_pullPending = false;
+            m_lastUpdate = now;
+            m_accumulatedUpdateLateness = 0;
+            return now + INTERVAL;
+        }
+        m_pullPending = true;
+        return now + INTERVAL / 2 - elapsed;
+    }
 };
@@ -80,13 +80,31 @@ public:
     {
         // first channel on external interface is 1, because 0 is unconfigured
         if (validChannel(channel)) {
+            bool levelOnly = isOutput(channels[channel - 1].config) && isOutput(config);
             channels[channel - 1].config = config;
+            if (levelOnly && deferWrite(channel)) {
+                return true;
+            }
             writeChannelImpl(channel, config);
             return true;
         }
         return false;
     }
 
+    /*
+     * While a WriteBatch exists, writes that only change the level of an output are cached.
+     * When it ends, each IoArray applies its changed channels with one writeChannelsImpl call.
+     * PwmScheduler uses it for the outputs that toggle in the same run.
+     * It is meant for the timer interrupt: a batch in the main loop would delay the writes of the interrupt.
+     */
+    class WriteBatch {
+    public:
+        WriteBatch();
+        ~WriteBatch();
+        WriteBatch(const WriteBatch&) = delete;
+        WriteBatch& operator=(const WriteBatch&) = delete;
+    };
+
     bool claimChannel(uint8_t channel, ChannelConfig config)
     {
         ChannelConfig existingConfig;
@@ -127,10 +145,26 @@ protected:
     virtual bool senseChannelImpl(uint8_t channel, State& result) const = 0;
     virtual bool writeChannelImpl(uint8_t channel, ChannelConfig config) = 0;
 
+    // writes the cached config of the channels in mask (bit 0 is channel 1), which are all outputs that only change level
+    // the default writes them one by one, an IoArray that can set several outputs at once can override it
+    virtual bool writeChannelsImpl(uint32_t mask);
+
     struct Channel {
         ChannelConfig config = ChannelConfig::UNUSED;
         State state = State::Unknown;
     };
 
     mutable std::vector<Channel> channels;
+
+private:
+    uint32_t pendingWrites = 0; // channels written during the current WriteBatch
+
+    static bool isOutput(ChannelConfig config)
+    {
+        return config == ChannelConfig::ACTIVE_HIGH || config == ChannelConfig::ACTIVE_LOW;
+    }
+
+    // returns false when the write should be done right away
+    bool deferWrite(uint8_t channel);
+    bool flushWrites();
 };
\ No newline at end of file
@@ -23,9 +23,11 @@
 
 class MockIoArray : public IoArray {
 public:
-    uint8_t pinStates = 0;  // 1 = high, 0 is low
-    uint8_t pinModes = 0;   // 1 = ouput, 0 is input
-    uint8_t errorState = 0; // error for specific channel
+    uint8_t pinStates = 0;        // 1 = high, 0 is low
+    uint8_t pinModes = 0;         // 1 = ouput, 0 is input
+    uint8_t errorState = 0;       // error for specific channel
+    uint8_t batchedWrites = 0;    // number of writeChannelsImpl calls
+    uint32_t lastBatchedMask = 0; // channels of the last writeChannelsImpl call
     bool isConnected = true;
 
     MockIoArray()
@@ -72,6 +74,13 @@ public:
         return false;
     }
 
+    virtual bool writeChannelsImpl(uint32_t mask) override final
+    {
+        ++batchedWrites;
+        lastBatchedMask = mask;
+        return IoArray::writeChannelsImpl(mask);
+    }
+
     void connected(bool v)
     {
         isConnected = v;
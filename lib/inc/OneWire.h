@@ -2,6 +2,10 @@
 
 #include "OneWireAddress.h"
 #include "OneWireLowLevelInterface.h"
+#include "OneWireTransaction.h"
+#include "TicksTypes.h"
+#include <functional>
+#include <vector>
 
 class OneWire {
 public:
@@ -24,6 +28,13 @@ private:
     uint8_t lastDiscrepancy;
     bool lastDeviceFlag;
     uint8_t lockedSearchBits;
+    uint16_t conversions = 0; // number of bus wide temperature conversions started, 0 when not used
+    std::vector<OneWireTransaction*> transactions; // queued transactions, the first one is in progress
+    OneWireTransaction conversion;
+    bool operationStarted = false; // a driver operation is in progress for the first transaction
+    bool discardResult = false;    // the transaction of the operation in progress has been cancelled
+
+    void finishTransaction(OneWireTransaction::Status status);
 
 public:
     // wrappers for low level functions
@@ -53,9 +64,36 @@ public:
 
     bool reset()
     {
+        // blocking access starts with a reset, let queued transactions finish first
+        completeTransactions();
         return driver.reset();
     }
 
+    // Queue a transaction to be processed without blocking. The transaction is advanced right away until the
+    // driver has to wait for the bus, which means it is already finished on return for drivers that do not wait.
+    // Returns false if the transaction is already pending.
+    bool submit(OneWireTransaction& transaction);
+
+    // Remove a transaction from the queue, for example because its owner is destroyed
+    void cancel(OneWireTransaction& transaction);
+
+    // Advance queued transactions until the driver is busy. Call this often from the main loop.
+    // Returns true if transactions are still pending.
+    bool process();
+
+    // Advance queued transactions like process(), but keep polling a busy driver until the time budget has passed.
+    // A single process() call only gets one operation per main loop iteration from a driver that is always busy
+    // right after starting an operation, while the bus is often ready again well within a millisecond.
+    // micros returns the current time in microseconds. Returns true if transactions are still pending.
+    bool process(duration_micros_t budget, const std::function<ticks_micros_t()>& micros);
+
+    // Block until all queued transactions are finished
+    void completeTransactions()
+    {
+        while (process()) {
+        }
+    }
+
     // high level functions
 
     // Issue a 1-Wire rom select command, you do the reset first.
@@ -66,6 +104,19 @@ public:
 
     bool write_bytes(const uint8_t* buf, uint16_t count);
 
+    // Start a temperature conversion on all sensors on the bus at once, with a single skip ROM convert T command.
+    // Other device types on the bus ignore the convert T command. The command is queued as a transaction.
+    // Returns false if the previous conversion command has not been sent yet or failed.
+    // While the previous command is still queued, the conversion sequence does not change.
+    bool startConversion();
+
+    // Increases each time startConversion() is called. Sensors read their scratchpad once after each new conversion.
+    // Stays 0 when the bus is not used for bus wide conversions.
+    uint16_t conversionSequence() const
+    {
+        return conversions;
+    }
+
     bool read_bytes(uint8_t* buf, uint16_t count);
 
     // Clear the search state so that if will start from the beginning again.
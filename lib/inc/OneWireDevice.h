@@ -21,13 +21,14 @@
 
 #include "OneWire.h"
 #include "OneWireAddress.h"
+#include "OneWireTransaction.h"
 
 class OneWireDevice {
 public:
     OneWireDevice(OneWire& oneWire_, const OneWireAddress& address_);
 
 protected:
-    ~OneWireDevice() = default;
+    ~OneWireDevice();
 
 public:
     OneWireAddress address() const
@@ -54,6 +55,10 @@ public:
 protected:
     OneWire& oneWire;
     OneWireAddress m_address;
+    OneWireTransaction m_transaction; // used for reads that are completed in a later update when the bus is slow
+
+    // Queue a read of readCount bytes after sending the command bytes to this device
+    void submitRead(const uint8_t* command, uint8_t commandCount, uint8_t readCount);
 
 private:
     bool m_connected = false;
@@ -51,4 +51,52 @@ public:
 
     // Perform a triple operation which will perform 2 read bits and 1 write bit, returns device status
     virtual uint8_t search_triplet(bool search_direction) = 0;
+
+    // Non-blocking operations, used by OneWire to advance queued transactions without waiting for the bus.
+    enum class Operation : uint8_t {
+        Reset,
+        Write,
+        Read,
+    };
+
+    enum class Progress : uint8_t {
+        Busy,
+        Done,
+        Failed,
+    };
+
+    // Start a reset, byte write or byte read and return without waiting for it to finish.
+    // Returns false if the operation could not be started.
+    // The default implementation performs the blocking operation right away.
+    virtual bool start(Operation op, uint8_t value)
+    {
+        uint8_t result = 0;
+        bool success = true;
+        switch (op) {
+        case Operation::Reset:
+            result = reset() ? 1 : 0;
+            break;
+        case Operation::Write:
+            success = write(value);
+            break;
+        case Operation::Read:
+            success = read(result);
+            break;
+        }
+        asyncResult = result;
+        asyncSuccess = success;
+        return true;
+    }
+
+    // Check whether the last started operation has finished.
+    // When done, result holds the byte read, or 1 for a reset that detected a presence pulse.
+    virtual Progress poll(uint8_t& result)
+    {
+        result = asyncResult;
+        return asyncSuccess ? Progress::Done : Progress::Failed;
+    }
+
+private:
+    uint8_t asyncResult = 0;
+    bool asyncSuccess = false;
 };
@@ -77,7 +77,7 @@ public:
 
     virtual bool reset() override final
     {
-
+        ++resets;
         bool devicePresent = false;
         for (auto& device : devices) {
             devicePresent |= device->reset();
@@ -85,11 +85,42 @@ public:
         return devicePresent;
     }
 
+    // Operations are performed right away, but poll() reports busy the configured number of times to simulate bus latency
+    virtual bool start(Operation op, uint8_t value) override final
+    {
+        busyPolls = latency;
+        return OneWireLowLevelInterface::start(op, value);
+    }
+
+    virtual Progress poll(uint8_t& result) override final
+    {
+        if (busyPolls > 0) {
+            --busyPolls;
+            return Progress::Busy;
+        }
+        return OneWireLowLevelInterface::poll(result);
+    }
+
+    // number of times poll() returns busy after each started operation
+    void setLatency(uint8_t polls)
+    {
+        latency = polls;
+    }
+
     void attach(std::shared_ptr<OneWireMockDevice> device)
     {
         devices.push_back(std::move(device));
     }
 
+    // each bus transaction starts with a reset, so this counts transactions
+    uint32_t resetCount() const
+    {
+        return resets;
+    }
+
 private:
     std::vector<std::shared_ptr<OneWireMockDevice>> devices;
+    uint32_t resets = 0;
+    uint8_t latency = 0;
+    uint8_t busyPolls = 0;
 };
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWireAddress.h"
+#include <cstdint>
+
+class OneWire;
+
+/**
+ * Describes a complete bus transaction: reset, ROM select or skip, command bytes, reading a number of bytes and a final reset.
+ * Transactions are queued on the OneWire bus with submit() and advanced one byte at a time by OneWire::process().
+ * The owner polls status() until the transaction is done or failed.
+ * A transaction must stay alive while it is pending, or be cancelled with OneWire::cancel().
+ */
+class OneWireTransaction {
+public:
+    enum class Status : uint8_t {
+        Idle,
+        Pending,
+        Done,
+        Failed,
+    };
+
+    static constexpr uint8_t maxCommandBytes = 4;
+    static constexpr uint8_t maxReadBytes = 12;
+
+    OneWireTransaction() = default;
+    OneWireTransaction(const OneWireTransaction&) = delete;
+    OneWireTransaction& operator=(const OneWireTransaction&) = delete;
+    ~OneWireTransaction() = default;
+
+    /**
+     * Prepare the transaction before submitting it.
+     * /param address Device to select
+     * /param command Bytes to write after selecting the device
+     * /param commandCount Number of command bytes, at most maxCommandBytes
+     * /param readCount Number of bytes to read after the command, at most maxReadBytes
+     */
+    void prepare(const OneWireAddress& address, const uint8_t* command, uint8_t commandCount, uint8_t readCount)
+    {
+        m_address = address;
+        m_skipRom = false;
+        setCommand(command, commandCount, readCount);
+    }
+
+    // Prepare a transaction that addresses all devices on the bus with skip ROM
+    void prepare(const uint8_t* command, uint8_t commandCount, uint8_t readCount)
+    {
+        m_address = 0;
+        m_skipRom = true;
+        setCommand(command, commandCount, readCount);
+    }
+
+    Status status() const
+    {
+        return m_status;
+    }
+
+    bool pending() const
+    {
+        return m_status == Status::Pending;
+    }
+
+    bool finished() const
+    {
+        return m_status == Status::Done || m_status == Status::Failed;
+    }
+
+    // Mark the result as handled
+    void clear()
+    {
+        if (finished()) {
+            m_status = Status::Idle;
+        }
+    }
+
+    const uint8_t* data() const
+    {
+        return m_data;
+    }
+
+    uint8_t dataCount() const
+    {
+        return m_readCount;
+    }
+
+private:
+    friend class OneWire;
+
+    void setCommand(const uint8_t* command, uint8_t commandCount, uint8_t readCount)
+    {
+        m_commandCount = commandCount < maxCommandBytes ? commandCount : maxCommandBytes;
+        m_readCount = readCount < maxReadBytes ? readCount : maxReadBytes;
+        for (uint8_t i = 0; i < m_commandCount; i++) {
+            m_command[i] = command[i];
+        }
+        m_step = 0;
+        m_status = Status::Idle;
+    }
+
+    OneWireAddress m_address = 0;
+    uint8_t m_command[maxCommandBytes] = {0};
+    uint8_t m_data[maxReadBytes] = {0};
+    uint8_t m_commandCount = 0;
+    uint8_t m_readCount = 0;
+    uint8_t m_step = 0;
+    bool m_skipRom = false;
+    Status m_status = Status::Idle;
+};
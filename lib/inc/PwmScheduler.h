@@ -0,0 +1,99 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ActuatorDigitalBase.h"
+#include "TicksTypes.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*
+ * Generates the edges of all fast PWM outputs from one timer.
+ * Each channel has one pending edge in a queue that is sorted on time.
+ * run() applies all edges that are due in one pass and returns the time of the next edge.
+ * The hardware timer is programmed to fire at that time.
+ * Outputs that toggle at the same time are set in the same interrupt, one setter call per channel.
+ * The setters run in an IoArray::WriteBatch, so each IoArray writes all of its toggled outputs in one call.
+ *
+ * Each period starts with the active edge, followed by the inactive edge after the duty time.
+ * A new duty time takes effect at the start of the next period.
+ * When edges are handled late, the next edges keep their phase unless a whole period was missed.
+ */
+class PwmScheduler {
+public:
+    using State = ActuatorDigitalBase::State;
+    using setter_t = std::function<void(State)>;
+
+    PwmScheduler() = default;
+    PwmScheduler(const PwmScheduler&) = delete;
+    PwmScheduler& operator=(const PwmScheduler&) = delete;
+    ~PwmScheduler() = default;
+
+    // adds a channel that starts its first period at now, returns its id or 0 when no id is available or the period is zero
+    uint8_t add(duration_micros_t period, setter_t&& setter, ticks_micros_t now);
+
+    void remove(uint8_t id);
+
+    // sets the active time per period, which is limited to the period
+    void dutyTime(uint8_t id, duration_micros_t duty);
+
+    duration_micros_t dutyTime(uint8_t id) const;
+
+    // applies all edges at or before now and returns the time of the next edge
+    // the setters are called from here, they should not add or remove channels
+    ticks_micros_t run(ticks_micros_t now);
+
+    bool empty() const
+    {
+        return queue.empty();
+    }
+
+    // time of the next edge, only valid when not empty
+    ticks_micros_t nextEdge() const
+    {
+        return queue.front().time;
+    }
+
+private:
+    struct Channel {
+        uint8_t id;
+        duration_micros_t period;
+        duration_micros_t dutyTime;
+        ticks_micros_t periodStart;
+        setter_t setter;
+    };
+
+    struct Edge {
+        ticks_micros_t time;
+        uint8_t id;
+        bool periodStart; // the start of a period is active, unless the duty time is zero
+    };
+
+    std::vector<Channel> channels;
+    std::vector<Edge> queue;
+    std::vector<Edge> due; // reused between runs to avoid allocating in the interrupt
+
+    Channel* find(uint8_t id);
+    const Channel* find(uint8_t id) const;
+    void schedule(const Edge& edge);
+    void unschedule(uint8_t id);
+    static Edge next(const Channel& c, const Edge& applied);
+};
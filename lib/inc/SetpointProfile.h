@@ -19,30 +19,47 @@
 
 #pragma once
 
+#include "DeltaPointList.h"
 #include "SetpointSensorPair.h"
 #include "Temperature.h"
 #include "TicksTypes.h"
-#include <algorithm>
 #include <vector>
 
 class SetpointProfile {
 public:
-    struct Point {
-        utc_seconds_t time;
-        temp_t temp;
-    };
+    using Point = DeltaPointList::Point;
 
 private:
     const std::function<std::shared_ptr<SetpointSensorPair>()> m_target;
     utc_seconds_t m_profileStartTime = 0;
     bool m_enabled = true;
 
-    std::vector<Point> m_points;
+    DeltaPointList m_points;
+
+    // The cursor remembers the segment of the last update, so the points only have to be searched again when time jumps back.
+    // It points at the first point after the last update time. The slope is cached when the cursor moves to a new segment.
+    static constexpr uint8_t slopeFractionBits = 30;
+    DeltaPointList::Reader m_cursor;
+    Point m_lower = Point{0, 0};
+    bool m_hasLower = false;
+    utc_seconds_t m_cursorElapsed = 0;
+    int64_t m_slope = 0; // change in raw temp_t per second, with slopeFractionBits extra fraction bits
+
+    void resetCursor()
+    {
+        m_cursor = m_points.begin();
+        m_hasLower = false;
+        m_cursorElapsed = 0;
+    }
+
+    // moves the cursor forward to the segment that contains elapsed, returns whether it changed segment
+    bool seek(utc_seconds_t elapsed);
 
 public:
     explicit SetpointProfile(
         std::function<std::shared_ptr<SetpointSensorPair>()>&& target) // process value to manipulate setpoint of
         : m_target(target)
+        , m_cursor(m_points.begin())
     {
     }
     SetpointProfile(const SetpointProfile&) = delete;
@@ -51,12 +68,14 @@ public:
 
     void addPoint(Point&& p)
     {
-        m_points.push_back(std::move(p));
+        m_points.push_back(p);
+        resetCursor();
     }
 
     void removeAllPoints()
     {
         m_points.clear();
+        resetCursor();
     }
 
     bool isDriving() const
@@ -76,14 +95,30 @@ public:
         m_enabled = v;
     }
 
-    const std::vector<Point>& points() const
+    std::vector<Point> points() const
+    {
+        return m_points.decode();
+    }
+
+    // the delta encoded points, to iterate over them without decoding them all into a vector
+    const DeltaPointList& pointList() const
     {
         return m_points;
     }
 
     void points(std::vector<Point>&& newPoints)
     {
-        m_points = newPoints;
+        m_points.clear();
+        for (auto& p : newPoints) {
+            m_points.push_back(p);
+        }
+        resetCursor();
+    }
+
+    // number of bytes used to store the points
+    size_t pointsSize() const
+    {
+        return m_points.encodedSize();
     }
 
     utc_seconds_t startTime() const
@@ -94,5 +129,6 @@ public:
     void startTime(utc_seconds_t v)
     {
         m_profileStartTime = v;
+        resetCursor();
     }
 };
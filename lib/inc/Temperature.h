@@ -34,4 +34,8 @@ std::string
 tempDiff_to_string(const temp_t& t, uint8_t decimals, const TempUnit& unit);
 
 std::string
-temp_to_string(const temp_t& t, uint8_t decimals, const TempUnit& unit);
\ No newline at end of file
+temp_to_string(const temp_t& t, uint8_t decimals, const TempUnit& unit);
+
+// like temp_to_string, but writes to buf without allocating, see to_chars_dec
+uint8_t
+temp_to_chars(const temp_t& t, uint8_t decimals, const TempUnit& unit, char* buf, uint8_t len);
\ No newline at end of file
@@ -1,9 +1,18 @@
+#pragma once
+
+#include "PwmScheduler.h"
 #include <cinttypes>
 #include <functional>
 
+/*
+ * Drives the PwmScheduler that is shared by all fast PWM actuators with a hardware timer.
+ * The timer counts microseconds and is programmed to fire at the next edge.
+ * The scheduler is only changed with the timer interrupt disabled.
+ */
 class TimerInterrupts {
 public:
     static void init();
-    static int16_t add(std::function<void()>&& func);
-    static void remove(uint8_t id);
+    static uint8_t addPwm(duration_micros_t period, PwmScheduler::setter_t&& setter);
+    static void removePwm(uint8_t id);
+    static void pwmDutyTime(uint8_t id, duration_micros_t duty);
 };
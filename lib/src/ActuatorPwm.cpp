@@ -28,6 +28,11 @@ ActuatorPwm::setting(const value_t& val)
         auto unScaledTime = m_dutySetting * m_period;
         m_dutyTime = uint64_t(unScaledTime) / 100;
     }
+#if PLATFORM_ID != PLATFORM_GCC
+    if (m_fastPwmChannel) {
+        TimerInterrupts::pwmDutyTime(m_fastPwmChannel, fastPwmDutyTime());
+    }
+#endif
 
     settingValid(true);
 }
@@ -52,13 +57,14 @@ ActuatorPwm::manageTimerTask()
 {
     if (m_period < 1000 && m_enabled) {
         m_period = 100;
-        if (!timerFuncId) {
-            timerFuncId = TimerInterrupts::add([this]() { timerTask(); });
+        if (!m_fastPwmChannel) {
+            m_fastPwmChannel = TimerInterrupts::addPwm(fastPwmPeriod(), [this](State s) { fastPwmEdge(s); });
         }
+        TimerInterrupts::pwmDutyTime(m_fastPwmChannel, fastPwmDutyTime());
     } else {
-        if (timerFuncId) {
-            TimerInterrupts::remove(timerFuncId);
-            timerFuncId = 0;
+        if (m_fastPwmChannel) {
+            TimerInterrupts::removePwm(m_fastPwmChannel);
+            m_fastPwmChannel = 0;
             m_dutyAchieved = value_t{0};
         }
     }
@@ -92,37 +98,28 @@ ActuatorPwm::period() const
 
 #if PLATFORM_ID != PLATFORM_GCC
 void
-ActuatorPwm::timerTask()
+ActuatorPwm::fastPwmEdge(State state)
 {
-
-    // timer clock is 10 kHz, 100 steps at 100Hz
-    if (m_fastPwmElapsed == 0) {
-        auto actPtr = m_target();
-        if (m_dutyTime != 0 && actPtr) {
+    if (auto actPtr = m_target()) {
+        if (state == State::Active) {
             if (actPtr->state() == State::Active) {
                 m_dutyAchieved = maxDuty(); // was never low
             } else {
                 actPtr->setStateUnlogged(State::Active);
             }
         } else {
-            m_dutyAchieved = value_t{0};
-        }
-        m_fastPwmElapsed = 0;
-    }
-    if (m_fastPwmElapsed == m_dutyTime) {
-        if (auto actPtr = m_target()) {
             actPtr->setStateUnlogged(State::Inactive);
             m_dutyAchieved = m_dutySetting;
         }
+    } else {
+        m_dutyAchieved = value_t{0};
     }
-
-    m_fastPwmElapsed = m_fastPwmElapsed >= 99 ? 0 : m_fastPwmElapsed + 1;
 }
 
 ActuatorPwm::update_t
 ActuatorPwm::update(const update_t& now)
 {
-    if (timerFuncId) {
+    if (m_fastPwmChannel) {
         return now + 1000;
     }
     return slowPwmUpdate(now);
@@ -116,20 +116,72 @@ DS18B20::value() const
 void
 DS18B20::update()
 {
-    m_cachedValue = readAndConstrainTemp();
-    startConversion();
+    auto conversion = oneWire.conversionSequence();
+    if (conversion == 0) {
+        m_cachedValue = readAndConstrainTemp();
+        startConversion();
+        return;
+    }
+    // The scratchpad read is queued on the bus. It finishes right away with a driver that does not wait for the bus,
+    // otherwise it finishes while the bus is processed and the result is picked up in the next update.
+    if (m_transaction.finished()) {
+        processScratchPadRead();
+    }
+    if (conversion != m_lastConversion && !m_transaction.pending()) {
+        m_lastConversion = conversion;
+        submitScratchPadRead();
+    }
+}
+
+void
+DS18B20::submitScratchPadRead()
+{
+    static constexpr const uint8_t command = READSCRATCH;
+    submitRead(&command, 1, 9);
+    if (m_transaction.finished()) {
+        processScratchPadRead();
+    }
+}
+
+void
+DS18B20::processScratchPadRead()
+{
+    ScratchPad scratchPad;
+    bool success = m_transaction.status() == OneWireTransaction::Status::Done;
+    if (success) {
+        for (uint8_t i = 0; i < 9; i++) {
+            scratchPad[i] = m_transaction.data()[i];
+        }
+        success = scratchPad.valid();
+    }
+    m_transaction.clear();
+
+    if (!success && !m_retried) {
+        // retry once, like the blocking read
+        m_retried = true;
+        submitScratchPadRead();
+        return;
+    }
+    m_retried = false;
+    m_cachedValue = constrainTemp(success ? getRawTemp(scratchPad) : DEVICE_DISCONNECTED_RAW);
 }
 
 temp_t
 DS18B20::readAndConstrainTemp()
+{
+    ScratchPad scratchPad;
+    if (!readScratchPad(scratchPad)) {
+        return constrainTemp(DEVICE_DISCONNECTED_RAW);
+    }
+    return constrainTemp(getRawTemp(scratchPad));
+}
+
+temp_t
+DS18B20::constrainTemp(int32_t tempRaw)
 {
     // difference in precision between DS18B20 format and temperature format
     static constexpr const int32_t scale = 1 << (cnl::_impl::fractional_digits<temp_t>::value - 4);
-    int32_t tempRaw;
-    bool success;
-
-    tempRaw = getRawTemp();
-    success = tempRaw > RESET_DETECTED_RAW;
+    bool success = tempRaw > RESET_DETECTED_RAW;
 
     if (tempRaw == RESET_DETECTED_RAW) {
         // retry re-init if the sensor is present, but needs a reset
@@ -208,12 +260,8 @@ DS18B20::
 }
 
 int16_t
-DS18B20::getRawTemp()
+DS18B20::getRawTemp(const ScratchPad& scratchPad)
 {
-    ScratchPad scratchPad;
-    if (!readScratchPad(scratchPad)) {
-        return DEVICE_DISCONNECTED_RAW;
-    }
     // return DEVICE_DISCONNECTED when a reset has been detected to force it to be reconfigured
     // we detect a reset by creating a mismatch beteween the eeprom and the on device scratchpad
     // On reset, the EEPROM value will be reloaded, signaling that a reset has  occurred
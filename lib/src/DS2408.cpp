@@ -42,34 +42,29 @@ DS2408::writeNeeded() const
 bool
 DS2408::update()
 {
-    selectRom();
+    bool success = connected();
 
-    // Compute the 1-Wire CRC16 and compare it against the received CRC.
-    // Put everything in one buffer so we can compute the CRC easily.
-    uint8_t buf[13];
-
-    buf[0] = READ_PIO_REG;            // Read PIO Registers
-    buf[1] = ADDRESS_PIO_STATE_LOWER; // LSB address
-    buf[2] = ADDRESS_UPPER;           // MSB address
-    oneWire.write_bytes(buf, 3);      // Write 3 cmd bytes
-    oneWire.read_bytes(&buf[3], 10);  // Read 6 data bytes, 2 0xFF, CRC16
-
-    uint16_t crcCalculated = OneWireCrc16(buf, 11);
-    // device sends CRC inverted
-    uint16_t crcReceived = ~((uint16_t(buf[12]) << 8) | uint16_t(buf[11]));
-    bool success = crcCalculated == crcReceived;
-    connected(success);
+    // The read is queued on the bus. It finishes right away with a driver that does not wait for the bus,
+    // otherwise it finishes while the bus is processed and the result is picked up in the next update.
+    if (m_transaction.finished()) {
+        success = processRead();
+    }
+    if (!m_transaction.pending()) {
+        static constexpr uint8_t command[3] = {READ_PIO_REG, ADDRESS_PIO_STATE_LOWER, ADDRESS_UPPER};
+        submitRead(command, 3, 10); // Read 6 data bytes, 2 0xFF, CRC16
+        if (m_transaction.finished()) {
+            success = processRead();
+        }
+    }
 
-    if (success) {
-        pins = buf[3];
-        latches = buf[4];
-        activity = buf[5];
-        cond_search_mask = buf[6];
-        cond_search_pol = buf[7];
-        status = buf[8];
-        dirty = false;
+    if (writeNeeded() && m_transaction.pending()) {
+        // writing blocks the bus anyway, finish the queued read first so the write uses the latest state
+        oneWire.completeTransactions();
+        success = processRead();
     }
+
     if (writeNeeded()) {
+        bool written = false;
         if (selectRom()) {
             uint8_t bytes[3] = {ACCESS_WRITE, desiredLatches, uint8_t(~desiredLatches)};
 
@@ -77,15 +72,44 @@ DS2408::update()
                 /* Acknowledgement byte, 0xAA for success, 0xFF for failure. */
                 uint8_t ack;
                 if (oneWire.read(ack) && ack == ACK_SUCCESS) {
-                    success = success && oneWire.read(pins);
+                    written = oneWire.read(pins);
                 }
             };
         }
+        success = success && written;
         connected(success);
+        oneWire.reset();
     }
 
-    oneWire.reset();
+    return success;
+}
+
+bool
+DS2408::processRead()
+{
+    // Compute the 1-Wire CRC16 and compare it against the received CRC.
+    // Put everything in one buffer so we can compute the CRC easily.
+    uint8_t buf[13] = {READ_PIO_REG, ADDRESS_PIO_STATE_LOWER, ADDRESS_UPPER};
+    bool success = m_transaction.status() == OneWireTransaction::Status::Done;
+    if (success) {
+        memcpy(&buf[3], m_transaction.data(), 10);
+        uint16_t crcCalculated = OneWireCrc16(buf, 11);
+        // device sends CRC inverted
+        uint16_t crcReceived = ~((uint16_t(buf[12]) << 8) | uint16_t(buf[11]));
+        success = crcCalculated == crcReceived;
+    }
+    m_transaction.clear();
+    connected(success);
 
+    if (success) {
+        pins = buf[3];
+        latches = buf[4];
+        activity = buf[5];
+        cond_search_mask = buf[6];
+        cond_search_pol = buf[7];
+        status = buf[8];
+        dirty = false;
+    }
     return success;
 }
 
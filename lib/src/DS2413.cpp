@@ -25,22 +25,23 @@
 bool
 DS2413::update()
 {
-
-    bool success = false;
+    bool success = connected();
     if (!writeNeeded()) { // skip read if we need to write anyway, which also returns status
-        if (selectRom()) {
-            if (!oneWire.write(ACCESS_READ)) {
-                return false;
-            }
-            uint8_t status;
-            if (!oneWire.read(status)) {
-                return false;
+        // The read is queued on the bus. It finishes right away with a driver that does not wait for the bus,
+        // otherwise it finishes while the bus is processed and the result is picked up in the next update.
+        if (m_transaction.finished()) {
+            success = processRead();
+        }
+        if (!m_transaction.pending()) {
+            uint8_t command = ACCESS_READ;
+            submitRead(&command, 1, 1);
+            if (m_transaction.finished()) {
+                success = processRead();
             }
-            success = processStatus(status);
         }
-        connected(success);
     }
     if (writeNeeded()) { // check again
+        success = false;
         if (selectRom()) {
             uint8_t data = (desiredState & 0b1000) >> 2 | (desiredState & 0b0010) >> 1;
             uint8_t bytes[3] = {ACCESS_WRITE, data, uint8_t(~data)};
@@ -55,13 +56,25 @@ DS2413::update()
                 }
             }
         }
+        // a queued read was completed before the write, its result is outdated
+        m_transaction.clear();
         connected(success);
+        oneWire.reset();
     }
-    oneWire.reset();
 
     return success;
 }
 
+bool
+DS2413::processRead()
+{
+    bool success = m_transaction.status() == OneWireTransaction::Status::Done
+                   && processStatus(m_transaction.data()[0]);
+    m_transaction.clear();
+    connected(success);
+    return success;
+}
+
 bool
 DS2413::writeNeeded()
 {
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../inc/DeltaPointList.h"
+
+void
+DeltaPointList::putVarint(int64_t value)
+{
+    // zigzag encoding maps small negative values to small positive values: 0, -1, 1, -2 -> 0, 1, 2, 3
+    uint64_t v = (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+    while (v >= 0x80) {
+        data.push_back(uint8_t(v) | 0x80);
+        v >>= 7;
+    }
+    data.push_back(uint8_t(v));
+}
+
+int64_t
+DeltaPointList::getVarint(const std::vector<uint8_t>& data, size_t& offset)
+{
+    uint64_t v = 0;
+    uint8_t shift = 0;
+    while (offset < data.size()) {
+        uint8_t b = data[offset++];
+        v |= uint64_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+
+void
+DeltaPointList::push_back(const Point& p)
+{
+    putVarint(int64_t(p.time) - int64_t(last.time));
+    putVarint(int64_t(cnl::unwrap(p.temp)) - int64_t(cnl::unwrap(last.temp)));
+    last = p;
+    ++count;
+}
+
+void
+DeltaPointList::Reader::next()
+{
+    if (idx < list->count) {
+        current.time = utc_seconds_t(int64_t(current.time) + getVarint(list->data, offset));
+        current.temp = cnl::wrap<temp_t>(int32_t(int64_t(cnl::unwrap(current.temp)) + getVarint(list->data, offset)));
+    }
+    if (idx <= list->count) {
+        ++idx;
+    }
+}
+
+std::vector<DeltaPointList::Point>
+DeltaPointList::decode() const
+{
+    std::vector<Point> points;
+    points.reserve(count);
+    for (auto reader = begin(); reader.valid(); reader.next()) {
+        points.push_back(reader.point());
+    }
+    return points;
+}
@@ -19,8 +19,8 @@
 
 #include "FixedPoint.h"
 
-std::string
-to_string_dec(const fp12_t& t, uint8_t decimals)
+uint8_t
+to_chars_dec(const fp12_t& t, uint8_t decimals, char* buf, uint8_t len)
 {
     static constexpr const int32_t one = cnl::unwrap(fp12_t{1});
     static constexpr const int32_t rounder_up = cnl::unwrap(fp12_t{0.5});
@@ -38,16 +38,41 @@ to_string_dec(const fp12_t& t, uint8_t decimals)
     int32_t rounder = (unwrapped >= 0) ? rounder_up : rounder_down;
     int32_t asInt = (scale * unwrapped + rounder) / one;
 
-    std::string s = std::to_string(asInt);
+    // digits are generated in reverse, with leading zeros up to one digit before the period
+    char digits[10];
+    uint8_t count = 0;
+    uint32_t remaining = asInt < 0 ? uint32_t(-asInt) : uint32_t(asInt);
+    do {
+        digits[count++] = '0' + remaining % 10;
+        remaining /= 10;
+    } while (remaining > 0 || count <= decimals);
+
+    uint8_t total = count + (asInt < 0) + (decimals > 0);
+    if (total >= len) {
+        if (len > 0) {
+            buf[0] = 0;
+        }
+        return 0;
+    }
 
-    if (decimals > 0) {
-        int missingZeros = int(decimals) + 1 - s.length() + (asInt < 0);
-        auto insertAt = s.begin() + (asInt < 0);
-        if (missingZeros > 0) {
-            insertAt = s.insert(insertAt, missingZeros, '0'); // leading zeros
+    char* out = buf;
+    if (asInt < 0) {
+        *out++ = '-';
+    }
+    while (count > 0) {
+        if (count == decimals) {
+            *out++ = '.';
         }
-        auto periodPos = s.end() - decimals;
-        s.insert(periodPos, '.');
+        *out++ = digits[--count];
     }
-    return s;
-}
\ No newline at end of file
+    *out = 0;
+    return total;
+}
+
+std::string
+to_string_dec(const fp12_t& t, uint8_t decimals)
+{
+    char buf[12];
+    to_chars_dec(t, decimals, buf, sizeof(buf));
+    return std::string(buf);
+}
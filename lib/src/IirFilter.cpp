@@ -23,6 +23,7 @@
 IirFilter::IirFilter(uint8_t idx, int32_t threshold)
     : xv{0}
     , yv{0}
+    , head(0)
     , paramsIdx(idx)
     , fastStepThreshold(threshold)
 {
@@ -56,28 +57,27 @@ IirFilter::add(const int64_t val, uint8_t fractionBits)
     int64_t output = 0;
     FilterParams const& paramsRef = params();
 
-    // shift input/output history by 1 position
-    for (uint8_t i = FILTER_ORDER; i >= 1; i--) {
-        xv[i] = xv[i - 1];
-        yv[i] = yv[i - 1];
-    }
-    xv[0] = shift(val, params().shift - fractionBits);
+    // move the ring index back by 1 position instead of shifting the history, the oldest value is overwritten
+    head = head == 0 ? FILTER_ORDER : head - 1;
+    xv[head] = shift(val, paramsRef.shift - fractionBits);
 
-    output = paramsRef.b[0] * xv[0];
+    output = paramsRef.b[0] * xv[head];
+    uint8_t idx = head;
     for (uint8_t i = 1; i <= FILTER_ORDER; i++) {
-        output += paramsRef.b[i] * xv[i]; // 19 bits max + 24 bits + 16 bits = 59 bits max
-        output -= paramsRef.a[i] * yv[i]; // 19 bits max + 24 bits + 16 bits = 59 bits max
+        idx = idx == FILTER_ORDER ? 0 : idx + 1;
+        output += paramsRef.b[i] * xv[idx]; // 19 bits max + 24 bits + 16 bits = 59 bits max
+        output -= paramsRef.a[i] * yv[idx]; // 19 bits max + 24 bits + 16 bits = 59 bits max
     }
-    yv[0] = unshift(output); // rounded shift
+    yv[head] = unshift(output); // rounded shift
 
     // If the output of filter is rising fast, we detect this as a step and copy the input directly to the output history
     // To prevent false triggers (not a step), we take the difference between the last 2 outputs instead of the input.
     // This provides some filtering.
     // All values of the output history are set to the new value to prevent instability
 
-    int64_t thresholdAtOutPut = uint64_t(fastStepThreshold) * uint64_t(params().maxDerivative);
-    if (abs(yv[0] - yv[1]) >= thresholdAtOutPut) {
-        resetInternal(xv[0]);
+    int64_t thresholdAtOutPut = uint64_t(fastStepThreshold) * uint64_t(paramsRef.maxDerivative);
+    if (abs(yv[head] - yv[historyIndex(1)]) >= thresholdAtOutPut) {
+        resetInternal(xv[head]);
         return true;
     }
     return false;
@@ -102,22 +102,22 @@ IirFilter::resetInternal(const int64_t& value)
 int32_t
 IirFilter::read(void) const
 {
-    return unshift(yv[0]);
+    return unshift(yv[head]);
 }
 
 int32_t
 IirFilter::readPrevious(void) const
 {
-    return unshift(yv[1]);
+    return unshift(yv[historyIndex(1)]);
 }
 
 int64_t
 IirFilter::readWithNFractionBits(uint8_t bits) const
 {
     if (bits >= params().shift) {
-        return shift(yv[0], bits - params().shift);
+        return shift(yv[head], bits - params().shift);
     }
-    return unshift(yv[0], params().shift - bits);
+    return unshift(yv[head], params().shift - bits);
 }
 
 int64_t
@@ -126,109 +126,19 @@ IirFilter::shift(const int64_t val) const
     return shift(val, params().shift);
 }
 
-int64_t
-IirFilter::shift(const int64_t val, uint8_t shift) const
-{
-    // prevent left shift of negative number, which is undefined behavior
-    uint64_t sign_mask = (uint64_t(1) << 63);
-    int64_t sign = val & sign_mask;
-    uint64_t abs = val & ~sign_mask;
-    return int64_t(abs << shift) | sign;
-}
 int64_t
 IirFilter::unshift(const int64_t val) const
 {
     return unshift(val, params().shift);
 }
 
-int64_t
-IirFilter::unshift(const int64_t val, uint8_t shift) const
-{
-    auto rounder = uint32_t{1} << (shift - 1);
-    int64_t rounded = val + rounder;
-    return rounded >> shift;
-}
+// definition of the static constexpr member, required before C++17
+constexpr IirFilter::FilterParams IirFilter::availableFilters[];
 
-// Try out these filters in pyFDA to view Magnitude response and stability
 IirFilter::FilterParams const&
 IirFilter::FilterDefinition(uint8_t idx)
 {
-    static const FilterParams availableFilters[] = {
-        // 0 - Bessel 6th order, -60 dB > 1/4 FS, To downsample 2x. -3dB at 0.0575 FS
-        {
-            {
-                34,
-                202,
-                506,
-                675,
-                506,
-                202,
-                34,
-            },
-            {
-                131072,
-                -449749,
-                672637,
-                -556881,
-                267670,
-                -70519,
-                7929,
-            },
-            17,
-            2,
-            20773,
-        },
-        // 1 - Bessel 6th order, -50 dB > 1/4 FS, To downsample 2x. -3dB at 0.069 FS
-        {
-            {
-                77,
-                460,
-                1149,
-                1531,
-                1149,
-                460,
-                77,
-            },
-            {
-                131072,
-                -394137,
-                530035,
-                -401475,
-                178825,
-                -44094,
-                4677,
-            },
-            17,
-            2,
-            24599,
-        },
-        // 2 - Bessel 6th order, -40 dB > 1/8 FS, To downsample 4x. Fc at 0.06125, -3dB at 0.035 FS
-        {
-            {
-                3,
-                18,
-                46,
-                61,
-                46,
-                18,
-                3,
-            },
-            {
-                131072,
-                -569338,
-                1045651,
-                -1037968,
-                586655,
-                -178824,
-                22947,
-            },
-            17,
-            4,
-            13073,
-        },
-    };
-
-    if (idx >= sizeof(availableFilters) / sizeof(availableFilters[0])) {
+    if (idx >= numFilterDefinitions) {
         idx = 0;
     }
     return availableFilters[idx];
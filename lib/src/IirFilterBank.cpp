@@ -0,0 +1,166 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../inc/IirFilterBank.h"
+#include <stdlib.h>
+
+IirFilterBank::IirFilterBank(uint8_t idx, size_t filterCount, int32_t threshold)
+    : xv(taps * filterCount, 0)
+    , yv(taps * filterCount, 0)
+    , acc(filterCount, 0)
+    , count(filterCount)
+    , head(0)
+    , paramsIdx(idx)
+    , fastStepThreshold(threshold)
+{
+}
+
+size_t
+IirFilterBank::add(const int32_t* values)
+{
+    int64_t* x0 = advance();
+    uint8_t inputShift = shiftBits();
+    for (size_t f = 0; f < count; f++) {
+        x0[f] = IirFilter::shift(values[f], inputShift);
+    }
+    return filterNewInput();
+}
+
+size_t
+IirFilterBank::add(const int64_t* values, uint8_t fractionBits)
+{
+    int64_t* x0 = advance();
+    uint8_t inputShift = shiftBits() - fractionBits;
+    for (size_t f = 0; f < count; f++) {
+        x0[f] = IirFilter::shift(values[f], inputShift);
+    }
+    return filterNewInput();
+}
+
+int64_t*
+IirFilterBank::advance()
+{
+    // move the ring index back one slot, the oldest sample is overwritten by the new one
+    head = head == 0 ? taps - 1 : head - 1;
+    return &xv[head * count];
+}
+
+size_t
+IirFilterBank::filterNewInput()
+{
+    auto const& params = IirFilter::FilterDefinition(paramsIdx);
+    const int64_t* x0 = &xv[head * count];
+
+    int64_t* out = acc.data();
+    for (size_t f = 0; f < count; f++) {
+        out[f] = params.b[0] * x0[f];
+    }
+    for (uint8_t i = 1; i <= FILTER_ORDER; i++) {
+        // the sum of integer products does not depend on the order, so accumulating per tap gives the same result
+        const int64_t* x = &xv[index(i, 0)];
+        const int64_t* y = &yv[index(i, 0)];
+        const int64_t b = params.b[i];
+        const int64_t a = params.a[i];
+        for (size_t f = 0; f < count; f++) {
+            out[f] += b * x[f] - a * y[f];
+        }
+    }
+
+    int64_t* y0 = &yv[head * count];
+    const int64_t* y1 = &yv[index(1, 0)];
+    for (size_t f = 0; f < count; f++) {
+        y0[f] = IirFilter::unshift(out[f], params.shift);
+    }
+
+    // step detection, see IirFilter::add
+    int64_t thresholdAtOutPut = uint64_t(fastStepThreshold) * uint64_t(params.maxDerivative);
+    size_t steps = 0;
+    for (size_t f = 0; f < count; f++) {
+        if (abs(y0[f] - y1[f]) >= thresholdAtOutPut) {
+            resetFilter(f, x0[f]);
+            ++steps;
+        }
+    }
+    return steps;
+}
+
+void
+IirFilterBank::reset(size_t filter, const int32_t& value)
+{
+    resetFilter(filter, IirFilter::shift(value, shiftBits()));
+}
+
+void
+IirFilterBank::resetFilter(size_t filter, int64_t value)
+{
+    for (uint8_t i = 0; i < taps; i++) {
+        // set history to same value to prevent instability and ringing after the step
+        xv[i * count + filter] = value;
+        yv[i * count + filter] = value;
+    }
+}
+
+void
+IirFilterBank::setParamsIdx(const uint8_t idx)
+{
+    // reset filters (all history same value) to prevent instability
+    uint8_t newShift = IirFilter::FilterDefinition(idx).shift;
+    std::vector<int64_t> oldValues(count);
+    for (size_t f = 0; f < count; f++) {
+        oldValues[f] = readWithNFractionBits(f, newShift);
+    }
+    paramsIdx = idx;
+    for (size_t f = 0; f < count; f++) {
+        resetFilter(f, oldValues[f]);
+    }
+}
+
+int32_t
+IirFilterBank::read(size_t filter) const
+{
+    return IirFilter::unshift(yv[index(0, filter)], shiftBits());
+}
+
+int32_t
+IirFilterBank::readPrevious(size_t filter) const
+{
+    return IirFilter::unshift(yv[index(1, filter)], shiftBits());
+}
+
+int64_t
+IirFilterBank::readWithNFractionBits(size_t filter, uint8_t bits) const
+{
+    auto shift = shiftBits();
+    if (bits >= shift) {
+        return IirFilter::shift(yv[index(0, filter)], bits - shift);
+    }
+    return IirFilter::unshift(yv[index(0, filter)], shift - bits);
+}
+
+int32_t
+IirFilterBank::readLastInput(size_t filter) const
+{
+    return IirFilter::unshift(xv[index(0, filter)], shiftBits());
+}
+
+IirFilter::DerivativeResult
+IirFilterBank::readDerivative(size_t filter) const
+{
+    return {yv[index(0, filter)] - yv[index(1, filter)], shiftBits()};
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IoArray.h"
+
+namespace {
+// IoArrays with pending writes in the active batch, fixed size so the interrupt never allocates
+constexpr uint8_t maxBatchedArrays = 8;
+IoArray* batchedArrays[maxBatchedArrays];
+uint8_t batchedCount = 0;
+bool batchActive = false;
+}
+
+IoArray::WriteBatch::WriteBatch()
+{
+    batchActive = true;
+}
+
+IoArray::WriteBatch::~WriteBatch()
+{
+    batchActive = false;
+    for (uint8_t i = 0; i < batchedCount; i++) {
+        batchedArrays[i]->flushWrites();
+    }
+    batchedCount = 0;
+}
+
+bool
+IoArray::deferWrite(uint8_t channel)
+{
+    if (!batchActive || channel > 32) {
+        return false;
+    }
+    if (pendingWrites == 0) {
+        if (batchedCount == maxBatchedArrays) {
+            return false;
+        }
+        batchedArrays[batchedCount++] = this;
+    }
+    pendingWrites |= uint32_t{1} << (channel - 1);
+    return true;
+}
+
+bool
+IoArray::flushWrites()
+{
+    auto mask = pendingWrites;
+    pendingWrites = 0;
+    return writeChannelsImpl(mask);
+}
+
+bool
+IoArray::writeChannelsImpl(uint32_t mask)
+{
+    bool success = true;
+    for (uint8_t channel = 1; mask != 0; channel++, mask >>= 1) {
+        if (mask & 1) {
+            success = writeChannelImpl(channel, channels[channel - 1].config) && success;
+        }
+    }
+    return success;
+}
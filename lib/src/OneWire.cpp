@@ -159,6 +159,154 @@ OneWire::select(const OneWireAddress& rom)
     return false;
 }
 
+//
+// Start a temperature conversion on all devices, by skipping ROM select
+//
+
+bool
+OneWire::startConversion()
+{
+    if (conversion.pending()) {
+        // sensors would read the scratchpad before the queued conversion has been started
+        return false;
+    }
+    // the sequence also increases on failure, so sensors read their scratchpad and detect that they are disconnected
+    if (++conversions == 0) {
+        conversions = 1;
+    }
+    bool success = conversion.status() != OneWireTransaction::Status::Failed;
+    uint8_t command = 0x44; // Convert T
+    conversion.prepare(&command, 1, 0);
+    submit(conversion);
+    return success;
+}
+
+//
+// Queued transactions
+//
+
+bool
+OneWire::submit(OneWireTransaction& transaction)
+{
+    if (transaction.pending()) {
+        return false;
+    }
+    transaction.m_step = 0;
+    transaction.m_status = OneWireTransaction::Status::Pending;
+    transactions.push_back(&transaction);
+    process();
+    return true;
+}
+
+void
+OneWire::cancel(OneWireTransaction& transaction)
+{
+    for (auto it = transactions.begin(); it != transactions.end(); ++it) {
+        if (*it == &transaction) {
+            if (it == transactions.begin() && operationStarted) {
+                // the driver still has to finish the operation, ignore its result
+                discardResult = true;
+            }
+            transactions.erase(it);
+            transaction.m_status = OneWireTransaction::Status::Idle;
+            return;
+        }
+    }
+}
+
+void
+OneWire::finishTransaction(OneWireTransaction::Status status)
+{
+    auto& transaction = *transactions.front();
+    transactions.erase(transactions.begin());
+    transaction.m_status = status;
+}
+
+bool
+OneWire::process()
+{
+    using Operation = OneWireLowLevelInterface::Operation;
+    using Progress = OneWireLowLevelInterface::Progress;
+
+    while (true) {
+        if (operationStarted) {
+            uint8_t result = 0;
+            auto progress = driver.poll(result);
+            if (progress == Progress::Busy) {
+                return true;
+            }
+            operationStarted = false;
+            if (discardResult) {
+                discardResult = false;
+                continue;
+            }
+
+            auto& t = *transactions.front();
+            bool selecting = !t.m_skipRom;
+            uint8_t firstRead = 2 + (selecting ? 8 : 0) + t.m_commandCount;
+            if (progress == Progress::Failed || (t.m_step == 0 && !result)) {
+                // no presence pulse on the first reset means there is nothing to talk to
+                finishTransaction(OneWireTransaction::Status::Failed);
+                continue;
+            }
+            if (t.m_step >= firstRead && t.m_step < firstRead + t.m_readCount) {
+                t.m_data[t.m_step - firstRead] = result;
+            }
+            if (++t.m_step == firstRead + t.m_readCount + 1) {
+                finishTransaction(OneWireTransaction::Status::Done);
+            }
+            continue;
+        }
+
+        if (transactions.empty()) {
+            return false;
+        }
+
+        // Steps: reset, select or skip ROM, 8 address bytes when selecting, command bytes, read bytes, final reset
+        auto& t = *transactions.front();
+        bool selecting = !t.m_skipRom;
+        uint8_t addressEnd = 2 + (selecting ? 8 : 0);
+        uint8_t commandEnd = addressEnd + t.m_commandCount;
+        uint8_t readEnd = commandEnd + t.m_readCount;
+        auto step = t.m_step;
+
+        Operation op = Operation::Reset;
+        uint8_t value = 0;
+        if (step == 0 || step == readEnd) {
+            op = Operation::Reset;
+        } else if (step == 1) {
+            op = Operation::Write;
+            value = selecting ? 0x55 : 0xCC; // Choose ROM or skip ROM
+        } else if (step < addressEnd) {
+            op = Operation::Write;
+            value = t.m_address[step - 2];
+        } else if (step < commandEnd) {
+            op = Operation::Write;
+            value = t.m_command[step - addressEnd];
+        } else {
+            op = Operation::Read;
+        }
+
+        if (!driver.start(op, value)) {
+            finishTransaction(OneWireTransaction::Status::Failed);
+            continue;
+        }
+        operationStarted = true;
+    }
+}
+
+bool
+OneWire::process(duration_micros_t budget, const std::function<ticks_micros_t()>& micros)
+{
+    auto start = micros();
+    while (process()) {
+        if (micros() - start >= budget) {
+            return true;
+        }
+    }
+    return false;
+}
+
 //
 // Do a ROM skip
 //
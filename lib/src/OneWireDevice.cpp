@@ -33,6 +33,18 @@ OneWireDevice::OneWireDevice(OneWire& oneWire_, const OneWireAddress& address_)
 {
 }
 
+OneWireDevice::~OneWireDevice()
+{
+    oneWire.cancel(m_transaction);
+}
+
+void
+OneWireDevice::submitRead(const uint8_t* command, uint8_t commandCount, uint8_t readCount)
+{
+    m_transaction.prepare(m_address, command, commandCount, readCount);
+    oneWire.submit(m_transaction);
+}
+
 void
 OneWireDevice::connected(bool _connected)
 {
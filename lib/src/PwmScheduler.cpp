@@ -0,0 +1,146 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PwmScheduler.h"
+#include "IoArray.h"
+#include <algorithm>
+
+namespace {
+// the micros counter wraps, so times are compared by their difference
+bool
+before(ticks_micros_t a, ticks_micros_t b)
+{
+    return int32_t(a - b) < 0;
+}
+}
+
+uint8_t
+PwmScheduler::add(duration_micros_t period, setter_t&& setter, ticks_micros_t now)
+{
+    if (period == 0) {
+        return 0;
+    }
+    for (uint8_t id = 1; id < 255; id++) {
+        if (!find(id)) {
+            channels.push_back(Channel{id, period, 0, now, std::move(setter)});
+            // reserve here, so the interrupt never has to allocate
+            queue.reserve(channels.size());
+            due.reserve(channels.size());
+            schedule(Edge{now, id, true});
+            return id;
+        }
+    }
+    return 0;
+}
+
+void
+PwmScheduler::remove(uint8_t id)
+{
+    unschedule(id);
+    channels.erase(std::remove_if(channels.begin(), channels.end(), [&id](const Channel& c) { return c.id == id; }), channels.end());
+}
+
+void
+PwmScheduler::dutyTime(uint8_t id, duration_micros_t duty)
+{
+    if (auto c = find(id)) {
+        c->dutyTime = std::min(duty, c->period);
+    }
+}
+
+duration_micros_t
+PwmScheduler::dutyTime(uint8_t id) const
+{
+    if (auto c = find(id)) {
+        return c->dutyTime;
+    }
+    return 0;
+}
+
+ticks_micros_t
+PwmScheduler::run(ticks_micros_t now)
+{
+    // edges that become due while handling late edges are handled in the same run
+    while (!queue.empty() && !before(now, queue.front().time)) {
+        due.clear();
+        auto firstLater = std::find_if(queue.cbegin(), queue.cend(), [&now](const Edge& e) { return before(now, e.time); });
+        due.insert(due.end(), queue.cbegin(), firstLater);
+        queue.erase(queue.cbegin(), firstLater);
+
+        // first change all outputs, then schedule their next edges
+        {
+            // each IoArray writes the outputs that toggle now in one call when the batch ends
+            IoArray::WriteBatch batch;
+            for (auto& edge : due) {
+                if (auto c = find(edge.id)) {
+                    if (edge.periodStart) {
+                        // keep the phase when the edge is late, unless a whole period was missed
+                        c->periodStart = before(now, edge.time + c->period) ? edge.time : now;
+                        c->setter(c->dutyTime > 0 ? State::Active : State::Inactive);
+                    } else {
+                        c->setter(State::Inactive);
+                    }
+                }
+            }
+        }
+        for (auto& edge : due) {
+            if (auto c = find(edge.id)) {
+                schedule(next(*c, edge));
+            }
+        }
+    }
+    return queue.empty() ? now : queue.front().time;
+}
+
+PwmScheduler::Edge
+PwmScheduler::next(const Channel& c, const Edge& applied)
+{
+    if (applied.periodStart && c.dutyTime > 0 && c.dutyTime < c.period) {
+        return Edge{c.periodStart + c.dutyTime, c.id, false};
+    }
+    return Edge{c.periodStart + c.period, c.id, true};
+}
+
+PwmScheduler::Channel*
+PwmScheduler::find(uint8_t id)
+{
+    auto match = std::find_if(channels.begin(), channels.end(), [&id](const Channel& c) { return c.id == id; });
+    return match != channels.end() ? &*match : nullptr;
+}
+
+const PwmScheduler::Channel*
+PwmScheduler::find(uint8_t id) const
+{
+    auto match = std::find_if(channels.cbegin(), channels.cend(), [&id](const Channel& c) { return c.id == id; });
+    return match != channels.cend() ? &*match : nullptr;
+}
+
+void
+PwmScheduler::schedule(const Edge& edge)
+{
+    // insert after edges at the same time, so channels toggle in the order they were scheduled
+    auto pos = std::upper_bound(queue.begin(), queue.end(), edge, [](const Edge& a, const Edge& b) { return before(a.time, b.time); });
+    queue.insert(pos, edge);
+}
+
+void
+PwmScheduler::unschedule(uint8_t id)
+{
+    queue.erase(std::remove_if(queue.begin(), queue.end(), [&id](const Edge& e) { return e.id == id; }), queue.end());
+}
@@ -19,36 +19,51 @@
 
 #include "../inc/SetpointProfile.h"
 
+bool
+SetpointProfile::seek(utc_seconds_t elapsed)
+{
+    if (elapsed < m_cursorElapsed) {
+        resetCursor(); // time went back, search from the first point
+    }
+    m_cursorElapsed = elapsed;
+
+    // the segment ends at the first point that is later than the elapsed time
+    bool moved = false;
+    while (m_cursor.valid() && m_cursor.point().time <= elapsed) {
+        m_lower = m_cursor.point();
+        m_hasLower = true;
+        m_cursor.next();
+        moved = true;
+    }
+    return moved;
+}
+
 void
 SetpointProfile::update(const utc_seconds_t& time)
 {
-    struct TimeStampLessEqual {
-        bool operator()(const Point& p, const utc_seconds_t& time) const { return p.time <= time; }
-        bool operator()(const utc_seconds_t& time, const Point& p) const { return time <= p.time; }
-    };
-
     if (!isDriving()) {
         return;
     }
 
     auto newTemp = temp_t(0);
 
-    if (!m_points.empty() && time != 0) {
-
+    if (time != 0) {
         if (m_profileStartTime > time) {
             return;
         }
         auto elapsed = time - m_profileStartTime;
-        auto upper = std::lower_bound(m_points.cbegin(), m_points.cend(), elapsed, TimeStampLessEqual{});
-        if (upper == m_points.cend()) { // every point is in the past, use the last point
+        bool newSegment = seek(elapsed);
+        if (!m_cursor.valid()) { // every point is in the past, use the last point
             newTemp = m_points.back().temp;
-        } else if (upper != m_points.cbegin()) { // first point is not in the future
-            auto lower = upper - 1;
-            auto segmentElapsed = elapsed - lower->time;
-            auto segmentDuration = upper->time - lower->time;
-            auto fraction = safe_elastic_fixed_point<1, 30>(cnl::quotient(segmentElapsed, segmentDuration));
-            auto interpolated = lower->temp + temp_t((upper->temp - lower->temp) * fraction);
-            newTemp = interpolated;
+        } else if (m_hasLower) { // first point is not in the future
+            const auto& upper = m_cursor.point();
+            if (newSegment) {
+                auto delta = int64_t(cnl::unwrap(upper.temp)) - int64_t(cnl::unwrap(m_lower.temp));
+                m_slope = delta * fast_fp::pow2(slopeFractionBits) / int64_t(upper.time - m_lower.time);
+            }
+            auto segmentElapsed = int64_t(elapsed - m_lower.time);
+            auto interpolated = int64_t(cnl::unwrap(m_lower.temp)) + fast_fp::scaleDown(m_slope * segmentElapsed, slopeFractionBits);
+            newTemp = cnl::wrap<temp_t>(int32_t(interpolated));
         } else {
             return;
         }
@@ -57,4 +72,4 @@ SetpointProfile::update(const utc_seconds_t& time)
             targetPtr->settingValid(true);
         }
     }
-}
\ No newline at end of file
+}
@@ -35,13 +35,21 @@ tempDiff_to_string(const temp_t& t, uint8_t decimals, const TempUnit& unit)
     return to_string_dec(val, decimals);
 }
 
-std::string
-temp_to_string(const temp_t& t, uint8_t decimals, const TempUnit& unit)
+uint8_t
+temp_to_chars(const temp_t& t, uint8_t decimals, const TempUnit& unit, char* buf, uint8_t len)
 {
     fp12_t val = t;
     if (unit == TempUnit::Fahrenheit) {
         val = scale_fahrenheit(t);
         val += fp12_t(32);
     }
-    return to_string_dec(val, decimals);
+    return to_chars_dec(val, decimals, buf, len);
+}
+
+std::string
+temp_to_string(const temp_t& t, uint8_t decimals, const TempUnit& unit)
+{
+    char buf[12];
+    temp_to_chars(t, decimals, unit, buf, sizeof(buf));
+    return std::string(buf);
 }
\ No newline at end of file
@@ -243,3 +243,56 @@ DS248x::search_triplet(bool search_direction)
     busyWait();
     return mStatus;
 }
+
+bool
+DS248x::start(Operation op, uint8_t value)
+{
+    // The caller only starts a new operation after poll() returned done, so the DS248X is idle here
+    Wire.beginTransmission(mAddress);
+    switch (op) {
+    case Operation::Reset:
+        Wire.write(DS248X_1WRS);
+        break;
+    case Operation::Write:
+        Wire.write(DS248X_1WWB);
+        Wire.write(value);
+        break;
+    case Operation::Read:
+        Wire.write(DS248X_1WRB);
+        break;
+    }
+    mPendingOperation = op;
+    return Wire.endTransmission() == 0;
+}
+
+DS248x::Progress
+DS248x::poll(uint8_t& result)
+{
+    // After a 1-Wire command, the read pointer is set to the status register
+    if (!Wire.requestFrom(mAddress, size_t{1})) {
+        init();
+        return Progress::Failed;
+    }
+    mStatus = Wire.read();
+    if (mStatus & DS248X_STATUS_BUSY) {
+        return Progress::Busy;
+    }
+
+    switch (mPendingOperation) {
+    case Operation::Reset:
+        result = (mStatus & DS248X_STATUS_PPD) ? 1 : 0;
+        break;
+    case Operation::Write:
+        break;
+    case Operation::Read:
+        Wire.beginTransmission(mAddress);
+        Wire.write(DS248X_SRP);
+        Wire.write(PTR_READ);
+        if (Wire.endTransmission() != 0 || !Wire.requestFrom(mAddress, size_t{1})) {
+            return Progress::Failed;
+        }
+        result = Wire.read();
+        break;
+    }
+    return Progress::Done;
+}
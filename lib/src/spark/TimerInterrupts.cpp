@@ -1,15 +1,25 @@
 #include "TimerInterrupts.h"
 #include "spark_wiring_interrupts.h"
-#include <algorithm>
-#include <functional>
-#include <vector>
+#include "timer_hal.h"
 
-struct FuncEntry {
-    uint8_t id;
-    std::function<void()> func;
-};
+static PwmScheduler scheduler;
 
-static std::vector<FuncEntry> funcs;
+// the counter has 16 bits, so an edge that is further away than this takes more than one interrupt
+static constexpr duration_micros_t maxTimerDelay = 60000;
+
+static void
+startTimer(ticks_micros_t nextEdge)
+{
+    auto delay = int32_t(nextEdge - HAL_Timer_Get_Micro_Seconds());
+    if (delay < 1) {
+        delay = 1;
+    } else if (delay > int32_t(maxTimerDelay)) {
+        delay = maxTimerDelay;
+    }
+    TIM_SetCounter(TIM4, 0);
+    TIM_SetAutoreload(TIM4, delay);
+    TIM_Cmd(TIM4, ENABLE);
+}
 
 void
 timerIsrHandler()
@@ -17,9 +27,11 @@ timerIsrHandler()
     if (TIM_GetITStatus(TIM4, TIM_IT_Update) != RESET) {
         TIM_ClearITPendingBit(TIM4, TIM_IT_Update);
 
-        for (auto& fe : funcs) {
-            fe.func();
+        if (scheduler.empty()) {
+            TIM_Cmd(TIM4, DISABLE);
+            return;
         }
+        startTimer(scheduler.run(HAL_Timer_Get_Micro_Seconds()));
     }
 }
 
@@ -37,45 +49,49 @@ TimerInterrupts::init()
     nvicStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&nvicStructure);
 
-    // Timebase configuration (10 kHz), so we can get 100 steps resolution for 100Hz PWM
-    // SysCoreClock = 120 Mhz, timer clock is 60MHz, 60Mhz / 6000 = 10kHz
+    // Timebase configuration (1 MHz), so PWM edges have microsecond resolution
+    // SysCoreClock = 120 Mhz, timer clock is 60MHz, 60Mhz / 60 = 1MHz
     TIM_TimeBaseInitTypeDef timerInitStructure;
-    timerInitStructure.TIM_Prescaler = 5; // divides by 6
+    timerInitStructure.TIM_Prescaler = 59; // divides by 60
     timerInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
-    timerInitStructure.TIM_Period = 1000;
+    timerInitStructure.TIM_Period = maxTimerDelay;
     timerInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
     timerInitStructure.TIM_RepetitionCounter = 0;
 
     TIM_TimeBaseInit(TIM4, &timerInitStructure);
     TIM_ITConfig(TIM4, TIM_IT_Update, ENABLE);
-    TIM_Cmd(TIM4, ENABLE);
+    // the timer is started when the first PWM channel is added
 
     attachSystemInterrupt(SysInterrupt_TIM4_Update, timerIsrHandler);
 }
 
-int16_t
-TimerInterrupts::add(std::function<void()>&& func)
+uint8_t
+TimerInterrupts::addPwm(duration_micros_t period, PwmScheduler::setter_t&& setter)
 {
-    for (uint8_t id = 1; id < 255; id++) {
-        // find free id
-        auto match = find_if(funcs.begin(), funcs.end(), [&id](const FuncEntry& fe) {
-            return fe.id == id;
-        });
-
-        if (match == funcs.end()) {
-            funcs.push_back(FuncEntry{id, std::move(func)});
-            TIM_Cmd(TIM4, ENABLE);
-            return id;
-        }
-    };
-    return 0;
+    NVIC_DisableIRQ(TIM4_IRQn);
+    auto id = scheduler.add(period, std::move(setter), HAL_Timer_Get_Micro_Seconds());
+    if (!scheduler.empty()) {
+        startTimer(scheduler.run(HAL_Timer_Get_Micro_Seconds()));
+    }
+    NVIC_EnableIRQ(TIM4_IRQn);
+    return id;
 }
 
 void
-TimerInterrupts::remove(uint8_t id)
+TimerInterrupts::removePwm(uint8_t id)
 {
-    funcs.erase(std::remove_if(funcs.begin(), funcs.end(), [&id](const FuncEntry& fe) { return fe.id == id; }), funcs.end());
-    if (funcs.empty()) {
+    NVIC_DisableIRQ(TIM4_IRQn);
+    scheduler.remove(id);
+    if (scheduler.empty()) {
         TIM_Cmd(TIM4, DISABLE);
     }
+    NVIC_EnableIRQ(TIM4_IRQn);
+}
+
+void
+TimerInterrupts::pwmDutyTime(uint8_t id, duration_micros_t duty)
+{
+    NVIC_DisableIRQ(TIM4_IRQn);
+    scheduler.dutyTime(id, duty);
+    NVIC_EnableIRQ(TIM4_IRQn);
 }
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "../inc/DeltaPointList.h"
+#include <random>
+#include <vector>
+
+SCENARIO("A delta encoded point list returns the points that were added", "[SetpointProfile]")
+{
+    DeltaPointList list;
+
+    WHEN("The list is empty, the reader is not valid")
+    {
+        CHECK(list.empty());
+        CHECK(!list.begin().valid());
+        CHECK(list.decode().empty());
+    }
+
+    WHEN("Points are added, they are read back in the same order")
+    {
+        std::mt19937 gen(1234);
+        std::uniform_int_distribution<int64_t> time(0, std::numeric_limits<utc_seconds_t>::max());
+        std::uniform_int_distribution<int32_t> temp(-(1 << 23) + 1, (1 << 23) - 1);
+        std::vector<DeltaPointList::Point> points;
+        // unsorted times and temperatures over the full range
+        for (int i = 0; i < 1000; i++) {
+            points.push_back(DeltaPointList::Point{utc_seconds_t(time(gen)), cnl::wrap<temp_t>(temp(gen))});
+        }
+        for (auto& p : points) {
+            list.push_back(p);
+        }
+        CHECK(list.size() == points.size());
+        CHECK(list.back().time == points.back().time);
+
+        size_t mismatches = 0;
+        size_t count = 0;
+        for (auto reader = list.begin(); reader.valid(); reader.next()) {
+            auto& p = points[reader.index()];
+            mismatches += reader.point().time != p.time || reader.point().temp != p.temp;
+            ++count;
+        }
+        CHECK(count == points.size());
+        CHECK(mismatches == 0);
+
+        AND_WHEN("The list is cleared, it is empty")
+        {
+            list.clear();
+            CHECK(list.empty());
+            CHECK(list.encodedSize() == 0);
+            CHECK(!list.begin().valid());
+        }
+    }
+
+    WHEN("The points are a typical fermentation profile, they take less space than the decoded points")
+    {
+        // a point every 6 hours for 30 days, slowly ramping the temperature up and down
+        for (int i = 0; i < 120; i++) {
+            list.push_back(DeltaPointList::Point{utc_seconds_t(i * 6 * 3600), temp_t(18) + temp_t(0.25) * int8_t(i % 20)});
+        }
+        auto decoded = list.decode();
+        REQUIRE(decoded.size() == 120);
+        CHECK(decoded[7].time == 7 * 6 * 3600);
+        CHECK(decoded[7].temp == temp_t(19.75));
+        CHECK(list.encodedSize() < decoded.size() * sizeof(DeltaPointList::Point) * 3 / 4);
+    }
+}
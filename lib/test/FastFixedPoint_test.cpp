@@ -0,0 +1,240 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "../inc/FastFixedPoint.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+using integral_t = safe_elastic_fixed_point<18, 12>;
+using derivative_t = safe_elastic_fixed_point<1, 23>;
+
+template <class T>
+int64_t
+rawMax()
+{
+    return fast_fp::raw(cnl::numeric_limits<T>::max());
+}
+
+template <class T>
+int64_t
+rawLowest()
+{
+    return fast_fp::raw(cnl::numeric_limits<T>::lowest());
+}
+
+// Half of the values are picked from the full range of the type, the other half are small.
+// Small values are common on the control path and are where rounding differences would show.
+template <class T>
+T
+randomValue(std::mt19937& gen)
+{
+    std::uniform_int_distribution<int64_t> full(rawLowest<T>(), rawMax<T>());
+    std::uniform_int_distribution<int64_t> small(-5000, 5000);
+    return cnl::wrap<T>(gen() & 1 ? full(gen) : small(gen));
+}
+
+template <class T>
+T
+randomInteger(std::mt19937& gen)
+{
+    std::uniform_int_distribution<T> full(0, std::numeric_limits<T>::max());
+    std::uniform_int_distribution<T> small(0, 2000);
+    return gen() & 1 ? full(gen) : small(gen);
+}
+
+template <class T>
+T
+randomDivisor(std::mt19937& gen)
+{
+    auto v = randomValue<T>(gen);
+    return v == 0 ? T{1} : v;
+}
+
+// returns the number of results that differ between cnl and the fast primitives
+template <class To, class GenA, class GenB>
+int
+countMultiplyMismatches(GenA genA, GenB genB)
+{
+    int mismatches = 0;
+    for (int i = 0; i < 20000; i++) {
+        auto a = genA();
+        auto b = genB();
+        To expected = a * b;
+        mismatches += expected != fast_fp::multiply<To>(a, b);
+    }
+    return mismatches;
+}
+
+template <class To, class GenA, class GenB>
+int
+countQuotientMismatches(GenA genA, GenB genB)
+{
+    int mismatches = 0;
+    for (int i = 0; i < 20000; i++) {
+        auto a = genA();
+        auto b = genB();
+        To expected = cnl::quotient(a, b);
+        mismatches += expected != fast_fp::quotient<To>(a, b);
+    }
+    return mismatches;
+}
+
+}
+
+SCENARIO("Fast fixed point primitives give the same results as cnl", "[fixedpoint]")
+{
+    std::mt19937 gen(1234);
+    auto randomFp12 = [&gen]() { return randomValue<fp12_t>(gen); };
+
+    WHEN("Values are multiplied, as in Pid")
+    {
+        CHECK(countMultiplyMismatches<fp12_t>(randomFp12, randomFp12) == 0);
+        CHECK(countMultiplyMismatches<fp12_t>(
+                  [&gen]() { return randomValue<derivative_t>(gen); },
+                  [&gen]() { return randomInteger<uint16_t>(gen); })
+              == 0);
+        CHECK(countMultiplyMismatches<fp12_t>(
+                  [&gen]() { return randomValue<integral_t>(gen); },
+                  [&gen]() { return randomValue<safe_elastic_fixed_point<4, 27>>(gen); })
+              == 0);
+        CHECK(countMultiplyMismatches<integral_t>(
+                  [&gen]() { return randomValue<integral_t>(gen); },
+                  [&gen]() { return randomValue<safe_elastic_fixed_point<15, 15>>(gen); })
+              == 0);
+        CHECK(countMultiplyMismatches<integral_t>(
+                  [&gen]() { return randomInteger<uint16_t>(gen); },
+                  [&gen]() { return randomValue<safe_elastic_fixed_point<14, 16>>(gen); })
+              == 0);
+    }
+
+    WHEN("Values are divided, as in Pid and ActuatorPwm")
+    {
+        auto divisorFp12 = [&gen]() { return randomDivisor<fp12_t>(gen); };
+        CHECK(countQuotientMismatches<integral_t>(
+                  [&gen]() { return randomValue<fp12_t>(gen) + randomValue<fp12_t>(gen); },
+                  divisorFp12)
+              == 0);
+        CHECK(countQuotientMismatches<safe_elastic_fixed_point<4, 27>>(
+                  randomFp12,
+                  [&gen]() { return uint16_t(randomInteger<uint16_t>(gen) | 1); })
+              == 0);
+        CHECK(countQuotientMismatches<safe_elastic_fixed_point<15, 15>>(randomFp12, divisorFp12) == 0);
+        CHECK(countQuotientMismatches<safe_elastic_fixed_point<14, 16>>(randomFp12, divisorFp12) == 0);
+        CHECK(countQuotientMismatches<fp12_t>(
+                  [&gen]() { return randomValue<fp12_t>(gen) + randomValue<fp12_t>(gen) + randomValue<fp12_t>(gen) - randomValue<fp12_t>(gen); },
+                  divisorFp12)
+              == 0);
+        CHECK(countQuotientMismatches<safe_elastic_fixed_point<2, 28>>(
+                  [&gen]() { return randomValue<fp12_t>(gen) + (cnl::numeric_limits<fp12_t>::min() >> 1); },
+                  []() { return fp12_t{100}; })
+              == 0);
+    }
+
+    WHEN("The result does not fit in the target type, it saturates")
+    {
+        auto max = cnl::numeric_limits<fp12_t>::max();
+        auto lowest = cnl::numeric_limits<fp12_t>::lowest();
+        CHECK(fast_fp::multiply<fp12_t>(max, max) == fp12_t(max * max));
+        CHECK(fast_fp::multiply<fp12_t>(max, max) == max);
+        CHECK(fast_fp::multiply<fp12_t>(lowest, max) == fp12_t(lowest * max));
+        CHECK(fast_fp::multiply<fp12_t>(lowest, max) == lowest);
+        CHECK(fast_fp::quotient<fp12_t>(max, cnl::wrap<fp12_t>(1)) == fp12_t(cnl::quotient(max, cnl::wrap<fp12_t>(1))));
+        CHECK(fast_fp::quotient<fp12_t>(lowest, cnl::wrap<fp12_t>(1)) == fp12_t(cnl::quotient(lowest, cnl::wrap<fp12_t>(1))));
+    }
+
+    WHEN("Fraction bits are dropped from a negative result, it is truncated toward zero")
+    {
+        auto tiny = cnl::wrap<fp12_t>(-1);
+        auto half = fp12_t{0.5};
+        CHECK(fast_fp::multiply<fp12_t>(tiny, half) == fp12_t(tiny * half));
+        CHECK(fast_fp::multiply<fp12_t>(tiny, half) == fp12_t{0});
+        CHECK(fast_fp::quotient<fp12_t>(tiny, fp12_t{2}) == fp12_t(cnl::quotient(tiny, fp12_t{2})));
+        CHECK(fast_fp::quotient<fp12_t>(tiny, fp12_t{-2}) == fp12_t(cnl::quotient(tiny, fp12_t{-2})));
+    }
+
+    WHEN("A value is converted to a type with fewer fraction bits, cnl truncates toward zero like scaleDown")
+    {
+        using fine_t = safe_elastic_fixed_point<4, 27>;
+        constexpr int droppedBits = 27 - 12;
+        CHECK(fp12_t(cnl::wrap<fine_t>(-1)) == fp12_t{0});
+        CHECK(fp12_t(cnl::wrap<fine_t>(1)) == fp12_t{0});
+        CHECK(fp12_t(cnl::wrap<fine_t>(-(int64_t(1) << droppedBits) - 1)) == cnl::wrap<fp12_t>(-1));
+        CHECK(fp12_t(cnl::wrap<fine_t>((int64_t(1) << droppedBits) + 1)) == cnl::wrap<fp12_t>(1));
+
+        int mismatches = 0;
+        for (int i = 0; i < 20000; i++) {
+            auto v = randomValue<fine_t>(gen);
+            mismatches += fast_fp::raw(fp12_t(v)) != fast_fp::scaleDown(fast_fp::raw(v), droppedBits);
+            auto d = randomValue<derivative_t>(gen);
+            mismatches += fast_fp::raw(fp12_t(d)) != fast_fp::scaleDown(fast_fp::raw(d), 23 - 12);
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+// Run with --durations yes to compare the time spent in each section
+TEST_CASE("Benchmark PID calculations with cnl versus the fast fixed point primitives", "[.][benchmark]")
+{
+    const int samples = 200000;
+    std::mt19937 gen(1234);
+    std::vector<fp12_t> errors;
+    std::vector<derivative_t> derivatives;
+    for (int i = 0; i < 1000; i++) {
+        errors.push_back(cnl::wrap<fp12_t>(std::uniform_int_distribution<int32_t>(-40000, 40000)(gen)));
+        derivatives.push_back(cnl::wrap<derivative_t>(std::uniform_int_distribution<int32_t>(-4000, 4000)(gen)));
+    }
+    const fp12_t kp = 10;
+    const uint16_t ti = 2000;
+    const uint16_t td = 200;
+
+    SECTION("cnl")
+    {
+        integral_t integral = 0;
+        int64_t sum = 0;
+        for (int s = 0; s < samples; s++) {
+            auto error = errors[s % errors.size()];
+            fp12_t p = kp * error;
+            fp12_t d = -kp * fp12_t(derivatives[s % derivatives.size()] * td);
+            integral += integral_t(cnl::quotient(p + d, kp));
+            fp12_t i = integral * safe_elastic_fixed_point<4, 27>(cnl::quotient(kp, ti));
+            sum += cnl::unwrap(p) + cnl::unwrap(i) + cnl::unwrap(d);
+        }
+        CHECK(sum != 0);
+    }
+
+    SECTION("fast fixed point")
+    {
+        integral_t integral = 0;
+        int64_t sum = 0;
+        for (int s = 0; s < samples; s++) {
+            auto error = errors[s % errors.size()];
+            auto p = fast_fp::multiply<fp12_t>(kp, error);
+            auto d = fast_fp::multiply<fp12_t>(-kp, fast_fp::multiply<fp12_t>(derivatives[s % derivatives.size()], td));
+            integral += fast_fp::quotient<integral_t>(p + d, kp);
+            auto i = fast_fp::multiply<fp12_t>(integral, fast_fp::quotient<safe_elastic_fixed_point<4, 27>>(kp, ti));
+            sum += cnl::unwrap(p) + cnl::unwrap(i) + cnl::unwrap(d);
+        }
+        CHECK(sum != 0);
+    }
+}
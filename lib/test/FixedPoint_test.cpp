@@ -489,4 +489,29 @@ SCENARIO("CNL fixed point formats", "[fixedpoint]")
             REQUIRE(to_string_dec(t, 2) == s);
         }
     }
+
+    WHEN("temp_t is written to a char buffer")
+    {
+        char buf[12];
+        CHECK(to_chars_dec(temp_t(10), 1, buf, sizeof(buf)) == 4);
+        CHECK(std::string(buf) == "10.0");
+        CHECK(to_chars_dec(temp_t(-0.01), 2, buf, sizeof(buf)) == 5);
+        CHECK(std::string(buf) == "-0.01");
+        CHECK(to_chars_dec(temp_t(-500), 3, buf, sizeof(buf)) == 8);
+        CHECK(std::string(buf) == "-500.000");
+        CHECK(to_chars_dec(temp_t(21.5), 0, buf, sizeof(buf)) == 2);
+        CHECK(std::string(buf) == "22");
+
+        THEN("A string that exactly fits with its terminating zero is written")
+        {
+            CHECK(to_chars_dec(temp_t(-10), 1, buf, 6) == 5);
+            CHECK(std::string(buf) == "-10.0");
+        }
+
+        THEN("A string that does not fit is not written and the buffer is left empty")
+        {
+            CHECK(to_chars_dec(temp_t(-10), 1, buf, 5) == 0);
+            CHECK(std::string(buf) == "");
+        }
+    }
 }
@@ -21,8 +21,111 @@
 
 #include "../inc/FilterChain.h"
 #include "TestMatchers.hpp"
+#include <random>
 #include <sstream>
 
+namespace {
+
+// Reference implementations of the filter history of a given order, using the first Order + 1 coefficients of
+// filter 0. One shifts the whole history for each sample, the other moves a ring index like IirFilter.
+// They are used to check that the ring index gives the same results and to measure the gain per filter order.
+template <uint8_t Order>
+class ShiftingHistory {
+    int64_t xv[Order + 1] = {0};
+    int64_t yv[Order + 1] = {0};
+
+public:
+    int64_t add(int64_t x)
+    {
+        auto const& params = IirFilter::FilterDefinition(0);
+        for (uint8_t i = Order; i >= 1; i--) {
+            xv[i] = xv[i - 1];
+            yv[i] = yv[i - 1];
+        }
+        xv[0] = x;
+        int64_t output = params.b[0] * xv[0];
+        for (uint8_t i = 1; i <= Order; i++) {
+            output += params.b[i] * xv[i];
+            output -= params.a[i] * yv[i];
+        }
+        yv[0] = (output + (int64_t(1) << (params.shift - 1))) >> params.shift;
+        return yv[0];
+    }
+};
+
+template <uint8_t Order>
+class RingHistory {
+    int64_t xv[Order + 1] = {0};
+    int64_t yv[Order + 1] = {0};
+    uint8_t head = 0;
+
+public:
+    int64_t add(int64_t x)
+    {
+        auto const& params = IirFilter::FilterDefinition(0);
+        head = head == 0 ? Order : head - 1;
+        xv[head] = x;
+        int64_t output = params.b[0] * xv[head];
+        uint8_t idx = head;
+        for (uint8_t i = 1; i <= Order; i++) {
+            idx = idx == Order ? 0 : idx + 1;
+            output += params.b[i] * xv[idx];
+            output -= params.a[i] * yv[idx];
+        }
+        yv[head] = (output + (int64_t(1) << (params.shift - 1))) >> params.shift;
+        return yv[head];
+    }
+};
+
+template <uint8_t Order>
+void
+checkRingMatchesShifting()
+{
+    CAPTURE(Order);
+    ShiftingHistory<Order> shifting;
+    RingHistory<Order> ring;
+    std::mt19937 gen(Order);
+    std::uniform_int_distribution<int32_t> input(0, 1 << 20);
+    int mismatches = 0;
+    for (int i = 0; i < 1000; i++) {
+        int64_t x = int64_t(input(gen)) << 17;
+        if (shifting.add(x) != ring.add(x)) {
+            ++mismatches;
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+template <uint8_t Order>
+void
+benchmarkHistory(const std::vector<int64_t>& inputs)
+{
+    DYNAMIC_SECTION("Shifting history, order " << int(Order))
+    {
+        ShiftingHistory<Order> filter;
+        int64_t sum = 0;
+        for (int repeat = 0; repeat < 100; repeat++) {
+            for (auto x : inputs) {
+                sum += filter.add(x);
+            }
+        }
+        CHECK(sum != 0);
+    }
+    DYNAMIC_SECTION("Ring history, order " << int(Order))
+    {
+        RingHistory<Order> filter;
+        int64_t sum = 0;
+        for (int repeat = 0; repeat < 100; repeat++) {
+            for (auto x : inputs) {
+                sum += filter.add(x);
+            }
+        }
+        CHECK(sum != 0);
+    }
+}
+
+}
+
 SCENARIO("Filtering 24-bit values with IIR Filters", "[filter]")
 {
     for (uint8_t i = 0; i <= 1; i++) {
@@ -266,3 +369,83 @@ SCENARIO("Filtering 24-bit values with IIR Filters", "[filter]")
         CHECK(filter.unityStepDerivative() == IirFilter::FilterDefinition(0).maxDerivative);
     }
 }
+
+SCENARIO("The IIR filter history is a ring instead of an array that is shifted", "[filter]")
+{
+    WHEN("The same input is added to a filter with a ring and a filter that shifts its history, the output is equal")
+    {
+        checkRingMatchesShifting<2>();
+        checkRingMatchesShifting<4>();
+        checkRingMatchesShifting<6>();
+    }
+
+    WHEN("IirFilter is compared with the shifting reference of the full order")
+    {
+        IirFilter filter(0, INT32_MAX);
+        ShiftingHistory<FILTER_ORDER> reference;
+        std::mt19937 gen(1);
+        std::uniform_int_distribution<int32_t> input(0, 1 << 20);
+        int mismatches = 0;
+        int derivativeMismatches = 0;
+        int64_t previous = 0;
+        int64_t beforePrevious = 0;
+        for (int i = 0; i < 1000; i++) {
+            int32_t x = input(gen);
+            filter.add(x);
+            int64_t out = reference.add(int64_t(x) << filter.fractionBits());
+            if (filter.readWithNFractionBits(filter.fractionBits()) != out) {
+                ++mismatches;
+            }
+            if (filter.readDerivative().result != out - previous
+                || filter.readPreviousDerivative().result != previous - beforePrevious) {
+                ++derivativeMismatches;
+            }
+            beforePrevious = previous;
+            previous = out;
+        }
+        CHECK(mismatches == 0);
+        CHECK(derivativeMismatches == 0);
+    }
+}
+
+// Run with --durations yes to compare the time spent per sample for each filter order
+TEST_CASE("Benchmark shifting versus ring filter history", "[.][benchmark]")
+{
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int32_t> input(0, 1 << 20);
+    std::vector<int64_t> inputs(10000);
+    for (auto& x : inputs) {
+        x = int64_t(input(gen)) << 17;
+    }
+
+    benchmarkHistory<1>(inputs);
+    benchmarkHistory<2>(inputs);
+    benchmarkHistory<4>(inputs);
+    benchmarkHistory<6>(inputs);
+
+    SECTION("IirFilter")
+    {
+        IirFilter filter(0);
+        int64_t sum = 0;
+        for (int repeat = 0; repeat < 100; repeat++) {
+            for (auto x : inputs) {
+                filter.add(x, 17);
+                sum += filter.read();
+            }
+        }
+        CHECK(sum != 0);
+    }
+
+    SECTION("FilterChain with 6 stages")
+    {
+        FilterChain chain({0, 1, 1, 1, 1, 1});
+        int64_t sum = 0;
+        for (int repeat = 0; repeat < 100; repeat++) {
+            for (auto x : inputs) {
+                chain.add(int32_t(x >> 17));
+                sum += chain.read();
+            }
+        }
+        CHECK(sum != 0);
+    }
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "../inc/IirFilter.h"
+#include "../inc/IirFilterBank.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+// a noisy signal with occasional steps, different for each filter
+std::vector<int32_t>
+makeInputs(std::mt19937& gen, size_t count, int32_t step)
+{
+    std::uniform_int_distribution<int32_t> noise(-2000, 2000);
+    std::uniform_int_distribution<int> stepChance(0, 99);
+    std::vector<int32_t> inputs(count);
+    for (size_t f = 0; f < count; f++) {
+        inputs[f] = int32_t(f) * 100000 + noise(gen) + (stepChance(gen) == 0 ? step : 0);
+    }
+    return inputs;
+}
+
+}
+
+SCENARIO("A bank of IIR filters gives the same results as separate filters", "[filter]")
+{
+    const size_t count = 13; // not a multiple of any vector width
+    std::mt19937 gen(1234);
+
+    for (uint8_t idx = 0; idx <= 2; idx++) {
+        for (int32_t threshold : {std::numeric_limits<int32_t>::max(), 5000}) {
+            CAPTURE(idx, threshold);
+            IirFilterBank bank(idx, count, threshold);
+            std::vector<std::unique_ptr<IirFilter>> filters;
+            for (size_t f = 0; f < count; f++) {
+                filters.push_back(std::make_unique<IirFilter>(idx, threshold));
+            }
+
+            size_t mismatches = 0;
+            size_t bankSteps = 0;
+            size_t filterSteps = 0;
+            for (int sample = 0; sample < 1000; sample++) {
+                auto inputs = makeInputs(gen, count, 200000);
+                bankSteps += bank.add(inputs.data());
+                for (size_t f = 0; f < count; f++) {
+                    filterSteps += filters[f]->add(inputs[f]) ? 1 : 0;
+                    if (bank.read(f) != filters[f]->read()
+                        || bank.readPrevious(f) != filters[f]->readPrevious()
+                        || bank.readDerivative(f).result != filters[f]->readDerivative().result
+                        || bank.readLastInput(f) != filters[f]->readLastInput()
+                        || bank.readWithNFractionBits(f, 20) != filters[f]->readWithNFractionBits(20)) {
+                        ++mismatches;
+                    }
+                }
+            }
+            CHECK(mismatches == 0);
+            CHECK(bankSteps == filterSteps);
+            if (threshold == 5000) {
+                CHECK(bankSteps > 0);
+            }
+
+            // inputs with fraction bits
+            std::vector<int64_t> wide(count);
+            for (size_t f = 0; f < count; f++) {
+                wide[f] = int64_t(f) << 20;
+            }
+            bank.add(wide.data(), 8);
+            for (size_t f = 0; f < count; f++) {
+                filters[f]->add(wide[f], 8);
+                CHECK(bank.read(f) == filters[f]->read());
+            }
+
+            // changing the filter parameters and resetting the history
+            bank.setParamsIdx(2 - idx);
+            bank.reset(3, 12345);
+            for (size_t f = 0; f < count; f++) {
+                filters[f]->setParamsIdx(2 - idx);
+            }
+            filters[3]->reset(12345);
+
+            auto inputs = makeInputs(gen, count, 0);
+            bank.add(inputs.data());
+            for (size_t f = 0; f < count; f++) {
+                filters[f]->add(inputs[f]);
+                CHECK(bank.read(f) == filters[f]->read());
+            }
+            CHECK(bank.getParamsIdx() == 2 - idx);
+            CHECK(bank.fractionBits() == filters[0]->fractionBits());
+        }
+    }
+}
+
+// Run with --durations yes to compare the time spent in each section
+TEST_CASE("Benchmark IIR filter bank versus separate filters", "[.][benchmark]")
+{
+    const int samples = 10000;
+    for (size_t count : {4, 32, 256}) {
+        std::mt19937 gen(1234);
+        auto inputs = makeInputs(gen, count, 0);
+
+        DYNAMIC_SECTION("Separate filters, " << count << " filters")
+        {
+            std::vector<std::unique_ptr<IirFilter>> filters;
+            for (size_t f = 0; f < count; f++) {
+                filters.push_back(std::make_unique<IirFilter>(0));
+            }
+            int64_t sum = 0;
+            for (int s = 0; s < samples; s++) {
+                for (size_t f = 0; f < count; f++) {
+                    filters[f]->add(inputs[f]);
+                    sum += filters[f]->read();
+                }
+            }
+            CHECK(sum != 0);
+        }
+
+        DYNAMIC_SECTION("Filter bank, " << count << " filters")
+        {
+            IirFilterBank bank(0, count);
+            int64_t sum = 0;
+            for (int s = 0; s < samples; s++) {
+                bank.add(inputs.data());
+                for (size_t f = 0; f < count; f++) {
+                    sum += bank.read(f);
+                }
+            }
+            CHECK(sum != 0);
+        }
+    }
+}
@@ -21,6 +21,7 @@
 
 #include "../inc/IntervalHelper.h"
 #include <stdlib.h> /* srand, rand */
+#include <vector>
 
 SCENARIO("IntervalHelper test")
 {
@@ -54,4 +55,39 @@ SCENARIO("IntervalHelper test")
         testInterval(1500);
         testInterval(3000);
     }
+
+    WHEN("Updates are pulled by an input that updates at the same interval, updates follow the phase of the input")
+    {
+        IntervalHelper<1000> ivh;
+        bool doUpdate = false;
+        CHECK(ivh.update(800, doUpdate) == 1000);
+        CHECK(doUpdate);
+
+        std::vector<ticks_millis_t> updates;
+        ticks_millis_t nextUpdate = 1000;
+        ticks_millis_t nextInput = 1000;
+        for (ticks_millis_t now = 1000; now < 10'000; now++) {
+            doUpdate = false;
+            if (now == nextInput) {
+                nextUpdate = ivh.pull(now, doUpdate);
+                nextInput += 1000;
+            } else if (now == nextUpdate) {
+                nextUpdate = ivh.update(now, doUpdate);
+            }
+            if (doUpdate) {
+                updates.push_back(now);
+            }
+        }
+        // the first pull is too soon after the update at 800 and waits for half an interval
+        CHECK(updates == std::vector<ticks_millis_t>{1300, 2000, 3000, 4000, 5000, 6000, 7000, 8000, 9000});
+
+        AND_WHEN("A pull comes too soon after the previous update, the update waits until half an interval has passed")
+        {
+            doUpdate = false;
+            CHECK(ivh.pull(9200, doUpdate) == 9500);
+            CHECK_FALSE(doUpdate);
+            CHECK(ivh.update(9500, doUpdate) == 10500);
+            CHECK(doUpdate);
+        }
+    }
 }
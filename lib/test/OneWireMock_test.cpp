@@ -28,6 +28,8 @@
 #include "DS2413.h"
 #include "DS2413Mock.h"
 #include "MotorValve.h"
+#include <memory>
+#include <vector>
 
 namespace Catch {
 template <>
@@ -513,3 +515,237 @@ SCENARIO("A mocked OneWire bus and mocked slaves", "[onewire]")
         }
     }
 }
+
+SCENARIO("Temperature conversions can be started for all sensors on a bus with a single command", "[onewire]")
+{
+    OneWireMockDriver owMock;
+    OneWire ow(owMock);
+
+    std::vector<std::shared_ptr<DS18B20Mock>> mocks;
+    std::vector<std::unique_ptr<DS18B20>> sensors;
+    for (uint64_t i = 0; i < 20; i++) {
+        auto addr = makeValidAddress(0x0011223344550028 + (i << 8));
+        mocks.push_back(std::make_shared<DS18B20Mock>(addr));
+        owMock.attach(mocks.back());
+        sensors.push_back(std::make_unique<DS18B20>(ow, addr));
+    }
+
+    auto updateAll = [&sensors]() {
+        for (auto& sensor : sensors) {
+            sensor->update();
+        }
+    };
+
+    auto conversions = [&mocks]() {
+        uint32_t total = 0;
+        for (auto& mock : mocks) {
+            total += mock->conversionCount();
+        }
+        return total;
+    };
+
+    WHEN("Each sensor starts its own conversion, every sensor uses 4 transactions per update")
+    {
+        updateAll(); // reset detected, sensors are initialized
+        updateAll();
+        auto resets = owMock.resetCount();
+        auto converted = conversions();
+        updateAll();
+        CHECK(owMock.resetCount() - resets == 20 * 4);
+        CHECK(conversions() - converted == 20);
+        for (auto& sensor : sensors) {
+            CHECK(sensor->valid());
+        }
+    }
+
+    WHEN("The bus starts a conversion for all sensors, every sensor only reads its scratchpad once per conversion")
+    {
+        ow.startConversion();
+        updateAll(); // reset detected, sensors are initialized
+        ow.startConversion();
+        updateAll();
+        mocks[3]->setTemperature(temp_t{25.0});
+
+        auto resets = owMock.resetCount();
+        auto converted = conversions();
+        ow.startConversion();
+        updateAll();
+        CHECK(owMock.resetCount() - resets == 2 + 20 * 2);
+        CHECK(conversions() - converted == 20);
+        for (auto& sensor : sensors) {
+            CHECK(sensor->valid());
+        }
+        CHECK(sensors[3]->value() == 25.0);
+        CHECK(sensors[4]->value() == 20.0);
+
+        THEN("Without a new conversion, updating the sensors does not use the bus")
+        {
+            resets = owMock.resetCount();
+            updateAll();
+            CHECK(owMock.resetCount() == resets);
+            CHECK(sensors[3]->value() == 25.0);
+        }
+
+        THEN("A sensor that is disconnected becomes invalid after the next conversion")
+        {
+            mocks[3]->setConnected(false);
+            ow.startConversion();
+            updateAll();
+            CHECK_FALSE(sensors[3]->valid());
+            CHECK(sensors[4]->valid());
+        }
+    }
+}
+
+SCENARIO("Queued OneWire transactions are processed without blocking when the bus is slow", "[onewire]")
+{
+    OneWireMockDriver owMock;
+    OneWire ow(owMock);
+    owMock.setLatency(3); // each operation reports busy 3 times before it is done
+
+    auto sensorAddr = makeValidAddress(0x0011223344556628);
+    auto sensorMock = std::make_shared<DS18B20Mock>(sensorAddr);
+    owMock.attach(sensorMock);
+
+    auto ioAddr = makeValidAddress(0x002222334455663A);
+    auto ioMock = std::make_shared<DS2413Mock>(ioAddr);
+    owMock.attach(ioMock);
+
+    auto processAll = [&ow]() {
+        uint32_t busy = 0;
+        while (ow.process()) {
+            ++busy;
+        }
+        return busy;
+    };
+
+    WHEN("A transaction is submitted, it is advanced each time the bus is processed")
+    {
+        OneWireTransaction transaction;
+        uint8_t command = 0xB4; // read power supply
+        transaction.prepare(sensorAddr, &command, 1, 1);
+        CHECK(ow.submit(transaction));
+        CHECK(transaction.pending());
+        CHECK_FALSE(ow.submit(transaction));
+
+        // reset, select, 8 address bytes, command, read and final reset are 13 operations of 3 busy polls each
+        // the first busy poll happens on submit
+        CHECK(processAll() == 13 * 3 - 1);
+        CHECK(transaction.status() == OneWireTransaction::Status::Done);
+        CHECK(transaction.data()[0] == 0x80); // externally powered
+
+        transaction.clear();
+        CHECK(transaction.status() == OneWireTransaction::Status::Idle);
+    }
+
+    WHEN("The bus is processed with a time budget, it keeps polling the busy driver until the budget has passed")
+    {
+        OneWireTransaction transaction;
+        uint8_t command = 0xB4; // read power supply
+        transaction.prepare(sensorAddr, &command, 1, 1);
+        ow.submit(transaction);
+
+        ticks_micros_t now = 0;
+        auto micros = [&now]() {
+            now += 10; // each poll takes 10 us
+            return now;
+        };
+
+        CHECK(ow.process(100, micros));
+        CHECK(transaction.pending());
+        CHECK(now == 110); // the budget is checked after each poll
+
+        CHECK_FALSE(ow.process(1000, micros));
+        CHECK(transaction.status() == OneWireTransaction::Status::Done);
+        CHECK(transaction.data()[0] == 0x80);
+    }
+
+    WHEN("A bus wide conversion is started while the previous convert T command is still queued, the sequence does not change")
+    {
+        CHECK(ow.startConversion());
+        auto sequence = ow.conversionSequence();
+        CHECK_FALSE(ow.startConversion());
+        CHECK(ow.conversionSequence() == sequence);
+
+        processAll();
+        CHECK(ow.startConversion());
+        CHECK(ow.conversionSequence() == sequence + 1);
+    }
+
+    WHEN("A transaction for a device that is not on the bus is submitted, it fails")
+    {
+        OneWireTransaction transaction;
+        uint8_t command = 0xBE;
+        transaction.prepare(makeValidAddress(0x0099999999999928), &command, 1, 9);
+        sensorMock->setConnected(false);
+        ioMock->setConnected(false);
+        ow.submit(transaction);
+        processAll();
+        CHECK(transaction.status() == OneWireTransaction::Status::Failed);
+    }
+
+    WHEN("A DS18B20 reads its scratchpad after a bus wide conversion, the read completes in a later update")
+    {
+        DS18B20 sensor(ow, sensorAddr);
+        ow.startConversion();
+        sensor.update();
+        processAll();
+        sensor.update(); // reset detected, sensor is initialized
+
+        sensorMock->setTemperature(temp_t{25.0});
+        ow.startConversion();
+        sensor.update();
+        CHECK(ow.process()); // the read is still in progress
+        CHECK(sensor.value() == 0);
+
+        processAll();
+        sensor.update();
+        CHECK(sensor.valid());
+        CHECK(sensor.value() == 25.0);
+
+        THEN("A blocking bus access waits for queued transactions to finish")
+        {
+            ow.startConversion();
+            sensor.update();
+            CHECK(ow.process());
+            ow.reset();
+            CHECK_FALSE(ow.process());
+        }
+    }
+
+    WHEN("A DS2413 reads its inputs, the result is available after the bus has been processed")
+    {
+        DS2413 io(ow, ioAddr);
+        io.update(); // first update writes the latches, which is blocking
+        CHECK(io.connected());
+        CHECK(io.writeChannelConfig(1, IoArray::ChannelConfig::INPUT));
+
+        ActuatorDigitalBase::State result;
+        ioMock->setExternalPullDownA(true);
+        io.update();
+        CHECK(io.senseChannel(1, result));
+        CHECK(result == ActuatorDigitalBase::State::Inactive);
+
+        processAll();
+        io.update();
+        CHECK(io.senseChannel(1, result));
+        CHECK(result == ActuatorDigitalBase::State::Active);
+    }
+
+    WHEN("A device is destroyed while its read is queued, the bus continues with the next transaction")
+    {
+        auto io = std::make_unique<DS2413>(ow, ioAddr);
+        io->update();
+        io->update(); // queue a read
+        CHECK(ow.process());
+
+        OneWireTransaction transaction;
+        uint8_t command = 0xB4;
+        transaction.prepare(sensorAddr, &command, 1, 1);
+        ow.submit(transaction);
+        io.reset();
+
+        processAll();
+        CHECK(transaction.status() == OneWireTransaction::Status::Done);
+    }
+}
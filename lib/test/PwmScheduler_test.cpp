@@ -0,0 +1,233 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * Brewblox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "../inc/ActuatorDigital.h"
+#include "../inc/MockIoArray.h"
+#include "../inc/PwmScheduler.h"
+#include <memory>
+#include <vector>
+
+using State = ActuatorDigitalBase::State;
+
+namespace {
+struct Toggle {
+    ticks_micros_t time;
+    uint8_t id;
+    State state;
+
+    bool operator==(const Toggle& other) const
+    {
+        return time == other.time && id == other.id && state == other.state;
+    }
+};
+
+std::ostream&
+operator<<(std::ostream& os, const Toggle& t)
+{
+    return os << "{" << t.time << ", " << +t.id << ", " << (t.state == State::Active ? "Active" : "Inactive") << "}";
+}
+}
+
+SCENARIO("A PWM scheduler generates the edges of all fast PWM outputs", "[pwm]")
+{
+    PwmScheduler scheduler;
+    std::vector<Toggle> toggles;
+    ticks_micros_t now = 0;
+    auto logTo = [&toggles, &now](uint8_t id) {
+        return [&toggles, &now, id](State s) { toggles.push_back(Toggle{now, id, s}); };
+    };
+
+    WHEN("A channel is added, its first period starts immediately")
+    {
+        auto id = scheduler.add(10000, logTo(1), now);
+        scheduler.dutyTime(id, 2500);
+        CHECK(id == 1);
+        CHECK(scheduler.nextEdge() == 0);
+
+        THEN("It is active for the duty time and inactive for the rest of the period")
+        {
+            CHECK(scheduler.run(now) == 2500);
+            now = 2500;
+            CHECK(scheduler.run(now) == 10000);
+            now = 10000;
+            CHECK(scheduler.run(now) == 12500);
+            CHECK(toggles == std::vector<Toggle>{{0, 1, State::Active}, {2500, 1, State::Inactive}, {10000, 1, State::Active}});
+        }
+
+        THEN("Running before the next edge does nothing")
+        {
+            scheduler.run(now);
+            toggles.clear();
+            now = 2499;
+            CHECK(scheduler.run(now) == 2500);
+            CHECK(toggles.empty());
+        }
+
+        THEN("A new duty time takes effect at the start of the next period")
+        {
+            scheduler.run(now);
+            scheduler.dutyTime(id, 7000);
+            now = 2500;
+            CHECK(scheduler.run(now) == 10000);
+            now = 10000;
+            CHECK(scheduler.run(now) == 17000);
+        }
+
+        THEN("The duty time is limited to the period")
+        {
+            scheduler.dutyTime(id, 20000);
+            CHECK(scheduler.dutyTime(id) == 10000);
+        }
+
+        THEN("A duty time of zero or the full period only has an edge at the start of each period")
+        {
+            scheduler.dutyTime(id, 0);
+            CHECK(scheduler.run(now) == 10000);
+            scheduler.dutyTime(id, 10000);
+            now = 10000;
+            CHECK(scheduler.run(now) == 20000);
+            CHECK(toggles == std::vector<Toggle>{{0, 1, State::Inactive}, {10000, 1, State::Active}});
+        }
+
+        THEN("An edge that is handled late keeps the phase of the next edges")
+        {
+            scheduler.run(now);
+            now = 2700;
+            CHECK(scheduler.run(now) == 10000);
+            now = 12600; // start of the period at 10000 and the end of the duty time at 12500 are both late
+            CHECK(scheduler.run(now) == 20000);
+            CHECK(toggles.back() == Toggle{12600, 1, State::Inactive});
+        }
+
+        THEN("When a whole period is missed, the next period starts when the edge is handled")
+        {
+            scheduler.run(now);
+            now = 2500;
+            scheduler.run(now);
+            now = 25000;
+            CHECK(scheduler.run(now) == 27500);
+            now = 27500;
+            CHECK(scheduler.run(now) == 35000);
+        }
+
+        THEN("A removed channel is not toggled anymore")
+        {
+            scheduler.remove(id);
+            CHECK(scheduler.empty());
+            CHECK(scheduler.run(now) == now);
+            CHECK(toggles.empty());
+        }
+    }
+
+    WHEN("A channel is added with a period of zero, it is not added")
+    {
+        CHECK(scheduler.add(0, logTo(1), now) == 0);
+        CHECK(scheduler.empty());
+    }
+
+    WHEN("Channels are removed, their ids are reused")
+    {
+        CHECK(scheduler.add(10000, logTo(1), now) == 1);
+        CHECK(scheduler.add(10000, logTo(2), now) == 2);
+        CHECK(scheduler.add(10000, logTo(3), now) == 3);
+        scheduler.remove(2);
+        CHECK(scheduler.add(10000, logTo(2), now) == 2);
+    }
+
+    WHEN("The micros counter wraps around, the edges stay in order")
+    {
+        now = ticks_micros_t(-3000);
+        auto id1 = scheduler.add(10000, logTo(1), now);
+        auto id2 = scheduler.add(5000, logTo(2), now + 1000);
+        scheduler.dutyTime(id1, 5000);
+        scheduler.dutyTime(id2, 1000);
+        CHECK(scheduler.run(now) == ticks_micros_t(-2000));
+        now = ticks_micros_t(-2000);
+        CHECK(scheduler.run(now) == ticks_micros_t(-1000));
+        now = ticks_micros_t(-1000);
+        CHECK(scheduler.run(now) == 2000);
+        now = 2000;
+        CHECK(scheduler.run(now) == 3000);
+        CHECK(toggles == std::vector<Toggle>{
+                             {ticks_micros_t(-3000), 1, State::Active},
+                             {ticks_micros_t(-2000), 2, State::Active},
+                             {ticks_micros_t(-1000), 2, State::Inactive},
+                             {2000, 1, State::Inactive},
+                         });
+    }
+}
+
+SCENARIO("A PWM scheduler sets each channel of an IoArray that toggles at the same time in the same run", "[pwm]")
+{
+    auto io = std::make_shared<MockIoArray>();
+    ActuatorDigital act1([io]() { return io; }, 1);
+    ActuatorDigital act2([io]() { return io; }, 2);
+    ActuatorDigital act3([io]() { return io; }, 3);
+    PwmScheduler scheduler;
+
+    ticks_micros_t now = 0;
+    auto id1 = scheduler.add(10000, [&act1](State s) { act1.state(s); }, now);
+    auto id2 = scheduler.add(10000, [&act2](State s) { act2.state(s); }, now);
+    auto id3 = scheduler.add(10000, [&act3](State s) { act3.state(s); }, now);
+    scheduler.dutyTime(id1, 3000);
+    scheduler.dutyTime(id2, 3000);
+    scheduler.dutyTime(id3, 6000);
+
+    CHECK(scheduler.run(now) == 3000);
+    CHECK(io->pinStates == 0b111);
+    now = 3000;
+    auto batchedWrites = io->batchedWrites;
+    CHECK(scheduler.run(now) == 6000);
+    CHECK(io->pinStates == 0b100);
+    CHECK(io->batchedWrites == batchedWrites + 1); // both channels that turned off are written at once
+    CHECK(io->lastBatchedMask == 0b011);
+    now = 6000;
+    CHECK(scheduler.run(now) == 10000);
+    CHECK(io->pinStates == 0b000);
+    CHECK(io->batchedWrites == batchedWrites + 2);
+    CHECK(io->lastBatchedMask == 0b100);
+
+    WHEN("A channel is written outside of a scheduler run, it is written right away")
+    {
+        batchedWrites = io->batchedWrites;
+        act1.state(State::Active);
+        CHECK(io->pinStates == 0b001);
+        CHECK(io->batchedWrites == batchedWrites);
+    }
+
+    WHEN("The scheduler runs exactly on each edge, as the hardware timer does, the achieved duty is exact")
+    {
+        std::vector<ticks_micros_t> activeTime(4, 0);
+        now = 10000;
+        while (now < 1010000) {
+            auto next = scheduler.run(now);
+            for (uint8_t ch = 1; ch <= 3; ch++) {
+                if (io->pinStates & (1 << (ch - 1))) {
+                    activeTime[ch] += next - now;
+                }
+            }
+            now = next;
+        }
+        CHECK(activeTime[1] == 300000);
+        CHECK(activeTime[2] == 300000);
+        CHECK(activeTime[3] == 600000);
+    }
+}
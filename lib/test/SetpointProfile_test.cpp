@@ -23,7 +23,9 @@
 #include "../inc/SetpointSensorPair.h"
 #include "../inc/TempSensorMock.h"
 #include "../inc/Temperature.h"
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 
 SCENARIO("SetpointProfile test", "[SetpointProfile]")
 {
@@ -226,3 +228,77 @@ SCENARIO("SetpointProfile test", "[SetpointProfile]")
         CHECK(profile.isDriving() == true);
     }
 }
+
+SCENARIO("SetpointProfile keeps a cursor on the current segment", "[SetpointProfile]")
+{
+    auto sensor = std::make_shared<TempSensorMock>(20.0);
+    auto sspair = std::make_shared<SetpointSensorPair>([sensor]() { return sensor; });
+    sspair->setting(99);
+    sspair->settingValid(true);
+    SetpointProfile profile([&sspair]() { return sspair; });
+    profile.startTime(10);
+    profile.addPoint(SetpointProfile::Point{utc_seconds_t(1), temp_t(10)});
+    profile.addPoint(SetpointProfile::Point{utc_seconds_t(11), temp_t(20)});
+    profile.addPoint(SetpointProfile::Point{utc_seconds_t(21), temp_t(40)});
+
+    WHEN("The time jumps back to an earlier segment, the earlier segment is used")
+    {
+        profile.update(30);
+        CHECK(sspair->setting() == Approx(38).margin(0.001));
+        profile.update(12);
+        CHECK(sspair->setting() == Approx(11).margin(0.001));
+        profile.update(22);
+        CHECK(sspair->setting() == Approx(22).margin(0.001));
+    }
+
+    WHEN("The time jumps back to before the start, the setpoint is not changed")
+    {
+        profile.update(30);
+        sspair->setting(99);
+        profile.update(5);
+        CHECK(sspair->setting() == Approx(99).margin(0.001));
+    }
+
+    WHEN("The points are replaced, the new points are used")
+    {
+        profile.update(16);
+        CHECK(sspair->setting() == Approx(15).margin(0.001));
+        profile.points({SetpointProfile::Point{utc_seconds_t(1), temp_t(0)}, SetpointProfile::Point{utc_seconds_t(21), temp_t(-20)}});
+        profile.update(16);
+        CHECK(sspair->setting() == Approx(-5).margin(0.001));
+        CHECK(profile.points().size() == 2);
+        CHECK(profile.pointList().size() == 2);
+    }
+
+    WHEN("The start time changes, the profile is evaluated from the new start time")
+    {
+        profile.update(16);
+        profile.startTime(0);
+        profile.update(16);
+        CHECK(sspair->setting() == Approx(30).margin(0.001));
+    }
+
+    WHEN("A long profile is followed second by second, the result is within 1 bit of interpolating each segment directly")
+    {
+        std::vector<SetpointProfile::Point> points;
+        for (int i = 0; i < 300; i++) {
+            points.push_back(SetpointProfile::Point{utc_seconds_t(i * 600 + (i % 7) * 13), cnl::wrap<temp_t>((i % 11) * 12345 - 50000)});
+        }
+        profile.points(std::vector<SetpointProfile::Point>(points));
+        profile.startTime(1000);
+
+        int64_t maxError = 0;
+        size_t segment = 1;
+        for (utc_seconds_t elapsed = points.front().time; elapsed < points.back().time; elapsed += 7) {
+            while (points[segment].time <= elapsed) {
+                ++segment;
+            }
+            auto& lower = points[segment - 1];
+            auto& upper = points[segment];
+            auto expected = cnl::unwrap(lower.temp) + (int64_t(cnl::unwrap(upper.temp)) - cnl::unwrap(lower.temp)) * (elapsed - lower.time) / (upper.time - lower.time);
+            profile.update(1000 + elapsed);
+            maxError = std::max(maxError, std::abs(cnl::unwrap(sspair->setting()) - expected));
+        }
+        CHECK(maxError <= 1);
+    }
+}
@@ -96,4 +96,16 @@ TEST_CASE("Test temperature to string conversion in Celcius en Fahrenheit", "[te
         CHECK(temp_to_string(t, 2, TempUnit::Fahrenheit) == "315.53");
         CHECK(temp_to_string(t, 3, TempUnit::Fahrenheit) == "315.531");
     }
+
+    SECTION("157.5173C to Fahrenheit char buffer")
+    {
+        temp_t t = 157.5173;
+        char buf[12];
+        CHECK(temp_to_chars(t, 1, TempUnit::Fahrenheit, buf, sizeof(buf)) == 5);
+        CHECK(std::string(buf) == "315.5");
+        CHECK(temp_to_chars(t, 3, TempUnit::Celsius, buf, sizeof(buf)) == 7);
+        CHECK(std::string(buf) == "157.517");
+        CHECK(temp_to_chars(t, 3, TempUnit::Celsius, buf, 7) == 0);
+        CHECK(std::string(buf) == "");
+    }
 }
@@ -88,6 +88,10 @@ static D4D_KEYS_BUFFER d4d_KeysBuff;
 // The D4D system flags
 D4D_SYSTEM_FLAGS d4d_systemFlags;
 
+// counters of the frame that is being drawn and of the last complete frame
+D4D_FRAME_STATS d4d_frameStats;
+static D4D_FRAME_STATS d4d_lastFrameStats;
+
 #ifdef D4D_LLD_TCH
   static D4D_TOUCHSCREEN_STATUS d4d_TouchScreen_Status;
   D4D_OBJECT* d4d_LastTouchedObj;
@@ -161,6 +165,11 @@ void D4D_Poll(void)
     // get active screen
     D4D_SCREEN* pScreen;
 
+    // start counting a new frame
+    d4d_lastFrameStats = d4d_frameStats;
+    d4d_frameStats.redrawnObjects = 0;
+    d4d_frameStats.lcdBytes = 0;
+
     // handle keys (may change active screen)
     D4D_HandleKeys();
 
@@ -565,6 +574,17 @@ void D4D_FlushOutput(void)
   D4D_LLD_LCD.D4DLCD_FlushBuffer(D4DLCD_FLSH_FORCE);
 }
 
+/**************************************************************************/ /*!
+* @brief   Function returns the drawing counters of the last complete frame
+* @return  pointer to the counters
+* @note    A frame starts with each call of D4D_Poll() and includes everything that is
+*          drawn and flushed until the next call, so the counters of the current frame are not complete yet.
+*******************************************************************************/
+const D4D_FRAME_STATS* D4D_GetFrameStats(void)
+{
+  return &d4d_lastFrameStats;
+}
+
 /******************************************************************************
 *       End of public functions                                               */
 /*! @} End of doxd4d_base_func                                               */
@@ -438,6 +438,19 @@ typedef enum
     D4D_EVENT_CNT               ///< Keep it on end of list (there is stored count of events)
 } D4D_EVENTID;
 
+/*********************************************************
+*
+* frame statistics
+*
+*********************************************************/
+
+/*! @brief D4D counters of the drawing work done in one frame. A frame starts with each call of D4D_Poll().*/
+typedef struct
+{
+    LWord redrawnObjects;       ///< Count of objects that received the draw message.
+    LWord lcdBytes;             ///< Count of bytes sent to the LCD by the low level hardware driver, data and commands.
+} D4D_FRAME_STATS;
+
 /*! @} End of doxd4d_base_type                                               */
 /******************************************************************************
 * Internal types
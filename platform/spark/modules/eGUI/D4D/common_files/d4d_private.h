@@ -91,6 +91,9 @@ extern D4D_MESSAGE d4d_msg;
 // The D4D system flags
 extern D4D_SYSTEM_FLAGS d4d_systemFlags;
 
+// counters of the frame that is being drawn, low level drivers add the bytes they send
+extern D4D_FRAME_STATS d4d_frameStats;
+
 // zero size structure for automatic function capability
 extern const D4D_SIZE d4d_size_zero;
 
@@ -1028,6 +1028,7 @@ static void D4D_RedrawScreenObject(D4D_OBJECT* pObject, D4D_BOOL complete)
     }
 
     // will draw now
+    d4d_frameStats.redrawnObjects++;
     // send the DRAW message
     msg.nMsgId = D4D_MSG_DRAW;
     D4D_SendMessage(&msg);
@@ -130,6 +130,7 @@ void D4D_NewKeyEvent(D4D_KEY_SCANCODE scanCode);
 void D4D_EnableSystemKeys(D4D_BOOL bEnable);
 void D4D_TimeTickPut(void);
 void D4D_FlushOutput(void);
+const D4D_FRAME_STATS* D4D_GetFrameStats(void);
 
 #ifdef D4D_LLD_TCH
   D4D_POINT D4D_GetTouchScreenCoordinates(D4D_OBJECT* pObject);
@@ -295,6 +295,7 @@ D4DLCDHW_SendDataWord_Spi_Spark_8b(unsigned short value)
 {
 #if 1
     tx_buffer[active_buffer_idx][active_buffer_offset++] = value;
+    d4d_frameStats.lcdBytes++;
 
     if (active_buffer_offset >= SCREEN_DATA_BUFFER_SIZE) {
         flushData();
@@ -330,6 +331,7 @@ D4DLCDHW_SendCmdWord_Spi_Spark_8b(unsigned short cmd)
     SpiLCD.begin();
     // Send data byte
     SpiLCD.transfer(cmd);
+    d4d_frameStats.lcdBytes++;
 
     SpiLCD.end();
     D4DLCD_DEASSERT_DC; // DataCmd := 1
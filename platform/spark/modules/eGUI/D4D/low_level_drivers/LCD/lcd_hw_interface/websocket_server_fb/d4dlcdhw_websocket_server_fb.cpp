@@ -38,6 +38,7 @@ extern "C" {
 #include "common_files/d4d_private.h"    // include the private header file that contains perprocessor macros as D4D_MK_STR
 }
 #include "WebSocketsServer.h"
+#include "d4dlcdhw_websocket_server_fb_encoder.h"
 #include <vector>
 
 /******************************************************************************
@@ -108,49 +109,45 @@ extern "C" {
 
 static void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length);
 
-struct __attribute__((packed)) Pixel
-{
-	uint32_t address_;
-	uint32_t color_;
-
-	Pixel() = default;
-	~Pixel() = default;
-
-	Pixel(uint32_t address, uint32_t color)
-	: address_(address), color_(color)
-	{
-	}
-};
-
 extern "C" void websocket_touch(uint16_t x, uint16_t y, uint8_t pressed);
 extern "C" void websocket_touch_clear();
 
 class DisplayServer;
 class DisplayBuffer
 {
-	static const uint32_t count = D4D_SCREEN_SIZE_LONGER_SIDE*D4D_SCREEN_SIZE_SHORTER_SIDE;
-	D4D_COLOR pixels[count];
+	FrameBuffer pixels{D4D_SCREEN_SIZE_LONGER_SIDE, D4D_SCREEN_SIZE_SHORTER_SIDE};
 public:
 
-	inline void set_pixel(uint32_t offset, D4D_COLOR color)
+	// returns whether the pixel should be sent right away, buffered pixels are sent when the frame is flushed
+	inline bool set_pixel(uint32_t offset, D4D_COLOR color)
 	{
 		// addresses are given as offsets
-		if (offset<count)
-			pixels[offset] = color;
+		pixels.set(offset, color);
+		return false;
+	}
+
+	void encode_changes(FrameEncoder& frame)
+	{
+		pixels.encodeChanges(frame);
 	}
 
-	bool push(DisplayServer& server);
+	bool push(DisplayServer& server, uint8_t num);
 };
 
 static_assert(sizeof(D4D_COLOR)==2, "expected D4D_COLOR to be 16-bit");
 
 class NoOpDisplayBuffer
 {
-	inline void set_pixel(uint32_t offset, D4D_COLOR color) {
+public:
+	inline bool set_pixel(uint32_t offset, D4D_COLOR color) {
+		return true;
+	}
+
+	void encode_changes(FrameEncoder& frame) {
 
 	}
 
-	bool push(DisplayServer& server) {
+	bool push(DisplayServer& server, uint8_t num) {
 		return false;
 	}
 };
@@ -166,13 +163,13 @@ class DisplayServer
 {
 	WebSocketsServer server;
 
-	const static int pixel_count = D4D_SCREEN_SIZE_LONGER_SIDE;
-	std::vector<Pixel> pixels;
+	// without a buffer, a frame is sent when it reaches this size, to limit the memory used while a screen is drawn
+	const static size_t max_frame_size = 2048;
+	FrameEncoder frame;
 	DisplayBufferImpl buffer;
 
 public:
-	DisplayServer(uint16_t port, const String& origin) : server(port, origin) {
-		pixels.reserve(pixel_count);
+	DisplayServer(uint16_t port, const String& origin) : server(port, origin), frame(D4D_SCREEN_SIZE_LONGER_SIDE) {
 	}
 
 	bool start()
@@ -193,7 +190,7 @@ public:
 		return true;
 	}
 
-	void process_command(const uint8_t* data, size_t length)
+	void process_command(uint8_t num, const uint8_t* data, size_t length)
 	{
 		if (length>=1) {
 			int cmd = data[0];
@@ -208,6 +205,10 @@ public:
 					DEBUG("touch %d, %d", x, y);
 				}
 				break;
+			case 3:
+				// the client requests a keyframe, for example after it dropped frames
+				send_keyframe(num);
+				break;
 			}
 		}
 	}
@@ -216,14 +217,20 @@ public:
 		websocket_touch_clear();
 	}
 
-	void handleConnection()
+	void handleConnection(uint8_t num)
 	{
 		// todo - only clear the touch screen on the first connection.
-		// todo - only send the screen data to the connecting client, not to all clients.
 		clear_touch();
+		send_keyframe(num);
+	}
 
-		// send the current screen to the new client
-		if (!buffer.push(*this)) {
+	void send_keyframe(uint8_t num)
+	{
+		// the other clients get the pending pixels first, so the keyframe has the same screen
+		flush();
+
+		// send the current screen to this client only
+		if (!buffer.push(*this, num)) {
 
 			D4D_SCREEN* screen = D4D_GetActiveScreen();
 			// invalidate the new screen (global complete redraw, not individual objects)
@@ -239,43 +246,50 @@ public:
 	{
 		switch (type) {
 		case WStype_CONNECTED:
-			handleConnection();
+			handleConnection(num);
 			break;
 		case WStype_DISCONNECTED:
 			clear_touch();
 			break;
 		case WStype_BIN:
-			process_command(payload, length);
+			process_command(num, payload, length);
 			break;
 		default:
 			break;
 		}
 	}
 
+	void send(uint8_t num, const std::vector<uint8_t>& data)
+	{
+		server.sendBIN(num, data.data(), data.size());
+	}
+
 	void flush()
 	{
-		uint32_t size = pixels.size();
-		if (size) {
-			Pixel* data = pixels.data();
-			server.broadcastBIN((const uint8_t*)data, sizeof(Pixel)*size);
-			pixels.clear();
+		buffer.encode_changes(frame);
+		if (!frame.empty()) {
+			const std::vector<uint8_t>& data = frame.finish();
+			server.broadcastBIN(data.data(), data.size());
+			d4d_frameStats.lcdBytes += data.size();
 		}
+		frame.begin(FrameEncoder::DELTA);
 	}
 
 	void add_pixel(uint32_t offset, D4D_COLOR color)
 	{
-		if (pixels.size()==pixels.capacity())
-			flush();
-		pixels.push_back(Pixel(offset, color));
-		buffer.set_pixel(offset, color);
+		if (buffer.set_pixel(offset, color)) {
+			if (frame.size()>=max_frame_size)
+				flush();
+			frame.add(offset, color);
+		}
 	}
 };
 
-bool DisplayBuffer::push(DisplayServer& server)
+bool DisplayBuffer::push(DisplayServer& server, uint8_t num)
 {
-	for (uint32_t i=0; i<count; i++)
-		server.add_pixel(i, pixels[i]);
-	server.flush();
+	FrameEncoder keyframe(D4D_SCREEN_SIZE_LONGER_SIDE, FrameEncoder::KEYFRAME);
+	pixels.encodeAll(keyframe);
+	server.send(num, keyframe.finish());
 	return true;
 }
 
@@ -0,0 +1,307 @@
+/**************************************************************************
+*
+* Copyright 2020 by BrewPi B.V.
+*
+***************************************************************************
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License Version 3
+* or later (the "LGPL").
+*
+* As a special exception, the copyright holders of the eGUI project give you
+* permission to link the eGUI sources with independent modules to produce an
+* executable, regardless of the license terms of these independent modules,
+* and to copy and distribute the resulting executable under terms of your
+* choice, provided that you also meet, for each linked independent module,
+* the terms and conditions of the license of that module.
+* An independent module is a module which is not derived from or based
+* on this library.
+* If you modify the eGUI sources, you may extend this exception
+* to your version of the eGUI sources, but you are not obligated
+* to do so. If you do not wish to do so, delete this
+* exception statement from your version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+*
+* You should have received a copy of the GNU General Public License
+* and the GNU Lesser General Public License along with this program.
+* If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef __D4DLCDHW_WEBSOCKET_SERVER_FB_ENCODER_H
+#define __D4DLCDHW_WEBSOCKET_SERVER_FB_ENCODER_H
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Encodes the pixel writes of the display driver into frames for the websocket clients.
+ * A frame is one binary websocket message. All values are little endian.
+ *
+ * frame:  uint8 type, followed by records until the end of the message
+ *         type KEYFRAME (1) holds every pixel of the screen, type DELTA (2) only the pixels that were written
+ * SPAN:   uint8 1, uint32 offset, uint16 run count, run count x {uint8 length, uint16 color}
+ *         consecutive pixels starting at offset, as runs of the same color
+ * RECT:   uint8 2, uint32 offset, uint16 width, uint16 height, uint16 color
+ *         a rectangle of one color with its top left pixel at offset
+ *
+ * Offsets are pixel indexes: y * width + x. Writes to consecutive offsets are added to the same span.
+ * Spans of one color within a row that are stacked on the rows below each other are merged into a RECT.
+ */
+class FrameEncoder
+{
+public:
+	enum FrameType : uint8_t {
+		KEYFRAME = 1,
+		DELTA = 2,
+	};
+
+	enum RecordType : uint8_t {
+		SPAN = 1,
+		RECT = 2,
+	};
+
+	FrameEncoder(uint16_t screenWidth, FrameType type = DELTA)
+	: width(screenWidth)
+	{
+		begin(type);
+	}
+
+	~FrameEncoder() = default;
+
+	// discards the frame and starts a new one
+	void begin(FrameType type)
+	{
+		frame.clear();
+		frame.push_back(type);
+		span.clear();
+		rect.height = 0;
+	}
+
+	void add(uint32_t offset, uint16_t color)
+	{
+		if (!span.empty() && offset == spanEnd) {
+			uint8_t* run = &span[span.size() - 3];
+			uint16_t runColor = get16(run + 1);
+			if (run[0] < 255 && runColor == color) {
+				++run[0];
+				++spanEnd;
+				return;
+			}
+			if (spanRuns < 0xFFFF) {
+				addRun(color);
+				spanUniform = spanUniform && runColor == color;
+				++spanEnd;
+				return;
+			}
+		}
+		closeSpan();
+		span.push_back(SPAN);
+		put32(span, offset);
+		put16(span, 0); // the run count is written when the span is closed
+		spanRuns = 0;
+		addRun(color);
+		spanStart = offset;
+		spanEnd = offset + 1;
+		spanUniform = true;
+	}
+
+	// returns the finished frame, begin() must be called before adding pixels to the next frame
+	const std::vector<uint8_t>& finish()
+	{
+		closeSpan();
+		closeRect();
+		return frame;
+	}
+
+	// true when no pixels were added since begin()
+	bool empty() const
+	{
+		return frame.size() <= 1 && span.empty() && rect.height == 0;
+	}
+
+	// bytes used for the frame so far
+	size_t size() const
+	{
+		return frame.size() + span.size() + (rect.height ? 11 : 0);
+	}
+
+private:
+	struct Rect {
+		uint32_t offset;
+		uint16_t width;
+		uint16_t height; // 0 when there is no pending rectangle
+		uint16_t color;
+	};
+
+	const uint16_t width;
+	std::vector<uint8_t> frame;
+	std::vector<uint8_t> span; // the open span is kept apart, because it can still become part of a rectangle
+	uint32_t spanStart = 0;
+	uint32_t spanEnd = 0;
+	uint16_t spanRuns = 0;
+	bool spanUniform = true;
+	Rect rect = {0, 0, 0, 0};
+
+	void addRun(uint16_t color)
+	{
+		span.push_back(1);
+		put16(span, color);
+		++spanRuns;
+	}
+
+	void closeSpan()
+	{
+		if (span.empty()) {
+			return;
+		}
+		uint32_t length = spanEnd - spanStart;
+		if (spanUniform && length <= uint32_t(width - spanStart % width)) {
+			// one color within one row, extends the pending rectangle when it is right below it
+			uint16_t color = get16(&span[span.size() - 2]);
+			if (rect.height && rect.color == color && rect.width == length && spanStart == rect.offset + rect.height * uint32_t(width)) {
+				++rect.height;
+			} else {
+				closeRect();
+				rect = Rect{spanStart, uint16_t(length), 1, color};
+			}
+			span.clear();
+			return;
+		}
+		closeRect();
+		span[5] = uint8_t(spanRuns);
+		span[6] = uint8_t(spanRuns >> 8);
+		frame.insert(frame.end(), span.cbegin(), span.cend());
+		span.clear();
+	}
+
+	void closeRect()
+	{
+		if (rect.height == 0) {
+			return;
+		}
+		if (rect.height == 1) {
+			// a single row is smaller as a span
+			frame.push_back(SPAN);
+			put32(frame, rect.offset);
+			put16(frame, (rect.width + 254) / 255);
+			for (uint16_t remaining = rect.width; remaining > 0;) {
+				uint8_t length = remaining > 255 ? 255 : remaining;
+				frame.push_back(length);
+				put16(frame, rect.color);
+				remaining -= length;
+			}
+		} else {
+			frame.push_back(RECT);
+			put32(frame, rect.offset);
+			put16(frame, rect.width);
+			put16(frame, rect.height);
+			put16(frame, rect.color);
+		}
+		rect.height = 0;
+	}
+
+	static void put16(std::vector<uint8_t>& out, uint16_t v)
+	{
+		out.push_back(uint8_t(v));
+		out.push_back(uint8_t(v >> 8));
+	}
+
+	static void put32(std::vector<uint8_t>& out, uint32_t v)
+	{
+		put16(out, uint16_t(v));
+		put16(out, uint16_t(v >> 16));
+	}
+
+	static uint16_t get16(const uint8_t* p)
+	{
+		return uint16_t(p[0] | (p[1] << 8));
+	}
+};
+
+/*
+ * Keeps the screen as it is drawn and as it was last sent to the clients.
+ * Drawing a widget often writes the same pixel more than once, for example the background before the text.
+ * Only the pixels in the rectangle that was drawn since the last frame that differ from what was sent are encoded.
+ */
+class FrameBuffer
+{
+public:
+	FrameBuffer(uint16_t screenWidth, uint16_t screenHeight)
+	: width(screenWidth), drawn(uint32_t(screenWidth) * screenHeight, 0), sent(drawn)
+	{
+	}
+
+	~FrameBuffer() = default;
+
+	void set(uint32_t offset, uint16_t color)
+	{
+		if (offset >= drawn.size()) {
+			return;
+		}
+		drawn[offset] = color;
+		uint16_t x = offset % width;
+		uint16_t y = offset / width;
+		if (!dirty) {
+			left = right = x;
+			top = bottom = y;
+			dirty = true;
+			return;
+		}
+		left = x < left ? x : left;
+		right = x > right ? x : right;
+		top = y < top ? y : top;
+		bottom = y > bottom ? y : bottom;
+	}
+
+	// adds the pixels that changed since the last call to the frame
+	void encodeChanges(FrameEncoder& frame)
+	{
+		if (!dirty) {
+			return;
+		}
+		for (uint32_t y = top; y <= bottom; y++) {
+			uint32_t row = y * width;
+			uint32_t next = 0; // x after the last pixel added in this row
+			for (uint32_t x = left; x <= right; x++) {
+				uint32_t offset = row + x;
+				if (drawn[offset] == sent[offset]) {
+					continue;
+				}
+				// a short gap of unchanged pixels costs less than starting a new span
+				if (next > 0 && x - next <= max_gap) {
+					for (uint32_t gap = row + next; gap < offset; gap++) {
+						frame.add(gap, drawn[gap]);
+					}
+				}
+				frame.add(offset, drawn[offset]);
+				sent[offset] = drawn[offset];
+				next = x + 1;
+			}
+		}
+		dirty = false;
+	}
+
+	// adds all pixels as they were sent to the clients, to a frame that was started as keyframe
+	void encodeAll(FrameEncoder& frame) const
+	{
+		for (uint32_t i = 0; i < sent.size(); i++) {
+			frame.add(i, sent[i]);
+		}
+	}
+
+private:
+	const static uint32_t max_gap = 3;
+	const uint16_t width;
+	std::vector<uint16_t> drawn;
+	std::vector<uint16_t> sent;
+	bool dirty = false;
+	uint16_t left = 0;
+	uint16_t right = 0;
+	uint16_t top = 0;
+	uint16_t bottom = 0;
+};
+
+#endif // __D4DLCDHW_WEBSOCKET_SERVER_FB_ENCODER_H
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+Prints the time spent per block, as measured by a firmware built with CBOX_PROFILING.
+The host (gcc) build has profiling enabled and listens on TCP port 8332.
+
+Usage: profile-report.py [--host localhost] [--port 8332] [--reset]
+"""
+
+import argparse
+import re
+import socket
+import struct
+
+READ_OBJECT_PROFILES = 0x11
+HISTOGRAM_BUCKETS = 8
+PROFILE_FORMAT = '<HHIIIIII' + 'H' * HISTOGRAM_BUCKETS
+
+
+def crc8(data):
+    """Dallas/Maxim CRC8, the same as dscrc_table in controlbox"""
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0x8C if crc & 1 else crc >> 1
+    return crc
+
+
+def request(host, port, reset):
+    cmd = bytes([0, 0, READ_OBJECT_PROFILES, 1 if reset else 0])
+    line = (cmd + bytes([crc8(cmd)])).hex().upper() + '\n'
+
+    with socket.create_connection((host, port), timeout=5) as sock:
+        sock.sendall(line.encode())
+        received = b''
+        while True:
+            chunk = sock.recv(4096)
+            if not chunk:
+                break
+            received += chunk
+            # skip the welcome message and other annotations, wait for the reply to the command
+            text = re.sub(r'<[^>]*>', '', received.decode(errors='replace'))
+            if '|' in text and text.endswith('\n'):
+                return text.strip()
+    raise RuntimeError('connection closed before a reply was received')
+
+
+def parse(reply):
+    _, response = reply.split('|', 1)
+    chunks = [bytes.fromhex(c) for c in response.split(',')]
+    for chunk in chunks:
+        if crc8(chunk) != 0:
+            raise RuntimeError('CRC error in reply')
+    status = chunks[0][0]
+    if status != 0:
+        raise RuntimeError('Command failed with status {:#04x}, is the firmware built with CBOX_PROFILING?'.format(status))
+
+    profiles = []
+    for chunk in chunks[1:]:
+        values = struct.unpack(PROFILE_FORMAT, chunk[:-1])
+        profiles.append({
+            'id': values[0],
+            'type': values[1],
+            'updates': values[2],
+            'update_us': values[3],
+            'update_max_us': values[4],
+            'stream_to_us': values[5],
+            'stream_from_us': values[6],
+            'persist_us': values[7],
+            'histogram': values[8:],
+        })
+    return profiles
+
+
+def report(profiles):
+    header = '{:>6} {:>6} {:>9} {:>12} {:>9} {:>9} {:>12} {:>12} {:>12}  histogram (<16us, <32us, ... >=1024us)'
+    row = '{id:>6} {type:>6} {updates:>9} {update_us:>12} {avg:>9} {update_max_us:>9} ' \
+          '{stream_to_us:>12} {stream_from_us:>12} {persist_us:>12}  {hist}'
+    print(header.format('id', 'type', 'updates', 'update us', 'avg us', 'max us', 'streamTo us', 'streamFrom us', 'persist us'))
+    for p in sorted(profiles, key=lambda p: p['update_us'], reverse=True):
+        avg = p['update_us'] // p['updates'] if p['updates'] else 0
+        print(row.format(avg=avg, hist=' '.join(str(c) for c in p['histogram']), **p))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--host', default='localhost')
+    parser.add_argument('--port', type=int, default=8332)
+    parser.add_argument('--reset', action='store_true', help='reset the profiles after reading them')
+    args = parser.parse_args()
+
+    report(parse(request(args.host, args.port, args.reset)))
+
+
+if __name__ == '__main__':
+    main()